@@ -0,0 +1,42 @@
+# -*- mode: cmake; -*-
+
+# Writes next to each module the manifest of the factory IDs it registers,
+# the ModuleManager then loads the module only when one of them is needed.
+
+if(CMAKE_VERSION VERSION_LESS 3.7 OR NOT TARGET euCliModule)
+  return()
+endif()
+
+macro(collect_module_targets dir)
+  get_property(_targets DIRECTORY ${dir} PROPERTY BUILDSYSTEM_TARGETS)
+  foreach(_t ${_targets})
+    get_target_property(_type ${_t} TYPE)
+    if(_type STREQUAL "SHARED_LIBRARY" AND _t MATCHES "^${EUDAQ_PREFIX}module_")
+      list(APPEND MODULE_TARGETS ${_t})
+    endif()
+  endforeach()
+  get_property(_subdirs DIRECTORY ${dir} PROPERTY SUBDIRECTORIES)
+  foreach(_d ${_subdirs})
+    collect_module_targets(${_d})
+  endforeach()
+endmacro(collect_module_targets)
+
+set(MODULE_TARGETS)
+collect_module_targets(${CMAKE_SOURCE_DIR})
+
+set(MODULE_MANIFESTS)
+foreach(_t ${MODULE_TARGETS})
+  get_target_property(_dir ${_t} BINARY_DIR)
+  set(_manifest ${_dir}/${CMAKE_SHARED_LIBRARY_PREFIX}${_t}.manifest)
+  add_custom_command(OUTPUT ${_manifest}
+    COMMAND ${CMAKE_COMMAND} -E env --unset=EUDAQ_MODULE_DIR EUDAQ_MODULE_IGNORE_DEFALUT=1
+    $<TARGET_FILE:euCliModule> -m $<TARGET_FILE:${_t}> -o ${_manifest}
+    DEPENDS ${_t} euCliModule
+    COMMENT "Writing the manifest of ${_t}")
+  list(APPEND MODULE_MANIFESTS ${_manifest})
+endforeach()
+
+if(MODULE_MANIFESTS)
+  add_custom_target(${EUDAQ_PREFIX}module_manifests ALL DEPENDS ${MODULE_MANIFESTS})
+  install(FILES ${MODULE_MANIFESTS} DESTINATION lib OPTIONAL)
+endif()
@@ -23,7 +23,11 @@ void RunControlModel::disconnected(eudaq::ConnectionSPC id){
 
 void RunControlModel::SetStatus(eudaq::ConnectionSPC id,
                                 eudaq::StatusSPC status){
-  m_con_status.at(id) = status;
+  auto &status_last = m_con_status.at(id);
+  // RunControl keeps the StatusSPC of a connection until an update arrives
+  if(status_last == status)
+    return;
+  status_last = status;
   emit dataChanged(createIndex(0, 0), createIndex(m_con_status.size()-1, m_str_header.size()-1));
 }
 
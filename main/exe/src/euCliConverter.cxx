@@ -3,6 +3,7 @@
 #include "eudaq/FileWriter.hh"
 #include "eudaq/FileReader.hh"
 #include <iostream>
+#include <chrono>
 
 int main(int /*argc*/, const char **argv) {
   eudaq::OptionParser op("EUDAQ Command Line DataConverter", "2.0", "The Data Converter launcher of EUDAQ");
@@ -10,6 +11,10 @@ int main(int /*argc*/, const char **argv) {
 					"input file");
   eudaq::Option<std::string> file_output(op, "o", "output", "", "string",
 					 "output file");
+  eudaq::Option<std::string> type_output(op, "t", "type", "", "string",
+					 "output file type, taken from the extension of the output file if empty");
+  eudaq::Option<std::string> settings(op, "s", "settings", "", "string",
+				      "settings of the writer, KEY=VALUE separated by commas");
   eudaq::OptionFlag iprint(op, "ip", "iprint", "enable print of input Event");
 
   try{
@@ -27,7 +32,9 @@ int main(int /*argc*/, const char **argv) {
   
   std::string outfile_path = file_output.Value();
   std::string type_in = infile_path.substr(infile_path.find_last_of(".")+1);
-  std::string type_out = outfile_path.substr(outfile_path.find_last_of(".")+1);
+  std::string type_out = type_output.Value();
+  if(type_out.empty())
+    type_out = outfile_path.substr(outfile_path.find_last_of(".")+1);
   bool print_ev_in = iprint.Value();
   
   if(type_in=="raw")
@@ -38,8 +45,23 @@ int main(int /*argc*/, const char **argv) {
   eudaq::FileReaderUP reader;
   eudaq::FileWriterUP writer;
   reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash(type_in), infile_path);
-  if(!type_out.empty())
+  if(!type_out.empty()){
     writer = eudaq::Factory<eudaq::FileWriter>::MakeUnique(eudaq::str2hash(type_out), outfile_path);
+    if(!settings.Value().empty()){
+      auto conf = std::make_shared<eudaq::Configuration>();
+      for(auto &kv: eudaq::split(settings.Value(), ",", true)){
+	size_t i = kv.find('=');
+	if(i == std::string::npos){
+	  std::cout<<"invalid setting "<<kv<<std::endl;
+	  return 1;
+	}
+	conf->SetString(kv.substr(0, i), kv.substr(i + 1));
+      }
+      writer->SetConfiguration(conf);
+    }
+  }
+  uint64_t n_ev = 0;
+  auto tp_start = std::chrono::steady_clock::now();
   while(1){
     auto ev = reader->GetNextEvent();
     if(!ev)
@@ -48,6 +70,13 @@ int main(int /*argc*/, const char **argv) {
       ev->Print(std::cout);
     if(writer)
       writer->WriteEvent(ev);
+    n_ev++;
   }
+  writer.reset(); // flush and close the output before stopping the clock
+  double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+  std::cout<<n_ev<<" events converted to "<<(type_out.empty()?"nothing":type_out)<<" in "<<sec<<" s";
+  if(sec > 0)
+    std::cout<<", "<<n_ev/sec<<" events/s";
+  std::cout<<std::endl;
   return 0;
 }
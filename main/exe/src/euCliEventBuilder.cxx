@@ -0,0 +1,81 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/OfflineEventBuilder.hh"
+#include "eudaq/FileWriter.hh"
+#include "eudaq/Utils.hh"
+
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line EventBuilder", "2.0",
+			 "Builds synchronised events out of the data files of several producers");
+  eudaq::Option<std::string> file_input(op, "i", "input", "", "string",
+					"input files, separated by commas");
+  eudaq::Option<std::string> file_output(op, "o", "output", "", "string",
+					 "output file");
+  eudaq::Option<std::string> mode(op, "m", "mode", "trigger", "string",
+				  "build by trigger number (trigger) or by timestamp (timestamp), "
+				  "or merge the files of a sharded producer (shard)");
+  eudaq::Option<uint64_t> window(op, "w", "window", 0, "uint64_t",
+				 "timestamp window of an event, in the units of the timestamps");
+  eudaq::Option<uint32_t> queue(op, "q", "queue", 1024, "uint32_t",
+				"events read ahead per input");
+  eudaq::OptionFlag require_all(op, "a", "all", "drop the events which miss an input");
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+
+  std::vector<std::string> paths;
+  if(!file_input.Value().empty())
+    paths = eudaq::split(file_input.Value(), ",", true);
+  eudaq::OfflineEventBuilder::Mode build_mode = eudaq::OfflineEventBuilder::TRIGGER_N;
+  if(mode.Value() == "trigger")
+    build_mode = eudaq::OfflineEventBuilder::TRIGGER_N;
+  else if(mode.Value() == "timestamp")
+    build_mode = eudaq::OfflineEventBuilder::TIMESTAMP;
+  else if(mode.Value() == "shard")
+    build_mode = eudaq::OfflineEventBuilder::SEQUENCE;
+  else
+    paths.clear();
+  if(paths.empty()){
+    std::cout<<"option --help to get help"<<std::endl;
+    return 1;
+  }
+  eudaq::OfflineEventBuilder builder(paths, build_mode);
+  builder.SetTimeWindow(window.Value());
+  builder.SetQueueSize(queue.Value());
+  builder.SetRequireAll(require_all.Value());
+
+  eudaq::FileWriterUP writer;
+  std::string outfile_path = file_output.Value();
+  if(!outfile_path.empty()){
+    std::string type_out = outfile_path.substr(outfile_path.find_last_of(".")+1);
+    if(type_out == "raw")
+      type_out = "native";
+    writer = eudaq::Factory<eudaq::FileWriter>::MakeUnique(eudaq::str2hash(type_out), outfile_path);
+    if(!writer){
+      std::cout<<"no FileWriter for "<<outfile_path<<std::endl;
+      return 1;
+    }
+  }
+
+  auto tp = std::chrono::steady_clock::now();
+  std::vector<uint64_t> n_sub(paths.size() + 1);
+  while(auto ev = builder.GetNextEvent()){
+    n_sub[std::min<size_t>(ev->GetNumSubEvent(), paths.size())]++;
+    if(writer)
+      writer->WriteEvent(ev);
+  }
+  writer.reset();
+  double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+  std::cout<<builder.GetNumBuilt()<<" events built in "<<t<<" s, "
+	   <<builder.GetNumDropped()<<" incomplete dropped, "
+	   <<builder.GetNumUnordered()<<" input events out of order"<<std::endl;
+  for(size_t i = 1; i < n_sub.size(); i++)
+    std::cout<<"  "<<n_sub[i]<<" events from "<<i<<" inputs"<<std::endl;
+  return 0;
+}
@@ -0,0 +1,64 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/FileWriter.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/FileNamer.hh"
+#include <iostream>
+#include <vector>
+
+#include "TFile.h"
+#include "TTree.h"
+
+// Writes a .raw file through the "roothits" FileWriter and reads the tree
+// "Hits" back, checking one entry per event with the event numbers in order.
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ hit tree check", "2.0", "Round trip of a .raw file through the roothits writer");
+  eudaq::Option<std::string> file_input(op, "i", "input", "", "string", "input .raw file");
+  eudaq::Option<std::string> file_output(op, "o", "output", "hits$X", "string", "output file pattern");
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+
+  std::vector<uint32_t> event_n;
+  uint32_t run_n = 0;
+  try{
+    auto reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash("native"), file_input.Value());
+    auto writer = eudaq::Factory<eudaq::FileWriter>::MakeUnique(eudaq::str2hash("roothits"), file_output.Value());
+    while(auto ev = reader->GetNextEvent()){
+      run_n = ev->GetRunN();
+      event_n.push_back(ev->GetEventN());
+      writer->WriteEvent(ev);
+    }
+  }
+  catch(const std::exception &e){
+    std::cout<<e.what()<<std::endl;
+    return 1;
+  }
+
+  // the writer stamps the file name with the current time only through $D
+  std::string path(eudaq::FileNamer(file_output.Value()).Set('X', ".root").Set('R', run_n));
+  TFile file(path.c_str(), "READ");
+  TTree *tree = file.IsZombie() ? nullptr : dynamic_cast<TTree*>(file.Get("Hits"));
+  if(!tree){
+    std::cout<<"no tree Hits in "<<path<<std::endl;
+    return 1;
+  }
+  UInt_t b_event_n = 0;
+  UInt_t b_n_hit = 0;
+  tree->SetBranchAddress("event_n", &b_event_n);
+  tree->SetBranchAddress("n_hit", &b_n_hit);
+  Long64_t n = tree->GetEntries();
+  uint64_t n_hit = 0;
+  uint32_t n_bad = 0;
+  for(Long64_t i = 0; i < n; i++){
+    tree->GetEntry(i);
+    if(static_cast<size_t>(i) >= event_n.size() || b_event_n != event_n[i])
+      n_bad++;
+    n_hit += b_n_hit;
+  }
+  std::cout<<n<<" entries of "<<event_n.size()<<" events read back, "
+	   <<n_hit<<" hits, "<<n_bad<<" bad"<<std::endl;
+  return (static_cast<size_t>(n) == event_n.size() && !n_bad) ? 0 : 1;
+}
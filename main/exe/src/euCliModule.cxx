@@ -0,0 +1,53 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/ModuleManager.hh"
+#include "eudaq/StdEventConverter.hh"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line Module Manifest", "2.0",
+			 "Writes the manifest of a module, or prints the loaded modules and their load times");
+  eudaq::Option<std::string> module(op, "m", "module", "", "string", "module binary to write the manifest for");
+  eudaq::Option<std::string> output(op, "o", "output", "", "string", "manifest file, next to the module by default");
+  eudaq::Option<std::string> converter(op, "c", "converter", "", "string",
+				       "StdEventConverter to create before printing the modules, loading its module if deferred");
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+
+  auto mm = eudaq::ModuleManager::Instance();
+  if(module.Value().empty()){
+    if(!converter.Value().empty()){
+      auto cvt = eudaq::Factory<eudaq::StdEventConverter>::MakeUnique(eudaq::str2hash(converter.Value()));
+      std::cout<<converter.Value()<<": "<<(cvt ? "found" : "unknown")<<std::endl;
+    }
+    mm->Print(std::cout, 0);
+    return 0;
+  }
+
+  std::string manifest = output.Value().empty() ?
+    eudaq::ModuleManager::GetManifestPath(module.Value()) : output.Value();
+  std::vector<uint32_t> ids;
+  if(!mm->ProbeModuleFile(module.Value(), ids)){
+    // without a manifest the module is loaded at startup
+    std::remove(manifest.c_str());
+    std::cerr<<"Unable to probe "<<module.Value()<<", no manifest written"<<std::endl;
+    return 0;
+  }
+  std::ifstream bin(module.Value(), std::ios::binary | std::ios::ate);
+  std::ofstream out(manifest);
+  out<<"# factory IDs registered by "<<module.Value()<<"\n";
+  // compared with the module when it is looked up
+  out<<"# module size "<<static_cast<uint64_t>(bin.tellg())<<"\n";
+  for(auto id: ids)
+    out<<id<<"\n";
+  if(!out){
+    std::cerr<<"Unable to write "<<manifest<<std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,141 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/Processor.hh"
+#include "eudaq/ProcessorPool.hh"
+#include "eudaq/Event.hh"
+
+#include <iostream>
+#include <chrono>
+
+// Runs a chain source >> k work stages >> sink under the thread and the
+// pool scheduler, checks that the sink sees the events in order and
+// compares the throughput of both.
+namespace{
+  class BenchSource: public eudaq::Processor{
+  public:
+    BenchSource():Processor("BenchSource"), m_n(0), m_size(256){};
+    void ProduceEvent() override{
+      std::vector<uint8_t> data(m_size);
+      for(uint32_t i = 0; i < m_n && !GetProducerStopFlag(); i++){
+	auto ev = eudaq::Event::MakeShared("BenchEvent");
+	ev->SetEventN(i);
+	for(size_t j = 0; j < data.size(); j++)
+	  data[j] = static_cast<uint8_t>(i + j);
+	ev->AddBlock(0, data);
+	ForwardEvent(ev);
+      }
+    }
+    void ProcessCommand(const std::string& cmd, const std::string& arg) override{
+      if(cmd == "N")
+	m_n = std::stoul(arg);
+      else if(cmd == "SIZE")
+	m_size = std::stoul(arg);
+    }
+  private:
+    uint32_t m_n;
+    uint32_t m_size;
+  };
+
+  // checksum over the payload, repeated to emulate a converter or a filter
+  class BenchWork: public eudaq::Processor{
+  public:
+    BenchWork():Processor("BenchWork"), m_work(1), m_sum(0){};
+    void ProcessEvent(eudaq::EventSPC ev) override{
+      auto &data = ev->GetBlockRef(0);
+      uint64_t h = 1469598103934665603ULL;
+      for(uint32_t r = 0; r < m_work; r++)
+	for(auto b: data)
+	  h = (h ^ b) * 1099511628211ULL;
+      m_sum += h;
+      ForwardEvent(ev);
+    }
+    void ProcessCommand(const std::string& cmd, const std::string& arg) override{
+      if(cmd == "WORK")
+	m_work = std::stoul(arg);
+    }
+  private:
+    uint32_t m_work;
+    std::atomic<uint64_t> m_sum;
+  };
+
+  class BenchSink: public eudaq::Processor{
+  public:
+    BenchSink():Processor("BenchSink"), m_n(0), m_n_bad(0){};
+    void ProcessEvent(eudaq::EventSPC ev) override{
+      std::lock_guard<std::mutex> lk(m_mtx);
+      if(ev->GetEventN() != m_n)
+	m_n_bad++;
+      m_n++;
+      m_cv.notify_all();
+    }
+    bool WaitFor(uint32_t n, std::chrono::seconds timeout){
+      std::unique_lock<std::mutex> lk(m_mtx);
+      return m_cv.wait_for(lk, timeout, [&](){return m_n >= n;});
+    }
+    uint32_t GetNumBad(){
+      std::lock_guard<std::mutex> lk(m_mtx);
+      return m_n_bad;
+    }
+  private:
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    uint32_t m_n;
+    uint32_t m_n_bad;
+  };
+
+  auto dummy0 = eudaq::Factory<eudaq::Processor>::Register<BenchSource>(eudaq::cstr2hash("BenchSource"));
+  auto dummy1 = eudaq::Factory<eudaq::Processor>::Register<BenchWork>(eudaq::cstr2hash("BenchWork"));
+  auto dummy2 = eudaq::Factory<eudaq::Processor>::Register<BenchSink>(eudaq::cstr2hash("BenchSink"));
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Processor benchmark", "2.0", "Throughput of a processor chain under the thread and pool schedulers");
+  eudaq::Option<uint32_t> ev_n(op, "n", "events", 200000, "uint32_t", "number of events");
+  eudaq::Option<uint32_t> stage_n(op, "k", "stages", 4, "uint32_t", "number of work stages");
+  eudaq::Option<uint32_t> work_n(op, "w", "work", 4, "uint32_t", "checksum passes over the payload per stage");
+  eudaq::Option<uint32_t> size_n(op, "s", "size", 256, "uint32_t", "payload bytes per event");
+  eudaq::Option<uint32_t> batch_n(op, "b", "batch", 64, "uint32_t", "batch size of the pool scheduler");
+  eudaq::Option<std::string> mode(op, "m", "mode", "both", "string", "thread, pool or both");
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+
+  auto run = [&](eudaq::Processor::Scheduler sched){
+    eudaq::Processor::SetDefaultScheduler(sched);
+    auto src = eudaq::Processor::MakeShared("BenchSource");
+    src<<("N=" + std::to_string(ev_n.Value()))<<("SIZE=" + std::to_string(size_n.Value()));
+    src+"RawEvent";
+    auto ps = src;
+    for(uint32_t i = 0; i < stage_n.Value(); i++){
+      auto work = eudaq::Processor::MakeShared("BenchWork");
+      work<<("WORK=" + std::to_string(work_n.Value()))<<"SYS:STATELESS"
+	  <<("SYS:BATCH=" + std::to_string(batch_n.Value()));
+      work+"RawEvent";
+      ps = ps>>work;
+    }
+    auto sink = eudaq::Processor::MakeShared("BenchSink");
+    ps>>sink;
+    auto tp = std::chrono::steady_clock::now();
+    src<<"SYS:PD:RUN";
+    auto bench_sink = std::dynamic_pointer_cast<BenchSink>(sink);
+    bool done = bench_sink->WaitFor(ev_n.Value(), std::chrono::seconds(600));
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+    uint32_t n_bad = bench_sink->GetNumBad();
+    std::cout<<(sched == eudaq::Processor::SCHED_POOL ? "pool:   " : "thread: ")
+	     <<ev_n.Value()/t<<" events/s, "<<n_bad<<" out of order"
+	     <<(done ? "" : ", timed out")<<std::endl;
+    src<<"SYS:PD:STOP";
+    return done && !n_bad;
+  };
+
+  std::cout<<stage_n.Value()<<" stages, "<<eudaq::ProcessorPool::Instance().GetNumThreads()
+	   <<" pool threads"<<std::endl;
+  bool ok = true;
+  if(mode.Value() == "thread" || mode.Value() == "both")
+    ok = run(eudaq::Processor::SCHED_THREAD) && ok;
+  if(mode.Value() == "pool" || mode.Value() == "both")
+    ok = run(eudaq::Processor::SCHED_POOL) && ok;
+  return ok ? 0 : 1;
+}
@@ -1,6 +1,68 @@
 #include "eudaq/OptionParser.hh"
 #include "eudaq/RunControl.hh"
 #include <iostream>
+#include <chrono>
+#include <thread>
+
+namespace{
+  bool WaitForState(eudaq::RunControl &rc, int state, uint32_t timeout_s){
+    auto tp_end = std::chrono::steady_clock::now() + std::chrono::seconds(timeout_s);
+    while(std::chrono::steady_clock::now() < tp_end){
+      bool done = true;
+      for(auto &conn_st: rc.GetActiveConnectionStatusMap()){
+	if(conn_st.first->GetType() == "LogCollector")
+	  continue;
+	if(!conn_st.second || conn_st.second->GetState() != state)
+	  done = false;
+      }
+      if(done)
+	return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    std::cout<<"timeout waiting for state "<< state <<std::endl;
+    return false;
+  }
+
+  // Drive one complete run without user interaction and print the status
+  // tags of all connections at its end, e.g. for load tests.
+  int ExecScripted(eudaq::RunControl &rc, const std::string &ini, const std::string &conf,
+		   uint32_t n_conn, uint32_t run_s){
+    rc.StartRunControl();
+    auto tp_end = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    while(rc.GetActiveConnectionStatusMap().size() < n_conn){
+      if(std::chrono::steady_clock::now() > tp_end){
+	std::cout<<"timeout waiting for "<< n_conn <<" connections"<<std::endl;
+	rc.CloseRunControl();
+	return -1;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    rc.ReadInitilizeFile(ini);
+    rc.Initialise();
+    bool ok = WaitForState(rc, eudaq::Status::STATE_UNCONF, 60);
+    if(ok){
+      rc.ReadConfigureFile(conf);
+      rc.Configure();
+      ok = WaitForState(rc, eudaq::Status::STATE_CONF, 60);
+    }
+    if(ok){
+      rc.StartRun();
+      ok = WaitForState(rc, eudaq::Status::STATE_RUNNING, 60);
+      std::this_thread::sleep_for(std::chrono::seconds(run_s));
+      for(auto &conn_st: rc.GetActiveConnectionStatusMap()){
+	std::cout<< conn_st.first->GetType() <<"."<< conn_st.first->GetName();
+	for(auto &tag: conn_st.second->GetTags())
+	  std::cout<<"  "<< tag.first <<"="<< tag.second;
+	std::cout<<std::endl;
+      }
+      rc.StopRun();
+      WaitForState(rc, eudaq::Status::STATE_STOPPED, 60);
+    }
+    rc.Terminate();
+    return ok ? 0 : -1;
+  }
+}
 
 int main(int /*argc*/, const char **argv) {
   eudaq::OptionParser op("EUDAQ Command Line RunControl", "2.0", "The run control launcher of EUDAQ");
@@ -8,6 +70,14 @@ int main(int /*argc*/, const char **argv) {
 				  "The eudaq application to be launched");
   eudaq::Option<std::string> listen(op, "a", "listen-port", "tcp://44000", "address",
 				    "The port the run control will listen on");
+  eudaq::Option<std::string> conf(op, "c", "conf", "", "file",
+				  "Configure file, runs once through init/conf/start/stop without user interaction");
+  eudaq::Option<std::string> ini(op, "i", "ini", "", "file",
+				 "Initialise file for the scripted run, the configure file is used if empty");
+  eudaq::Option<uint32_t> nconn(op, "w", "wait-connections", 1, "number",
+				"Number of connections to wait for before the scripted run is initialised");
+  eudaq::Option<uint32_t> seconds(op, "s", "seconds", 60, "seconds",
+				  "Duration of the scripted run");
   op.Parse(argv);
   std::string app_name = name.Value();
   if(app_name.find("RunControl") != std::string::npos){
@@ -17,6 +87,9 @@ int main(int /*argc*/, const char **argv) {
       std::cout<<"unknown run control"<<std::endl;
       return -1;
     }
+    if(!conf.Value().empty())
+      return ExecScripted(*app, ini.Value().empty() ? conf.Value() : ini.Value(),
+			  conf.Value(), nconn.Value(), seconds.Value());
     app->Exec();
   }
   else{
@@ -0,0 +1,101 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/Producer.hh"
+#include "eudaq/OfflineEventBuilder.hh"
+#include "eudaq/FileWriter.hh"
+#include "eudaq/FileNamer.hh"
+#include "eudaq/Utils.hh"
+
+#include <iostream>
+#include <cstdio>
+
+// Splits a numbered stream over several collector files as a Producer with
+// EUDAQ_DC_SHARD does, each file numbered by its collector, and checks that
+// euCliEventBuilder -m shard merges them back complete and in order.
+namespace{
+  bool Check(const std::string &policy_name, uint32_t n_ev, uint32_t n_col,
+	     uint64_t slice, const std::string &dir){
+    auto policy = eudaq::Producer::ShardPolicyFromName(policy_name);
+    std::vector<std::string> paths;
+    std::vector<eudaq::FileWriterUP> writers;
+    std::vector<uint32_t> col_ev_n(n_col, 0);
+    std::vector<uint32_t> col_data_n(n_col, 0);
+    for(uint32_t i = 0; i < n_col; i++){
+      std::string patt = dir + "/shard_" + policy_name + "_" + std::to_string(i) + "$X";
+      paths.push_back(eudaq::FileNamer(patt).Set('X', ".raw"));
+      std::remove(paths.back().c_str());
+      writers.push_back(eudaq::Factory<eudaq::FileWriter>::MakeUnique(eudaq::cstr2hash("native"), patt));
+    }
+
+    uint64_t rr = 0;
+    for(uint32_t n = 0; n < n_ev + 2; n++){
+      auto ev = eudaq::Event::MakeShared("ShardCheck");
+      ev->SetRunN(1);
+      ev->SetEventN(n);
+      if(n == 0)
+	ev->SetBORE();
+      else if(n == n_ev + 1)
+	ev->SetEORE();
+      ev->SetTriggerN(n * 7);
+      ev->SetTimestamp(n * slice / 3, n * slice / 3 + 1);
+      size_t i = eudaq::Producer::ShardRoute(*ev, policy, n_col, slice, rr);
+      for(uint32_t j = 0; j < n_col; j++){
+	if(i < n_col && i != j)
+	  continue;
+	// the collector writes with its own event number
+	ev->SetEventN(col_ev_n[j]++);
+	writers[j]->WriteEvent(ev);
+	if(i < n_col)
+	  col_data_n[j]++;
+      }
+    }
+    writers.clear();
+
+    eudaq::OfflineEventBuilder builder(paths, eudaq::OfflineEventBuilder::SEQUENCE);
+    uint32_t n_merged = 0;
+    uint32_t n_bad = 0;
+    while(auto ev = builder.GetNextEvent()){
+      bool bore = n_merged == 0;
+      bool eore = n_merged == n_ev + 1;
+      if(ev->GetEventN() != n_merged || ev->IsBORE() != bore || ev->IsEORE() != eore)
+	n_bad++;
+      n_merged++;
+    }
+    bool ok = n_merged == n_ev + 2 && !n_bad;
+    std::cout<<policy_name<<": "<<n_merged<<" of "<<n_ev + 2<<" events merged, "<<n_bad<<" out of place, per collector";
+    for(auto k: col_data_n){
+      std::cout<<" "<<k;
+      ok = ok && k;
+    }
+    std::cout<<std::endl;
+    return ok;
+  }
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ shard check", "2.0", "Splits a stream by EUDAQ_DC_SHARD and merges it back");
+  eudaq::Option<uint32_t> ev_n(op, "n", "events", 1000, "uint32_t", "number of events between BORE and EORE");
+  eudaq::Option<uint32_t> col_n(op, "k", "collectors", 3, "uint32_t", "number of collectors");
+  eudaq::Option<uint64_t> slice(op, "s", "slice", 1000, "uint64_t", "EUDAQ_DC_SHARD_SLICE of the time policy");
+  eudaq::Option<std::string> policies(op, "p", "policies", "roundrobin,trigger,time", "string", "comma separated policies");
+  eudaq::Option<std::string> dir(op, "d", "directory", ".", "string", "directory of the collector files");
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+  bool ok = col_n.Value() > 1;
+  for(auto &policy: eudaq::split(policies.Value(), ",", true)){
+    try{
+      ok = Check(policy, ev_n.Value(), col_n.Value(), slice.Value(), dir.Value()) && ok;
+    }
+    catch(const std::exception &e){
+      std::cout<<policy<<": "<<e.what()<<std::endl;
+      ok = false;
+    }
+  }
+  if(!ok)
+    return 1;
+  std::cout<<"all policies merged in order"<<std::endl;
+  return 0;
+}
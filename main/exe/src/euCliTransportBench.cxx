@@ -0,0 +1,158 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/DataSender.hh"
+#include "eudaq/DataReceiver.hh"
+#include "eudaq/TransportClient.hh"
+#include "eudaq/Compression.hh"
+#include "eudaq/Event.hh"
+
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+// Sends events through DataSender and DataReceiver over the given
+// transports, checks that they arrive complete and in order and compares
+// the throughput and the latency at low rate.
+namespace{
+  // Connects like a DataSender with zlib compression and sends a corrupt
+  // frame, which the receiver has to drop together with this connection only.
+  void SendCorrupt(const std::string &addr){
+    std::unique_ptr<eudaq::TransportClient> cli(eudaq::TransportClient::CreateClient(addr));
+    std::string packet;
+    if(!cli->ReceivePacket(&packet, 1000000))
+      EUDAQ_THROW("No greeting from " + addr);
+    cli->SendPacket("OK EUDAQ DATA Producer corrupt CODEC=zlib");
+    packet.clear();
+    if(!cli->ReceivePacket(&packet, 1000000) || packet != "OK CODEC=zlib")
+      EUDAQ_THROW("zlib refused by " + addr + ": " + packet);
+    cli->SendPacket(std::string("\x10\0\0\0not a zlib stream", 21));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  }
+
+  uint64_t Now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+      (std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  class BenchReceiver: public eudaq::DataReceiver{
+  public:
+    BenchReceiver():m_n(0), m_n_bad(0), m_lat(0){};
+    void OnReceive(eudaq::ConnectionSPC, eudaq::EventSP ev) override{
+      uint64_t t = Now();
+      std::lock_guard<std::mutex> lk(m_mtx);
+      auto &data = ev->GetBlockRef(0);
+      if(ev->GetEventN() != m_n || data.empty() || data.back() != static_cast<uint8_t>(m_n))
+	m_n_bad++;
+      m_lat += t - ev->GetTimestampBegin();
+      m_n++;
+      m_cv.notify_all();
+    }
+    bool WaitFor(uint32_t n, std::chrono::seconds timeout){
+      std::unique_lock<std::mutex> lk(m_mtx);
+      return m_cv.wait_for(lk, timeout, [&](){return m_n >= n;});
+    }
+    // number of bad events and mean latency in us since the last Reset
+    std::pair<uint32_t, double> Result(){
+      std::lock_guard<std::mutex> lk(m_mtx);
+      return std::make_pair(m_n_bad, m_n ? m_lat / 1000.0 / m_n : 0);
+    }
+    void Reset(){
+      std::lock_guard<std::mutex> lk(m_mtx);
+      m_n = 0;
+      m_n_bad = 0;
+      m_lat = 0;
+    }
+  private:
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    uint32_t m_n;
+    uint32_t m_n_bad;
+    uint64_t m_lat;
+  };
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Transport benchmark", "2.0", "Throughput and latency of the data transports");
+  eudaq::Option<uint32_t> ev_n(op, "n", "events", 5000, "uint32_t", "number of events of the throughput run");
+  eudaq::Option<uint32_t> size_n(op, "s", "size", 65536, "uint32_t", "payload bytes per event");
+  eudaq::Option<uint32_t> lat_n(op, "l", "latency", 200, "uint32_t", "number of events of the latency run, sent 1 ms apart");
+  eudaq::Option<std::string> protos(op, "t", "transports", "tcp,shm", "string", "comma separated list of tcp and shm");
+  eudaq::Option<uint32_t> port(op, "p", "port", 44999, "uint32_t", "port of the tcp server");
+  eudaq::Option<std::string> codec(op, "c", "codec", "none", "string", "compression of the events: none, zlib, lz4 or zstd");
+  eudaq::OptionFlag corrupt(op, "b", "bad", "send a corrupt frame over a second connection first");
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+
+  auto run = [&](const std::string &proto){
+    std::string addr_srv, addr_cli;
+    if(proto == "tcp"){
+      addr_srv = "tcp://" + std::to_string(port.Value());
+      addr_cli = "tcp://localhost:" + std::to_string(port.Value());
+    }
+    else{
+      addr_srv = addr_cli = proto + "://eudaq_bench_" + std::to_string(port.Value());
+    }
+    BenchReceiver rcv;
+    rcv.Listen(addr_srv);
+    if(corrupt.Value())
+      SendCorrupt(addr_cli);
+    eudaq::DataSender snd("Producer", "bench");
+    if(codec.Value() != "none")
+      snd.SetCompression(eudaq::CodecFromName(codec.Value()));
+    snd.Connect(addr_cli);
+
+    std::vector<uint8_t> data(size_n.Value());
+    uint32_t n = 0;
+    auto send = [&](){
+      auto ev = eudaq::Event::MakeShared("BenchEvent");
+      ev->SetEventN(n);
+      for(size_t j = 0; j < data.size(); j++)
+	data[j] = static_cast<uint8_t>(n + j);
+      data.back() = static_cast<uint8_t>(n);
+      ev->AddBlock(0, data);
+      ev->SetTimestamp(Now(), 0);
+      snd.SendEvent(ev);
+      n++;
+    };
+
+    auto tp = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < ev_n.Value(); i++)
+      send();
+    bool done = rcv.WaitFor(n, std::chrono::seconds(600));
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+    auto res = rcv.Result();
+    std::cout<<proto<<": "<<ev_n.Value()/t<<" events/s, "<<ev_n.Value()/t*data.size()/1e6<<" MB/s, "
+	     <<res.first<<" bad"<<(done ? "" : ", timed out")<<std::endl;
+    bool ok = done && !res.first;
+
+    rcv.Reset();
+    n = 0;
+    for(uint32_t i = 0; i < lat_n.Value(); i++){
+      send();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    done = rcv.WaitFor(n, std::chrono::seconds(60));
+    res = rcv.Result();
+    std::cout<<proto<<": "<<res.second<<" us mean latency, "<<res.first<<" bad"
+	     <<(done ? "" : ", timed out")<<std::endl;
+    rcv.StopListen();
+    return ok && done && !res.first;
+  };
+
+  bool ok = true;
+  for(auto &proto: eudaq::split(protos.Value(), ",", true)){
+    try{
+      ok = run(proto) && ok;
+    }
+    catch(const std::exception &e){
+      std::cout<<proto<<": "<<e.what()<<std::endl;
+      ok = false;
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -5,6 +5,7 @@
 #include "eudaq/Platform.hh"
 #include "eudaq/Configuration.hh"
 #include "eudaq/Logger.hh"
+#include "eudaq/BufferSerializer.hh"
 
 #include <thread>
 #include <memory>
@@ -14,6 +15,10 @@
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <map>
 
 namespace eudaq {
 
@@ -37,10 +42,19 @@ namespace eudaq {
     virtual void RunLoop();
     std::string Connect();
     void Disconnect();
+    /**
+     * Sends the level, state, message and the tags changed since the last
+     * update. Updates without a change of state closer than
+     * EUDAQ_STATUS_INTERVAL_MS (init section, default 500) are coalesced.
+     */
     void SendStatus();
     void SetStatus(Status::State, const std::string&);
     void SetStatusMsg(const std::string&);
     void SetStatusTag(const std::string &key, const std::string &val);
+    /// Numeric tag, carried as an integer in the status updates
+    void SetStatusCounter(const std::string &key, int64_t val);
+    /// Sets several tags with one lock
+    void SetStatusTags(const std::map<std::string, std::string> &tags);
 
     std::string GetFullName() const;
     std::string GetName() const;
@@ -59,6 +73,8 @@ namespace eudaq {
     bool AsyncForwarding();
     bool AsyncReceiving();
     bool RunLooping();
+    void PublishMetrics();
+    void PublishStatus(bool force);
 
   private:
     std::unique_ptr<TransportClient> m_cmdclient;
@@ -77,11 +93,21 @@ namespace eudaq {
     std::condition_variable m_cv_not_empty;
     Status m_status;
     std::mutex m_mtx_status;
+    std::mutex m_mtx_send;
+    BufferSerializer m_status_buf;
+    std::set<std::string> m_status_dirty;
+    bool m_status_full;
+    std::atomic<bool> m_status_pending;
+    int m_status_sent_state;
+    int m_status_sent_level;
+    std::chrono::steady_clock::time_point m_tp_status_sent;
+    std::chrono::milliseconds m_status_interval;
     std::shared_ptr<Configuration> m_conf;
     std::shared_ptr<Configuration> m_conf_init;
     std::string m_type;
     std::string m_name;
     uint32_t m_run_number;
+    std::string m_metrics_file;
   };
 }
 
@@ -0,0 +1,71 @@
+#ifndef EUDAQ_INCLUDED_Compression
+#define EUDAQ_INCLUDED_Compression
+
+#include "eudaq/Platform.hh"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace eudaq {
+
+  /**
+   * Block codecs. The numbers are stored in files and sent over the wire,
+   * never renumber them. Which codecs are usable depends on the libraries
+   * found when the core library was built, see CodecAvailable().
+   */
+  enum class Codec : uint8_t {
+    NONE = 0,
+    ZLIB = 1,
+    LZ4 = 2,
+    ZSTD = 3
+  };
+
+  DLLEXPORT bool CodecAvailable(Codec c);
+  DLLEXPORT std::string CodecName(Codec c);
+  /// Codec from its name ("none", "zlib", "lz4", "zstd"), throws if unknown or unavailable
+  DLLEXPORT Codec CodecFromName(const std::string &name);
+  /// Fastest available codec with a reasonable ratio: zstd, lz4, zlib or none
+  DLLEXPORT Codec DefaultCodec();
+
+  /// Replaces dst by the compressed src, level 0 selects the default of the codec
+  DLLEXPORT void Compress(Codec c, int level, const uint8_t *src, size_t len,
+			  std::vector<uint8_t> &dst);
+  /// Replaces dst by the decompressed src, raw_len is the exact uncompressed size
+  DLLEXPORT void Decompress(Codec c, const uint8_t *src, size_t len, size_t raw_len,
+			    std::vector<uint8_t> &dst);
+
+  /**
+   * Compression of a sequence of blocks sharing one history, e.g. the
+   * packets of a connection: every block is decodable as soon as it
+   * arrives, but matches against the preceding ones, so that small events
+   * after the BORE compress well. The blocks have to be decompressed by one
+   * StreamDecompressor in the same order.
+   */
+  class DLLEXPORT StreamCompressor {
+  public:
+    StreamCompressor(Codec c, int level = 0);
+    ~StreamCompressor();
+    Codec GetCodec() const {return m_codec;}
+    void Compress(const uint8_t *src, size_t len, std::vector<uint8_t> &dst);
+    struct State;
+  private:
+    Codec m_codec;
+    std::unique_ptr<State> m_state;
+  };
+
+  class DLLEXPORT StreamDecompressor {
+  public:
+    StreamDecompressor(Codec c);
+    ~StreamDecompressor();
+    Codec GetCodec() const {return m_codec;}
+    void Decompress(const uint8_t *src, size_t len, size_t raw_len, std::vector<uint8_t> &dst);
+    struct State;
+  private:
+    Codec m_codec;
+    std::unique_ptr<State> m_state;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_Compression
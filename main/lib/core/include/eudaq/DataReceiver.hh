@@ -10,6 +10,7 @@
 #include "eudaq/Utils.hh"
 #include "eudaq/Platform.hh"
 #include "eudaq/Factory.hh"
+#include "eudaq/Compression.hh"
 
 #include <string>
 #include <vector>
@@ -22,6 +23,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <type_traits>
+#include <tuple>
+#include <map>
 
 namespace eudaq {
   class DataReceiver;
@@ -55,8 +58,12 @@ namespace eudaq {
     std::future<bool> m_fut_deamon;
     std::mutex m_mx_qu_ev;
     std::mutex m_mx_deamon;
-    std::queue<std::pair<EventSP, ConnectionSPC>> m_qu_ev;
+    // event, its connection and the time it was queued
+    std::queue<std::tuple<EventSP, ConnectionSPC, uint64_t>> m_qu_ev;
     std::condition_variable m_cv_not_empty;
+    // connections negotiated with compression, only touched by DataHandler
+    std::map<ConnectionSP, std::unique_ptr<StreamDecompressor>> m_decomp;
+    std::vector<uint8_t> m_decomp_buf;
   };
   //----------DOC-MARK-----END*DEC-----DOC-MARK----------
 }
@@ -4,7 +4,9 @@
 
 #include "eudaq/Platform.hh"
 #include "eudaq/Event.hh"
+#include "eudaq/Compression.hh"
 #include <string>
+#include <atomic>
 #include <future>
 #include <thread>
 #include <queue>
@@ -14,15 +16,22 @@
 namespace eudaq {
 
 class TransportClient;
+class BufferSerializer;
 
   class DLLEXPORT DataSender {
   public:
       DataSender(const std::string & type, const std::string & name);
       ~DataSender();
+      /// Codec requested at the next Connect, used only if the receiver supports it
+      void SetCompression(Codec c, int level = 0);
       void Connect(const std::string & server);
       void SendEvent(EventSPC ev);
+      /// Serialized and transmitted bytes since the last Connect
+      uint64_t GetRawBytes() const {return m_bytes_raw;}
+      uint64_t GetSentBytes() const {return m_bytes_sent;}
   private:
       bool AsyncSending();
+      void Send(const BufferSerializer &ser);
       std::string m_type, m_name;
       std::unique_ptr<TransportClient> m_dataclient;
       uint64_t m_packetCounter;
@@ -31,6 +40,14 @@ class TransportClient;
       std::mutex m_mx_qu_ev; 
       std::queue<EventSPC> m_qu_ev;
       std::condition_variable m_cv_not_empty;
+      Codec m_codec;
+      int m_level;
+      std::unique_ptr<StreamCompressor> m_comp;
+      std::mutex m_mx_send;
+      std::vector<uint8_t> m_comp_block;
+      std::vector<uint8_t> m_comp_buf;
+      std::atomic<uint64_t> m_bytes_raw;
+      std::atomic<uint64_t> m_bytes_sent;
   };
 
 }
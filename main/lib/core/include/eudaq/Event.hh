@@ -52,8 +52,10 @@ namespace eudaq {
     
     bool HasTag(const std::string &name) const;
     void SetTag(const std::string &name, const std::string &val);
+    void RemoveTag(const std::string &name);
     std::string GetTag(const std::string &name, const std::string &def = "") const;
     std::map<std::string, std::string> GetTags() const;
+    const std::map<std::string, std::string>& GetTagsRef() const {return m_tags;}
     
     void SetFlagBit(uint32_t f);
     void ClearFlagBit(uint32_t f);
@@ -116,6 +118,8 @@ namespace eudaq {
 
     //from RawdataEvent
     std::vector<uint8_t> GetBlock(uint32_t i) const;
+    /// Block i without a copy, an empty block if it does not exist
+    const std::vector<uint8_t>& GetBlockRef(uint32_t i) const;
     size_t GetNumBlock() const;
     size_t NumBlocks() const;
     std::vector<uint32_t> GetBlockNumList() const;
@@ -127,6 +131,12 @@ namespace eudaq {
       return m_blocks.size();
     }
 
+    /// Add a data block by taking over the storage of the given vector
+    size_t AddBlock(uint32_t id, std::vector<uint8_t> &&data){
+      m_blocks[id]=std::move(data);
+      return m_blocks.size();
+    }
+
     /// Add a data block as array with given size
     template <typename T>
     size_t AddBlock(uint32_t id, const T *data, size_t bytes){
@@ -1,14 +1,26 @@
 #ifndef FACTORY_HH_
 #define FACTORY_HH_
+#include "Platform.hh"
+
 #include <map>
 #include <memory>
 #include <iostream>
 #include <utility>
 #include <functional>
 #include <cstdint>
+#include <mutex>
+#include <atomic>
+#include <vector>
 
 namespace eudaq{
 
+  /// Guards the maps of all factories, modules may register from any thread
+  DLLEXPORT std::mutex& FactoryMutex();
+  /// Called by Register, lets the ModuleManager record the IDs of a module
+  DLLEXPORT void FactoryRegistered(std::uint32_t id);
+  /// Loads the deferred modules providing the ID, true if any was loaded
+  DLLEXPORT bool FactoryLoadModules(std::uint32_t id);
+
   template <typename BASE>
   class Factory{
   public:
@@ -43,6 +55,21 @@ namespace eudaq{
     Register(std::uint32_t id);
     
   private:
+    /// The map returned by Instance, with a copy that is read without locking
+    template <typename... ARGS>
+    struct Registry: public std::map<std::uint32_t, UP_BASE (*)(ARGS&&...)>{
+      using Map = std::map<std::uint32_t, UP_BASE (*)(ARGS&&...)>;
+      std::atomic<const Map*> published{nullptr};
+      std::vector<std::unique_ptr<const Map>> copies; // readers may still hold older ones
+      bool stale = false;
+      // under FactoryMutex
+      void Publish(){
+	copies.emplace_back(new Map(*this));
+	published.store(copies.back().get(), std::memory_order_release);
+	stale = false;
+      }
+    };
+
     template <typename DERIVED, typename... ARGS>
       static UP_BASE MakerFun(ARGS&& ...args){
       return UP_BASE(new DERIVED(std::forward<ARGS>(args)...), [](BASE *p) {delete p; });
@@ -53,14 +80,32 @@ namespace eudaq{
   template <typename ...ARGS>
   typename Factory<BASE>::UP_BASE
   Factory<BASE>::MakeUnique(std::uint32_t id, ARGS&& ...args){
-    auto &ins = Instance<ARGS&&...>();
-    auto it = ins.find(id);
-    if (it == ins.end()){
+    auto &ins = static_cast<Registry<ARGS&&...>&>(Instance<ARGS&&...>());
+    UP_BASE (*maker)(ARGS&&...) = nullptr;
+    auto pub = ins.published.load(std::memory_order_acquire);
+    if(pub){
+      auto it = pub->find(id);
+      if(it != pub->end())
+	maker = it->second;
+    }
+    for(int attempt = 0; attempt < 2 && !maker; attempt++){
+      // a miss publishes the recent registrations, then loads the modules
+      // which the manifests list for this ID
+      if(attempt && !FactoryLoadModules(id))
+	break;
+      std::lock_guard<std::mutex> lk(FactoryMutex());
+      if(ins.stale)
+	ins.Publish();
+      auto it = ins.find(id);
+      if(it != ins.end())
+	maker = it->second;
+    }
+    if(!maker){
       std::cerr<<"Factory<"<<static_cast<const void *>(&ins)<<">: "
 	       <<" Unknown class ID: <"<<id<<">\n";
       return nullptr;
     }
-    return (it->second)(std::forward<ARGS>(args)...);
+    return maker(std::forward<ARGS>(args)...);
   }
 
   template <typename BASE>
@@ -83,7 +128,7 @@ namespace eudaq{
   template <typename... ARGS>
   std::map<std::uint32_t, typename Factory<BASE>::UP_BASE (*)(ARGS&&...)>&
   Factory<BASE>::Instance(){
-    static std::map<std::uint32_t, typename Factory<BASE>::UP_BASE (*)(ARGS&&...)> m;
+    static Registry<ARGS...> m;
     static bool init = true;
     if(init){
       // std::cout<<"Instance a new Factory<"<<static_cast<const void *>(&m)<<">"<<std::endl;
@@ -96,10 +141,15 @@ namespace eudaq{
   template <typename DERIVED, typename... ARGS>
   std::uint64_t
   Factory<BASE>::Register(std::uint32_t id){
-    auto &ins = Instance<ARGS&&...>();
+    auto &ins = static_cast<Registry<ARGS&&...>&>(Instance<ARGS&&...>());
     // std::cout<<"Register ID "<<id <<"  to Factory<"
     // 	     <<static_cast<const void *>(&ins)<<">    ";
-    ins[id] = &MakerFun<DERIVED, ARGS&&...>;
+    {
+      std::lock_guard<std::mutex> lk(FactoryMutex());
+      ins[id] = &MakerFun<DERIVED, ARGS&&...>;
+      ins.stale = true;
+    }
+    FactoryRegistered(id);
     // std::cout<<"   map items: ";
     // for(auto& e: ins)
     //   std::cout<<e.first<<"  ";
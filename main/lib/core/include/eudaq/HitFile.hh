@@ -0,0 +1,103 @@
+#ifndef EUDAQ_INCLUDED_HitFile
+#define EUDAQ_INCLUDED_HitFile
+
+#include "eudaq/Platform.hh"
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace eudaq {
+
+  /**
+   * Columnar file of StandardEvent hits, written by the FileWriter "hits".
+   * All numbers are little endian.
+   *
+   *   header:  "EUDAQHIT", u32 version, u32 n_column,
+   *            per column u8 group ('E'vent, 'P'lane, 'H'it), u8 type
+   *            ('I' u32, 'L' u64, 'F' f32), u16 name length, name
+   *   chunks:  "CHNK", u32 0, HitChunkStat, then per column in header order
+   *            u64 length and the values, padded to 8 bytes
+   *   footer:  u32 n_plane, per plane u32 id, xsize, ysize and the strings
+   *            type, sensor (u32 length, chars); u32 n_chunk, per chunk
+   *            u64 offset and HitChunkStat
+   *   trailer: u64 offset of the footer, "EUDAQEND"
+   *
+   * Event columns are indexed by the event within the chunk, the plane and
+   * hit columns refer to it in plane_event/hit_event. The statistics allow
+   * to skip chunks without touching their columns. A file without trailer
+   * (e.g. after a crash) is still readable by walking through the chunks,
+   * only the plane descriptions of the footer are missing then.
+   */
+  struct HitChunkStat {
+    uint32_t n_event;
+    uint32_t n_plane;
+    uint32_t n_hit;
+    uint32_t event_min;
+    uint32_t event_max;
+    uint32_t trigger_min;
+    uint32_t trigger_max;
+    uint32_t reserved;
+    uint64_t time_min;
+    uint64_t time_max;
+  };
+
+  struct HitPlaneInfo {
+    uint32_t id;
+    uint32_t xsize;
+    uint32_t ysize;
+    std::string type;
+    std::string sensor;
+  };
+
+  /// Read-only, memory mapped view of a hit file
+  class DLLEXPORT HitFile {
+  public:
+    explicit HitFile(const std::string &path);
+    ~HitFile();
+    HitFile(const HitFile&) = delete;
+    HitFile& operator = (const HitFile&) = delete;
+
+    size_t NumChunks() const {return m_chunks.size();}
+    const HitChunkStat& GetChunkStat(size_t i) const {return m_chunks.at(i).stat;}
+    const std::map<uint32_t, HitPlaneInfo>& GetPlanes() const {return m_planes;}
+    bool HasColumn(const std::string &name) const;
+
+    /// Values of a column in a chunk, nullptr if the file has no such column
+    template <typename T> const T* Column(size_t chunk, const std::string &name) const {
+      return static_cast<const T*>(ColumnData(chunk, name, TypeCode<T>()));
+    }
+
+    static const uint32_t VERSION = 1;
+  private:
+    struct Chunk {
+      HitChunkStat stat;
+      std::vector<const uint8_t*> cols;
+    };
+    struct ColumnInfo {
+      char group;
+      char type;
+      std::string name;
+    };
+    template <typename T> static char TypeCode();
+    const void* ColumnData(size_t chunk, const std::string &name, char type) const;
+    void Map(const std::string &path);
+    size_t ParseHeader();
+    /// Position after the chunk, 0 if it is incomplete
+    size_t ParseChunk(size_t pos, Chunk &chunk) const;
+    void ParseFooter(size_t pos);
+
+    const uint8_t *m_data;
+    size_t m_size;
+    std::vector<uint8_t> m_buffer;
+    std::vector<ColumnInfo> m_columns;
+    std::vector<Chunk> m_chunks;
+    std::map<uint32_t, HitPlaneInfo> m_planes;
+  };
+
+  template <> inline char HitFile::TypeCode<uint32_t>(){return 'I';}
+  template <> inline char HitFile::TypeCode<uint64_t>(){return 'L';}
+  template <> inline char HitFile::TypeCode<float>(){return 'F';}
+}
+
+#endif // EUDAQ_INCLUDED_HitFile
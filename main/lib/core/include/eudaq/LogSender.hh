@@ -4,13 +4,18 @@
 #include "eudaq/TransportClient.hh"
 #include "eudaq/Serializer.hh"
 #include "eudaq/Status.hh"
+#include "eudaq/LogMessage.hh"
 #include "Platform.hh"
 #include <string>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 
 namespace eudaq {
 
-  class LogMessage;
-
   class DLLEXPORT LogSender {
   public:
     LogSender();
@@ -21,7 +26,7 @@ namespace eudaq {
     void SendLogMessage(const LogMessage &);
     void SendLogMessage(const LogMessage &msg, std::ostream &out,
                         std::ostream &error_out);
-    void SetLevel(int level) { m_level = level; }
+    void SetLevel(int level) { m_level = level; UpdateThreshold(); }
     void SetLevel(const std::string &level) {
       SetLevel(Status::String2Level(level));
     }
@@ -29,18 +34,64 @@ namespace eudaq {
     void SetErrLevel(const std::string &level) {
       SetErrLevel(Status::String2Level(level));
     }
+    /// Lowest level which is still sent to a connected LogCollector, DEBUG by default
+    void SetSendLevel(int level) { m_sendlevel = level; UpdateThreshold(); }
+    void SetSendLevel(const std::string &level) {
+      SetSendLevel(Status::String2Level(level));
+    }
     bool IsLogged(const std::string &level) {
       return Status::String2Level(level) >= m_level;
     }
+    /// Cheap check whether a message of this level would reach any output,
+    /// used by the EUDAQ_*_LAZY macros before the message is formatted
+    bool IsLogged(int level) const {
+      return level >= m_threshold.load(std::memory_order_relaxed);
+    }
+
+    /// Move printing and sending into a background thread with a bounded
+    /// queue, so that the logging thread never waits on the LogCollector
+    void SetAsync(bool async, size_t queue_size = 10000);
+    bool IsAsync() const { return m_is_async; }
+    /// Window in which identical messages are collapsed into one line
+    void SetRepeatWindow(uint32_t ms) { m_repeat_window_ms = ms; }
+    uint64_t GetDroppedCount() const { return m_n_dropped; }
+    uint64_t GetSuppressedCount() const { return m_n_suppressed; }
 
   private:
+    void DoSendLogMessage(const LogMessage &msg, std::ostream &out,
+                          std::ostream &error_out);
+    bool IsRepeated(const LogMessage &msg, std::ostream &error_out);
+    void AsyncSending();
+    void StopAsync();
+    /// Lowest level of the print level and, while connected, the send level
+    void UpdateThreshold();
+
     std::string m_name;
     TransportClient *m_logclient;
-    int m_level;
-    int m_errlevel;
+    std::atomic<int> m_level;
+    std::atomic<int> m_errlevel;
+    std::atomic<int> m_sendlevel;
+    std::atomic<bool> m_is_sending;
+    std::atomic<int> m_threshold;
     bool m_shownotconnected;
     bool isConnected = false;
     std::recursive_mutex m_mutex;
+
+    std::mutex m_mx_async;
+    std::atomic<bool> m_is_async;
+    size_t m_qu_max;
+    std::deque<LogMessage> m_qu_msg;
+    std::mutex m_mx_qu_msg;
+    std::condition_variable m_cv_not_empty;
+    std::thread m_th_async;
+    std::atomic<uint64_t> m_n_dropped;
+    uint64_t m_n_dropped_reported;
+
+    std::atomic<uint32_t> m_repeat_window_ms;
+    std::atomic<uint64_t> m_n_suppressed;
+    std::string m_last_key;
+    uint32_t m_n_repeat;
+    std::chrono::steady_clock::time_point m_tp_last;
   };
 }
 
@@ -12,6 +12,7 @@ namespace eudaq {
 #define EUDAQ_LOG_LEVEL(level) ::eudaq::GetLogger().SetLevel(level)
 #define EUDAQ_ERR_LEVEL(level) ::eudaq::GetLogger().SetErrLevel(level)
 #define EUDAQ_IS_LOGGED(level) ::eudaq::GetLogger().IsLogged(level)
+#define EUDAQ_LOG_ASYNC(async, size) ::eudaq::GetLogger().SetAsync(async, size)
 #define EUDAQ_LOG_CONNECT(type, name, server)                                  \
   ::eudaq::GetLogger().Connect(type, name, server)
 
@@ -26,6 +27,19 @@ namespace eudaq {
 #define EUDAQ_ERROR(msg) EUDAQ_LOG(ERROR, msg)
 #define EUDAQ_USER(msg) EUDAQ_LOG(USER, msg)
 
+// The message expression of the lazy form is only evaluated when the level
+// passes the current filter, so it is safe to use in hot paths.
+#define EUDAQ_LOG_LAZY(level, msg)                                             \
+  do {                                                                         \
+    if (::eudaq::GetLogger().IsLogged(::eudaq::LogMessage::LVL_##level))       \
+      EUDAQ_LOG(level, msg);                                                   \
+  } while (0)
+#define EUDAQ_DEBUG_LAZY(msg) EUDAQ_LOG_LAZY(DEBUG, msg)
+#define EUDAQ_EXTRA_LAZY(msg) EUDAQ_LOG_LAZY(EXTRA, msg)
+#define EUDAQ_INFO_LAZY(msg) EUDAQ_LOG_LAZY(INFO, msg)
+#define EUDAQ_WARN_LAZY(msg) EUDAQ_LOG_LAZY(WARN, msg)
+#define EUDAQ_ERROR_LAZY(msg) EUDAQ_LOG_LAZY(ERROR, msg)
+
 #define EUDAQ_LOG_STREAMOUT(level, msg, outStream, error_stream)               \
   ::eudaq::GetLogger().SendLogMessage(                                         \
       ::eudaq::LogMessage(msg, ::eudaq::LogMessage::LVL_##level)               \
@@ -0,0 +1,91 @@
+#ifndef EUDAQ_INCLUDED_Metrics
+#define EUDAQ_INCLUDED_Metrics
+
+#include "eudaq/Platform.hh"
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace eudaq {
+  class Event;
+
+  class DLLEXPORT MetricCounter {
+  public:
+    MetricCounter():m_val(0){}
+    void Add(uint64_t n = 1){m_val.fetch_add(n, std::memory_order_relaxed);}
+    uint64_t Get() const {return m_val.load(std::memory_order_relaxed);}
+  private:
+    std::atomic<uint64_t> m_val;
+  };
+
+  /**
+   * Latency histogram in nanoseconds with log-linear buckets in the manner
+   * of HdrHistogram: 32 linear sub-buckets per power of two, i.e. a relative
+   * resolution of about 3%. Recording is lock-free.
+   */
+  class DLLEXPORT LatencyHistogram {
+  public:
+    LatencyHistogram();
+    void Record(uint64_t ns);
+    uint64_t Count() const;
+    uint64_t Sum() const {return m_sum.load(std::memory_order_relaxed);}
+    uint64_t Max() const {return m_max.load(std::memory_order_relaxed);}
+    uint64_t Percentile(double q) const;
+
+    static const uint32_t SUB_BITS = 5;
+    static const uint32_t MAX_BITS = 40;
+    static const uint32_t N_BUCKET = (MAX_BITS - SUB_BITS + 1) << SUB_BITS;
+  private:
+    static uint32_t Index(uint64_t ns);
+    static uint64_t Value(uint32_t idx);
+    std::atomic<uint64_t> m_bucket[N_BUCKET];
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+  };
+
+  /**
+   * Process wide registry of counters and latency histograms. Lookups take a
+   * lock, so hot paths should keep the returned reference, which stays valid
+   * for the lifetime of the process.
+   */
+  class DLLEXPORT Metrics {
+  public:
+    static Metrics& Instance();
+    MetricCounter& Counter(const std::string &name);
+    LatencyHistogram& Histogram(const std::string &stage);
+
+    void SetEnabled(bool en){m_enabled = en;}
+    bool IsEnabled() const {return m_enabled;}
+
+    /// Counter values, sent as numeric status tags
+    std::map<std::string, uint64_t> StatusCounters();
+    /// Latency summaries of the histograms as status tags
+    std::map<std::string, std::string> StatusTags();
+    std::string Prometheus(const std::string &component);
+    void WritePrometheus(const std::string &path, const std::string &component);
+
+    /// Monotonic clock shared by all processes of one host
+    static uint64_t NowNs(){
+      return std::chrono::duration_cast<std::chrono::nanoseconds>
+	(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    /// Tags the event with the send time and the host, see TakeSendStamp
+    static void StampSend(Event &ev);
+    /// Removes the tag of StampSend, false unless it was stamped on this host
+    static bool TakeSendStamp(Event &ev, uint64_t &since_ns);
+    static const std::string& HostName();
+  private:
+    Metrics();
+    std::atomic<bool> m_enabled;
+    std::mutex m_mtx;
+    std::map<std::string, std::unique_ptr<MetricCounter>> m_counters;
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> m_hists;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_Metrics
@@ -5,22 +5,39 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <mutex>
+#include <cstdint>
 
 class ModuleManager;
 
 namespace eudaq{
+  /**
+   * Loads the user modules. A module with an up to date manifest (the
+   * factory IDs it registers, written at build time by euCliModule) is only
+   * loaded when one of its IDs is asked for, other modules are loaded at
+   * startup. EUDAQ_MODULE_LOAD_ALL=1 loads all modules at startup.
+   */
   class ModuleManager{
   public:
     static ModuleManager* Instance();
     static std::string GetModulePath();
+    static std::string GetManifestPath(const std::string& file);
     ModuleManager(const ModuleManager&) = delete;
     ModuleManager& operator=(const ModuleManager&) = delete;
     uint32_t LoadModuleDir(const std::string& dir);
     bool LoadModuleFile(const std::string& file);
+    bool LoadModulesFor(uint32_t id);
+    bool ProbeModuleFile(const std::string& file, std::vector<uint32_t>& ids);
     void Print(std::ostream& os, size_t offset) const;
   private:
     ModuleManager();
+    bool ReadManifest(const std::string& file);
     std::map<std::string, void*> m_modules;
+    std::map<std::string, double> m_load_ms;
+    std::multimap<uint32_t, std::string> m_deferred;
+    bool m_load_all;
+    double m_startup_ms;
+    mutable std::recursive_mutex m_mtx;
   };
 }
 
@@ -0,0 +1,88 @@
+#ifndef EUDAQ_INCLUDED_OfflineEventBuilder
+#define EUDAQ_INCLUDED_OfflineEventBuilder
+
+#include "eudaq/Platform.hh"
+#include "eudaq/Event.hh"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace eudaq {
+  /**
+   * Builds synchronised events out of several data files, e.g. written per
+   * producer by DirectSaveDataCollector, like TriggerIDSyncDataCollector and
+   * TimestampSyncDataCollector do online. Each input is read ahead by its
+   * own thread into a queue of at most SetQueueSize() events. The inputs are
+   * merged in the order of their trigger numbers (TRIGGER_N) or of their
+   * begin timestamps (TIMESTAMP): a built event is a packet with the events
+   * of all inputs at the smallest trigger number, or with the events of all
+   * inputs beginning within SetTimeWindow() of the earliest one.
+   * SEQUENCE merges the files of one producer split over several
+   * collectors (EUDAQ_DC_SHARD) back into a single stream: the events are
+   * returned as they are, in the order of the producer's event numbers,
+   * and the BORE and EORE found in every file only once.
+   * The inputs have to be ordered by this key.
+   */
+  class DLLEXPORT OfflineEventBuilder {
+  public:
+    enum Mode {
+      TRIGGER_N,
+      TIMESTAMP,
+      SEQUENCE
+    };
+    OfflineEventBuilder(const std::vector<std::string> &paths, Mode mode);
+    ~OfflineEventBuilder();
+    OfflineEventBuilder(const OfflineEventBuilder&) = delete;
+    OfflineEventBuilder& operator=(const OfflineEventBuilder&) = delete;
+
+    void SetTimeWindow(uint64_t window) {m_window = window;}
+    /// Drop the built events which miss an input (default: keep them)
+    void SetRequireAll(bool require) {m_require_all = require;}
+    /// Events read ahead per input, to be set before the first GetNextEvent
+    void SetQueueSize(size_t n) {m_queue_size = n;}
+    /// Next built event, nullptr when all the inputs are exhausted
+    EventSP GetNextEvent();
+    uint64_t GetNumBuilt() const {return m_n_built;}
+    uint64_t GetNumDropped() const {return m_n_dropped;}
+    /// Input events dropped because they were out of order
+    uint64_t GetNumUnordered() const {return m_n_unordered;}
+
+  private:
+    struct Input {
+      std::string path;
+      std::thread th;
+      std::mutex mtx;
+      std::condition_variable cv;
+      std::deque<EventSPC> que;
+      bool done = false;
+      EventSPC front;
+      uint64_t last_key = 0;
+      bool warned = false;
+    };
+    void Start();
+    void Reading(Input &in);
+    bool Advance(Input &in);
+    uint64_t Key(const EventSPC &ev) const;
+
+    std::vector<std::unique_ptr<Input>> m_inputs;
+    Mode m_mode;
+    uint64_t m_window;
+    bool m_require_all;
+    size_t m_queue_size;
+    bool m_started;
+    std::atomic_bool m_exit;
+    uint32_t m_run_n;
+    uint32_t m_ev_n;
+    uint64_t m_n_built;
+    uint64_t m_n_dropped;
+    uint64_t m_n_unordered;
+  };
+}
+
+#endif
@@ -10,6 +10,8 @@
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
+#include <map>
+#include <deque>
 
 #include "Event.hh"
 #include "Factory.hh"
@@ -28,8 +30,25 @@ namespace eudaq {
   using ProcessorSP = Factory<Processor>::SP_BASE;
   using ProcessorWP = Factory<Processor>::WP_BASE;
   
+  /**
+   * A stage of an event processing graph. In the thread scheduler (the
+   * default) every processor relays its events through hub and consumer
+   * threads. In the pool scheduler (EUDAQ_PROC_SCHEDULER=pool, or
+   * SetDefaultScheduler before the processors are made) a processor is a
+   * task on the shared ProcessorPool which handles the queued events in
+   * batches of up to SYS:BATCH (default 64) and forwards the events of a
+   * batch together. A processor marked SYS:STATELESS may handle several
+   * batches at once, its output is forwarded in the order of its input.
+   */
   class DLLEXPORT Processor: public std::enable_shared_from_this<Processor>{
   public:
+    enum Scheduler {
+      SCHED_THREAD,
+      SCHED_POOL
+    };
+    static void SetDefaultScheduler(Scheduler sched);
+    static Scheduler GetDefaultScheduler();
+
     static ProcessorSP MakeShared(const std::string& pstype,
 				  std::initializer_list
 				  <std::pair<const std::string, const std::string>> l =  {});
@@ -44,6 +63,7 @@ namespace eudaq {
 
     void ForwardEvent(EventSPC ev);
     void RegisterEvent(EventSPC ev);
+    void RegisterEvents(const std::vector<EventSPC> &evs);
 
     void StopProducer();
     inline bool GetProducerStopFlag() const {return m_pdc_go_stop;};
@@ -66,6 +86,10 @@ namespace eudaq {
     void RegisterProcessing(ProcessorSP ps, EventSPC ev);
     void RegisterDownstream(ProcessorSP ps, const std::set<uint32_t>& evset = {});
     void RegisterUpstream(ProcessorSP up, ProcessorWP hub);
+    void PoolSchedule(std::unique_lock<std::mutex> &lk);
+    void PoolProcessing();
+    void PoolCommit(uint64_t seq, std::vector<EventSPC> &out);
+    void DeliverEvents(const std::vector<EventSPC> &evs);
     
   private:
     std::string m_description;
@@ -94,6 +118,17 @@ namespace eudaq {
     std::atomic_bool m_pdc_go_stop;
     
     std::set<uint32_t> m_ev_out_default;
+
+    bool m_sched_pool;
+    std::atomic_bool m_stateless;
+    std::atomic<uint32_t> m_batch_n;
+    std::deque<EventSPC> m_que_pool;
+    std::mutex m_mtx_pool;   // m_que_pool, m_pool_running, m_seq_take
+    uint32_t m_pool_running;
+    uint64_t m_seq_take;
+    std::mutex m_mtx_commit; // m_seq_commit, m_out_pending
+    uint64_t m_seq_commit;
+    std::map<uint64_t, std::vector<EventSPC>> m_out_pending;
   };
 
   
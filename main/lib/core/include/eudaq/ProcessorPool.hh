@@ -0,0 +1,52 @@
+#ifndef PROCESSORPOOL_HH_
+#define PROCESSORPOOL_HH_
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+#include "Platform.hh"
+
+namespace eudaq {
+  /**
+   * Work-stealing thread pool shared by the processors in pool scheduler
+   * mode. Each worker runs the tasks of its own queue last in first out and
+   * steals the oldest task of another worker when its queue is empty.
+   * The size of the shared pool is EUDAQ_PROC_THREADS, or the number of
+   * hardware threads.
+   */
+  class DLLEXPORT ProcessorPool{
+  public:
+    using Task = std::function<void()>;
+    static ProcessorPool& Instance();
+    explicit ProcessorPool(uint32_t n_thread = 0);
+    ~ProcessorPool();
+    ProcessorPool(const ProcessorPool&) = delete;
+    ProcessorPool& operator=(const ProcessorPool&) = delete;
+    /// Queues t to the calling worker, or round robin from other threads
+    void Submit(Task t);
+    uint32_t GetNumThreads() const {return static_cast<uint32_t>(m_threads.size());}
+  private:
+    struct Worker{
+      std::mutex mtx;
+      std::deque<Task> que;
+    };
+    void Working(uint32_t n);
+    bool PopTask(uint32_t n, Task &t);
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mtx_idle;
+    std::condition_variable m_cv_idle;
+    std::atomic<int64_t> m_n_task; // may dip below zero while a task is stolen before it is counted
+    std::atomic<uint32_t> m_n_next;
+    std::atomic_bool m_exit;
+  };
+}
+
+#endif
@@ -10,6 +10,7 @@
 #include "eudaq/Utils.hh"
 
 #include <string>
+#include <vector>
 
 namespace eudaq {
   class Producer;
@@ -45,6 +46,14 @@ namespace eudaq {
     static ProducerSP Make(const std::string &code_name, const std::string &run_name,
 			   const std::string &runcontrol);
 
+    /// How the events are split over the collectors of EUDAQ_DC
+    enum ShardPolicy {SHARD_NONE, SHARD_ROUNDROBIN, SHARD_TRIGGER, SHARD_TIME};
+    static ShardPolicy ShardPolicyFromName(const std::string &name);
+    /// Tags a numbered event for sharding over n collectors and returns the
+    /// collector it goes to, or n for the BORE and EORE which go to all
+    static size_t ShardRoute(Event &ev, ShardPolicy policy, size_t n,
+			     uint64_t slice, uint64_t &rr);
+
   private:
     void OnInitialise() override final;
     void OnConfigure() override final;
@@ -60,6 +69,11 @@ namespace eudaq {
     uint32_t m_pdc_n;
     std::mutex m_mtx_sender;
     std::map<std::string, std::shared_ptr<DataSender>> m_senders;
+    ShardPolicy m_shard;
+    uint64_t m_shard_slice;
+    uint64_t m_shard_rr;
+    uint32_t m_shard_no_trg; // events without trigger number so far, for SHARD_TRIGGER
+    std::vector<std::shared_ptr<DataSender>> m_shards;
   };
   //----------DOC-MARK-----ENDDECLEAR-----DOC-MARK----------
 }
@@ -12,6 +12,8 @@
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 namespace eudaq {
 
@@ -56,6 +58,9 @@ namespace eudaq {
     StatusSPC GetConnectionStatus(ConnectionSPC con);
     std::vector<ConnectionSPC> GetActiveConnections();
     std::map<ConnectionSPC, StatusSPC> GetActiveConnectionStatusMap();
+    using StatusView = std::shared_ptr<const std::map<ConnectionSPC, StatusSPC>>;
+    /// Merged status of all connections, a snapshot which is read without locking
+    StatusView GetStatusView() const;
     
     //thread control
     void StartRunControl(); 
@@ -78,6 +83,19 @@ namespace eudaq {
     void CommandHandler(TransportEvent &ev);
     void CommandThread();
     void StatusThread();
+    /// Publishes m_conn_status to the readers, m_mtx_conn is held
+    void PublishStatusView();
+    /// Sends cmd to all conns at once, a change of state or reaching the target state completes the transition
+    void SendTransition(const std::string &cmd, const std::string &param,
+			const std::vector<ConnectionSPC> &conns);
+    /// Waits until the transitions of all conns are complete, false on timeout
+    bool WaitTransition(const std::vector<ConnectionSPC> &conns);
+    struct Transition {
+      std::string cmd;
+      int state_from;
+      int state_to;
+      std::chrono::steady_clock::time_point tp_sent;
+    };
   private:
     bool m_exit;
     bool m_listening;
@@ -87,7 +105,10 @@ namespace eudaq {
     std::shared_ptr<Configuration> m_conf;
     std::shared_ptr<Configuration> m_conf_init;
     std::map<ConnectionSPC, StatusSPC> m_conn_status;
+    StatusView m_conn_status_view;
+    std::map<ConnectionSPC, Transition> m_conn_pending;
     std::mutex m_mtx_conn;
+    std::condition_variable m_cv_conn;
 
     std::string m_addr_log;
     std::mutex m_mtx_sendcmd;
@@ -60,6 +60,8 @@ namespace eudaq {
       PushPixelHelper(x, y, (double)pix, 0, false, frame);
     }
 
+    /// Reserves space for npix pushed pixels in a frame
+    void ReservePixels(uint32_t npix, uint32_t frame = 0);
     void SetPixelHelper(uint32_t index, uint32_t x, uint32_t y, double pix, uint64_t time_ps,
                         bool pivot, uint32_t frame);
     void PushPixelHelper(uint32_t x, uint32_t y, double pix, uint64_t time_ps, bool pivot,
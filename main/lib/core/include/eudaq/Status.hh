@@ -7,7 +7,9 @@
 
 #include <string>
 #include <map>
+#include <set>
 #include <ostream>
+#include <cstdint>
 
 namespace eudaq{
   class Serializer;
@@ -47,7 +49,10 @@ namespace eudaq{
     virtual void Print(std::ostream &os, size_t offset = 0) const;
     void ResetStatus(State st, Level lvl, const std::string &msg);
     void SetMessage(const std::string &msg);
-    void SetTag(const std::string &key, const std::string &val);
+    /// Returns true if the tag is new or its value changed
+    bool SetTag(const std::string &key, const std::string &val);
+    /// Sets a numeric tag, it is carried as an integer by the delta updates
+    bool SetCounter(const std::string &key, int64_t val);
     int GetLevel() const;
     int GetState() const;
     std::string GetMessage() const;
@@ -58,11 +63,21 @@ namespace eudaq{
     static std::string Level2String(int lvl);
     static int String2Level(const std::string &str);
     static std::string State2String(int state);
+
+    /**
+     * Writes an update with level, state, message and only the tags in keys,
+     * or all tags if keys is null. Update() applies it to the last status.
+     */
+    void SerializeDelta(Serializer &ser, const std::set<std::string> *keys) const;
+    /// Applies a full status (as Serialize writes it) or a delta update
+    void Update(Deserializer &ds);
+    static constexpr uint32_t DELTA_MARK = 0xD17A5747; // never a valid level
   private:
     int m_level;
     int m_state;
     std::string m_msg;
     std::map<std::string, std::string> m_tags;
+    std::map<std::string, int64_t> m_counters;
     static std::map<uint32_t, std::string> m_map_state_str;
     static std::map<uint32_t, std::string> m_map_level_str;
   };
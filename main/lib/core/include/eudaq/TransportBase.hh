@@ -13,6 +13,7 @@
 #include <cstring>
 #include <iostream>
 #include <mutex>
+#include <utility>
 
 namespace eudaq {
 
@@ -65,7 +66,12 @@ namespace eudaq {
     enum EventType { CONNECT, DISCONNECT, RECEIVE };
     TransportEvent(EventType et, ConnectionSP i, const std::string &p = "")
         : etype(et), id(i), packet(p) {}
-    TransportEvent & operator = (const TransportEvent& rh){etype = rh.etype; id=rh.id;  packet = rh.packet; return *this;};
+    TransportEvent(EventType et, ConnectionSP i, std::string &&p)
+        : etype(et), id(i), packet(std::move(p)) {}
+    TransportEvent(const TransportEvent &) = default;
+    TransportEvent(TransportEvent &&) = default;
+    TransportEvent & operator = (const TransportEvent &) = default;
+    TransportEvent & operator = (TransportEvent &&) = default;
     EventType etype; ///< The type of event
     ConnectionSP id; ///< The id of the connection
     std::string packet; ///< The packet of data in case of a RECEIVE event
@@ -0,0 +1,92 @@
+#ifndef EUDAQ_INCLUDED_TransportSHM
+#define EUDAQ_INCLUDED_TransportSHM
+
+#include "eudaq/TransportServer.hh"
+#include "eudaq/TransportClient.hh"
+#include "eudaq/Platform.hh"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+
+/** \file TransportSHM.hh
+ * Shared memory transport for processes on the same host, selected with
+ * shm://name. The server creates the segment /eudaq.name with a table of
+ * connection slots; each client creates its own segment with a ring buffer
+ * per direction, announces it in a free slot and writes its packets into
+ * the ring, prefixed by their length as with tcp://. The reader waits on a
+ * futex (Linux) which the writer only wakes if the reader is sleeping.
+ * The client ring size is EUDAQ_SHM_RING_MB (default 16) MiB.
+ */
+
+namespace eudaq {
+  class ShmSegment;
+  class ShmRing;
+  struct ShmControl;
+
+  class ConnectionInfoSHM : public ConnectionInfo {
+  public:
+    ConnectionInfoSHM() = delete;
+    ConnectionInfoSHM(const ConnectionInfoSHM&) = delete;
+    ConnectionInfoSHM& operator = (const ConnectionInfoSHM&) = delete;
+    ConnectionInfoSHM(uint32_t slot, uint32_t gen, const std::string &remote)
+      : ConnectionInfo(""), m_slot(slot), m_gen(gen), m_remote(remote) {}
+    bool Matches(const ConnectionInfo &other) const override;
+    void Print(std::ostream &, size_t) const override;
+    std::string GetRemote() const override { return m_remote; }
+    uint32_t GetSlot() const { return m_slot; }
+
+  private:
+    uint32_t m_slot;
+    uint32_t m_gen;
+    std::string m_remote;
+  };
+
+  class SHMServer : public TransportServer {
+  public:
+    SHMServer(const std::string &param);
+    ~SHMServer() override;
+    void Close(const ConnectionInfo &id) override;
+    void SendPacket(const unsigned char *data, size_t len,
+		    const ConnectionInfo &id = ConnectionInfo::ALL,
+		    bool duringconnect = false) override;
+    void ProcessEvents(int timeout) override;
+    std::string ConnectionString() const override;
+    std::vector<ConnectionSPC> GetConnections() const override;
+    static const std::string name;
+  private:
+    struct Conn;
+    bool Poll(bool check_alive);
+    void CloseConn(size_t slot);
+    std::string m_name;
+    std::unique_ptr<ShmSegment> m_ctl_seg;
+    ShmControl *m_ctl;
+    std::vector<std::shared_ptr<Conn>> m_conn;
+    mutable std::mutex m_mtx_conn;
+  };
+
+  class SHMClient : public TransportClient {
+  public:
+    SHMClient(const std::string &param);
+    ~SHMClient() override;
+    void SendPacket(const unsigned char *data, size_t len,
+		    const ConnectionInfo &id = ConnectionInfo::ALL,
+		    bool = false) override;
+    void ProcessEvents(int timeout = -1) override;
+    static const std::string name;
+  private:
+    bool ServerAlive() const;
+    std::string m_name;
+    std::unique_ptr<ShmSegment> m_ctl_seg;
+    ShmControl *m_ctl;
+    std::unique_ptr<ShmSegment> m_seg;
+    std::unique_ptr<ShmRing> m_send;
+    std::unique_ptr<ShmRing> m_recv;
+    uint32_t m_slot;
+    std::mutex m_mtx_send;
+    std::shared_ptr<ConnectionInfoSHM> m_info;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_TransportSHM
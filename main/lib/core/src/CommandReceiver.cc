@@ -4,6 +4,7 @@
 #include "eudaq/Exception.hh"
 #include "eudaq/Logger.hh"
 #include "eudaq/Utils.hh"
+#include "eudaq/Metrics.hh"
 #include "eudaq/CommandReceiver.hh"
 #include <iostream>
 #include <ostream>
@@ -20,7 +21,9 @@ namespace eudaq {
   
   CommandReceiver::CommandReceiver(const std::string & type, const std::string & name,
 				   const std::string & runcontrol)
-    : m_type(type), m_name(name), m_is_destructing(false), m_is_connected(false), m_is_runlooping(false), m_addr_runctrl(runcontrol){
+    : m_type(type), m_name(name), m_is_destructing(false), m_is_connected(false), m_is_runlooping(false), m_addr_runctrl(runcontrol),
+      m_status_full(true), m_status_pending(false), m_status_sent_state(-1), m_status_sent_level(-1),
+      m_status_interval(500){
   }
 
   CommandReceiver::~CommandReceiver(){
@@ -47,12 +50,30 @@ namespace eudaq {
   }
 
   void CommandReceiver::SendStatus(){
-    BufferSerializer ser;
+    PublishStatus(false);
+  }
+
+  void CommandReceiver::PublishStatus(bool force){
+    std::unique_lock<std::mutex> lk_send(m_mtx_send);
     std::unique_lock<std::mutex> lk_st(m_mtx_status);
-    m_status.Serialize(ser);
+    auto now = std::chrono::steady_clock::now();
+    if(!force && !m_status_full && m_status.GetState() == m_status_sent_state
+       && m_status.GetLevel() == m_status_sent_level && now - m_tp_status_sent < m_status_interval){
+      // AsyncForwarding sends it once the interval is over
+      m_status_pending = true;
+      return;
+    }
+    m_status_buf.clear();
+    m_status.SerializeDelta(m_status_buf, m_status_full ? nullptr : &m_status_dirty);
+    m_status_dirty.clear();
+    m_status_full = false;
+    m_status_pending = false;
+    m_status_sent_state = m_status.GetState();
+    m_status_sent_level = m_status.GetLevel();
+    m_tp_status_sent = now;
     lk_st.unlock();
     if(m_cmdclient)
-      m_cmdclient->SendPacket(ser);
+      m_cmdclient->SendPacket(m_status_buf);
   }
   
   void CommandReceiver::SetStatus(Status::State state,
@@ -74,7 +95,21 @@ namespace eudaq {
   
   void CommandReceiver::SetStatusTag(const std::string &key, const std::string &val){
     std::unique_lock<std::mutex> lk(m_mtx_status);
-    m_status.SetTag(key, val);
+    if(m_status.SetTag(key, val))
+      m_status_dirty.insert(key);
+  }
+
+  void CommandReceiver::SetStatusCounter(const std::string &key, int64_t val){
+    std::unique_lock<std::mutex> lk(m_mtx_status);
+    if(m_status.SetCounter(key, val))
+      m_status_dirty.insert(key);
+  }
+
+  void CommandReceiver::SetStatusTags(const std::map<std::string, std::string> &tags){
+    std::unique_lock<std::mutex> lk(m_mtx_status);
+    for(auto &tag: tags)
+      if(m_status.SetTag(tag.first, tag.second))
+	m_status_dirty.insert(tag.first);
   }
 
   bool CommandReceiver::IsStatus(Status::State state){
@@ -93,6 +128,19 @@ namespace eudaq {
     // if(!log_addr.empty())
     //   EUDAQ_LOG_CONNECT(m_type, m_name, log_addr);
     // GetInitConfiguration()->SetSection(cur_backup);
+    if(m_conf_init){
+      EUDAQ_LOG_ASYNC(m_conf_init->Get("EUDAQ_LOG_ASYNC", 0) != 0,
+		      m_conf_init->Get("EUDAQ_LOG_QUEUE_SIZE", 10000));
+      GetLogger().SetRepeatWindow(m_conf_init->Get("EUDAQ_LOG_REPEAT_WINDOW_MS", 0));
+      if(m_conf_init->Has("EUDAQ_LOG_LEVEL"))
+	GetLogger().SetLevel(m_conf_init->Get("EUDAQ_LOG_LEVEL", "DEBUG"));
+      if(m_conf_init->Has("EUDAQ_LOG_SEND_LEVEL"))
+	GetLogger().SetSendLevel(m_conf_init->Get("EUDAQ_LOG_SEND_LEVEL", "DEBUG"));
+      Metrics::Instance().SetEnabled(m_conf_init->Get("EUDAQ_METRICS", 0) != 0);
+      m_metrics_file = m_conf_init->Get("EUDAQ_METRICS_FILE", "");
+      std::unique_lock<std::mutex> lk(m_mtx_status);
+      m_status_interval = std::chrono::milliseconds(m_conf_init->Get("EUDAQ_STATUS_INTERVAL_MS", 500));
+    }
     SetStatus(Status::STATE_UNCONF, "Initialized");
     EUDAQ_INFO(GetFullName() + " is initialised.");
   }
@@ -161,6 +209,26 @@ namespace eudaq {
 
   }
   
+  void CommandReceiver::PublishMetrics(){
+    auto &metrics = Metrics::Instance();
+    if(!metrics.IsEnabled())
+      return;
+    auto counters = metrics.StatusCounters();
+    std::unique_lock<std::mutex> lk(m_mtx_status);
+    for(auto &c: counters)
+      if(m_status.SetCounter(c.first, c.second))
+	m_status_dirty.insert(c.first);
+    lk.unlock();
+    SetStatusTags(metrics.StatusTags());
+    if(!m_metrics_file.empty()){
+      try{
+	metrics.WritePrometheus(m_metrics_file, GetFullName());
+      }catch(const Exception &e){
+	EUDAQ_WARN_LAZY(e.what());
+      }
+    }
+  }
+
   void CommandReceiver::OnUnrecognised(const std::string & /*cmd*/, const std::string & /*param*/){
 
   }
@@ -259,11 +327,16 @@ namespace eudaq {
     while(m_is_connected){
       std::unique_lock<std::mutex> lk(m_mx_qu_cmd);
       while(m_qu_cmd.empty()){
-	while(m_cv_not_empty.wait_for(lk, std::chrono::seconds(1))
-	      ==std::cv_status::timeout){
+	if(m_cv_not_empty.wait_for(lk, std::chrono::milliseconds(100))
+	   ==std::cv_status::timeout){
 	  if(!m_is_connected){
 	    return 0;
 	  }
+	  if(m_status_pending){
+	    lk.unlock();
+	    PublishStatus(false);
+	    lk.lock();
+	  }
 	}
       }
       auto cmd = m_qu_cmd.front().first;
@@ -300,12 +373,14 @@ namespace eudaq {
         OnReset();
       } else if (cmd == "STATUS") {
         OnStatus();
+	PublishMetrics();
       } else if (cmd == "LOG") {
         OnLog(param);
       } else {
         OnUnrecognised(cmd, param);
       }
-      SendStatus();
+      // the reply to a command other than the polling is never held back
+      PublishStatus(cmd != "STATUS");
     }
     return 0;
   }
@@ -332,6 +407,11 @@ namespace eudaq {
       return m_addr_client;
     }
 
+    {
+      // a new connection starts from an empty status at RunControl
+      std::unique_lock<std::mutex> lk(m_mtx_status);
+      m_status_full = true;
+    }
     auto tp_start_connect = std::chrono::steady_clock::now();
     std::string packet_0_in;
     std::string packet_1_out = "OK EUDAQ CMD " + m_type + " " + m_name;
@@ -0,0 +1,134 @@
+#include "eudaq/FileReader.hh"
+#include "eudaq/BufferSerializer.hh"
+#include "eudaq/Compression.hh"
+#include "eudaq/Logger.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <algorithm>
+
+// Reads the chunked files of CompressedFileWriter. The compressed chunks
+// are read ahead and up to RAWZ_THREADS of them are decompressed in
+// parallel while the events of the current one are deserialized. A chunk
+// cut short at the end of the file (writer not closed) ends the reading.
+// With RAWZ_EVENT_BEGIN/RAWZ_EVENT_END the chunks without any event number
+// in [begin, end) are skipped through their index, without decompressing.
+class CompressedFileReader : public eudaq::FileReader {
+public:
+  CompressedFileReader(const std::string &filename);
+  ~CompressedFileReader() override;
+  eudaq::EventSPC GetNextEvent() override;
+private:
+  struct Chunk {
+    uint32_t n_event;
+    std::unique_ptr<eudaq::BufferSerializer> data;
+  };
+  void Open();
+  bool ReadAhead();
+
+  std::string m_filename;
+  std::FILE *m_file;
+  size_t m_threads;
+  std::deque<std::future<Chunk>> m_pending;
+  Chunk m_chunk;
+  uint32_t m_ev;
+  uint32_t m_ev_begin;
+  uint32_t m_ev_end;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::FileReader>::
+    Register<CompressedFileReader, std::string&>(eudaq::cstr2hash("rawz"));
+  auto dummy1 = eudaq::Factory<eudaq::FileReader>::
+    Register<CompressedFileReader, std::string&&>(eudaq::cstr2hash("rawz"));
+}
+
+CompressedFileReader::CompressedFileReader(const std::string &filename)
+  :m_filename(filename), m_file(nullptr), m_threads(2), m_ev(0), m_ev_begin(0), m_ev_end(UINT32_MAX){
+  m_chunk.n_event = 0;
+}
+
+CompressedFileReader::~CompressedFileReader(){
+  for(auto &f: m_pending)
+    if(f.valid())
+      f.wait();
+  if(m_file)
+    std::fclose(m_file);
+}
+
+void CompressedFileReader::Open(){
+  m_file = std::fopen(m_filename.c_str(), "rb");
+  if(!m_file)
+    EUDAQ_THROWX(eudaq::FileNotFoundException, "Unable to open file: " + m_filename);
+  char magic[8];
+  uint32_t head[2];
+  if(std::fread(magic, 1, 8, m_file) != 8 || std::memcmp(magic, "EUDAQRWZ", 8) ||
+     std::fread(head, 1, 8, m_file) != 8)
+    EUDAQ_THROW("CompressedFileReader: not a compressed native file " + m_filename);
+  if(head[0] != 1)
+    EUDAQ_THROW("CompressedFileReader: unsupported version " + std::to_string(head[0]));
+  auto conf = GetConfiguration();
+  if(conf){
+    m_threads = std::max(1, conf->Get("RAWZ_THREADS", 2));
+    m_ev_begin = conf->Get("RAWZ_EVENT_BEGIN", 0);
+    m_ev_end = conf->Get("RAWZ_EVENT_END", UINT32_MAX);
+  }
+}
+
+bool CompressedFileReader::ReadAhead(){
+  uint8_t head[8];
+  uint32_t n_event;
+  uint64_t len[2];
+  std::vector<uint32_t> index;
+  while(true){
+    if(std::fread(head, 1, 8, m_file) != 8 || std::memcmp(head, "ZCHK", 4) ||
+       std::fread(&n_event, 1, 4, m_file) != 4 || std::fread(len, 1, sizeof(len), m_file) != sizeof(len))
+      return false;
+    index.resize(n_event * 2);
+    if(std::fread(index.data(), 8, n_event, m_file) != n_event)
+      return false;
+    bool wanted = false;
+    for(uint32_t i = 0; i < n_event && !wanted; i++)
+      wanted = index[i * 2] >= m_ev_begin && index[i * 2] < m_ev_end;
+    if(wanted)
+      break;
+    if(std::fseek(m_file, static_cast<long>(len[1]), SEEK_CUR))
+      return false;
+  }
+  auto comp = std::make_shared<std::vector<uint8_t>>(len[1]);
+  if(std::fread(comp->data(), 1, comp->size(), m_file) != comp->size()){
+    EUDAQ_WARN("CompressedFileReader: incomplete chunk at the end of " + m_filename);
+    return false;
+  }
+  eudaq::Codec codec = static_cast<eudaq::Codec>(head[4]);
+  uint64_t raw_len = len[0];
+  m_pending.push_back(std::async(std::launch::async, [comp, codec, raw_len, n_event](){
+	std::vector<uint8_t> raw;
+	eudaq::Decompress(codec, comp->data(), comp->size(), raw_len, raw);
+	Chunk chunk;
+	chunk.n_event = n_event;
+	chunk.data.reset(new eudaq::BufferSerializer(raw.begin(), raw.end()));
+	return chunk;
+      }));
+  return true;
+}
+
+eudaq::EventSPC CompressedFileReader::GetNextEvent(){
+  if(!m_file)
+    Open();
+  while(m_ev == m_chunk.n_event){
+    while(m_pending.size() < m_threads && ReadAhead());
+    if(m_pending.empty())
+      return nullptr;
+    m_chunk = m_pending.front().get();
+    m_pending.pop_front();
+    m_ev = 0;
+  }
+  m_ev++;
+  uint32_t id;
+  m_chunk.data->PreRead(id);
+  return eudaq::Factory<eudaq::Event>::Create<eudaq::Deserializer&>(id, *m_chunk.data);
+}
@@ -0,0 +1,178 @@
+#include "eudaq/FileNamer.hh"
+#include "eudaq/FileWriter.hh"
+#include "eudaq/Serializer.hh"
+#include "eudaq/Compression.hh"
+#include "eudaq/Logger.hh"
+
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <future>
+#include <algorithm>
+#include <cstring>
+
+// Native events in independently compressed chunks, read by the FileReader
+// "rawz". All numbers are little endian.
+//
+//   header: "EUDAQRWZ", u32 version, u32 0
+//   chunk:  "ZCHK", u8 codec (see Compression.hh), u8[3] 0, u32 n_event,
+//           u64 raw length, u64 compressed length, per event u32 event_n
+//           and u32 offset in the raw chunk, then the compressed data
+//
+// The raw chunk is the concatenation of the events as NativeFileWriter
+// stores them. Chunks hold RAWZ_CHUNK_EVENTS events (or RAWZ_CHUNK_MB of
+// data) and are compressed with RAWZ_CODEC at RAWZ_LEVEL by up to
+// RAWZ_THREADS chunks in parallel; they are written in order.
+class CompressedFileWriter : public eudaq::FileWriter {
+public:
+  CompressedFileWriter(const std::string &patt);
+  ~CompressedFileWriter() override;
+  void WriteEvent(eudaq::EventSPC ev) override;
+  uint64_t FileBytes() const override;
+private:
+  class Chunk : public eudaq::Serializer {
+  public:
+    std::vector<uint32_t> index;
+    std::vector<uint8_t> data;
+  private:
+    void Serialize(const uint8_t *p, size_t len) override {data.insert(data.end(), p, p + len);}
+  };
+  void Open(uint32_t run_n);
+  void Close();
+  void Flush();
+  void WriteFront();
+  static std::vector<uint8_t> Encode(eudaq::Codec codec, int level, const Chunk &chunk);
+
+  std::string m_filepattern;
+  uint32_t m_run_n;
+  std::FILE *m_file;
+  uint64_t m_bytes;
+  eudaq::Codec m_codec;
+  int m_level;
+  uint32_t m_chunk_events;
+  size_t m_chunk_bytes;
+  size_t m_threads;
+  std::unique_ptr<Chunk> m_chunk;
+  std::deque<std::future<std::vector<uint8_t>>> m_pending;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::FileWriter>::
+    Register<CompressedFileWriter, std::string&>(eudaq::cstr2hash("rawz"));
+  auto dummy1 = eudaq::Factory<eudaq::FileWriter>::
+    Register<CompressedFileWriter, std::string&&>(eudaq::cstr2hash("rawz"));
+}
+
+CompressedFileWriter::CompressedFileWriter(const std::string &patt)
+  :m_filepattern(patt), m_run_n(0), m_file(nullptr), m_bytes(0),
+   m_codec(eudaq::DefaultCodec()), m_level(0), m_chunk_events(1000),
+   m_chunk_bytes(16<<20), m_threads(2){
+}
+
+CompressedFileWriter::~CompressedFileWriter(){
+  try{
+    Close();
+  }catch(const std::exception &e){
+    EUDAQ_ERROR(std::string("CompressedFileWriter: ") + e.what());
+  }
+}
+
+void CompressedFileWriter::Open(uint32_t run_n){
+  Close();
+  auto conf = GetConfiguration();
+  if(conf){
+    std::string codec = conf->Get("RAWZ_CODEC", "");
+    if(!codec.empty())
+      m_codec = eudaq::CodecFromName(codec);
+    m_level = conf->Get("RAWZ_LEVEL", 0);
+    m_chunk_events = std::max(1, conf->Get("RAWZ_CHUNK_EVENTS", 1000));
+    m_chunk_bytes = static_cast<size_t>(std::max(1, conf->Get("RAWZ_CHUNK_MB", 16))) << 20;
+    m_threads = std::max(1, conf->Get("RAWZ_THREADS", 2));
+  }
+  std::time_t time_now = std::time(nullptr);
+  char time_buff[13];
+  time_buff[12] = 0;
+  std::strftime(time_buff, sizeof(time_buff), "%y%m%d%H%M%S", std::localtime(&time_now));
+  std::string time_str(time_buff);
+  std::string path = eudaq::FileNamer(m_filepattern).Set('X', ".rawz").Set('R', run_n).Set('D', time_str);
+  m_file = std::fopen(path.c_str(), "wb");
+  if(!m_file)
+    EUDAQ_THROW("CompressedFileWriter: unable to open " + path);
+  m_run_n = run_n;
+  m_bytes = 0;
+  uint32_t head[2] = {1, 0};
+  if(std::fwrite("EUDAQRWZ", 1, 8, m_file) != 8 || std::fwrite(head, 1, 8, m_file) != 8)
+    EUDAQ_THROW("CompressedFileWriter: fail to write to " + path);
+  m_bytes = 16;
+}
+
+void CompressedFileWriter::Close(){
+  if(!m_file)
+    return;
+  Flush();
+  while(!m_pending.empty())
+    WriteFront();
+  std::fclose(m_file);
+  m_file = nullptr;
+}
+
+std::vector<uint8_t> CompressedFileWriter::Encode(eudaq::Codec codec, int level, const Chunk &chunk){
+  std::vector<uint8_t> comp;
+  eudaq::Compress(codec, level, chunk.data.data(), chunk.data.size(), comp);
+
+  uint32_t n_event = static_cast<uint32_t>(chunk.index.size() / 2);
+  uint64_t len[2] = {chunk.data.size(), comp.size()};
+  uint8_t head[8] = {'Z', 'C', 'H', 'K', static_cast<uint8_t>(codec), 0, 0, 0};
+  std::vector<uint8_t> frame(sizeof(head) + 4 + sizeof(len) + chunk.index.size() * 4 + comp.size());
+  uint8_t *p = frame.data();
+  std::memcpy(p, head, sizeof(head));
+  p += sizeof(head);
+  std::memcpy(p, &n_event, 4);
+  p += 4;
+  std::memcpy(p, len, sizeof(len));
+  p += sizeof(len);
+  std::memcpy(p, chunk.index.data(), chunk.index.size() * 4);
+  p += chunk.index.size() * 4;
+  std::memcpy(p, comp.data(), comp.size());
+  return frame;
+}
+
+void CompressedFileWriter::WriteFront(){
+  std::vector<uint8_t> frame = m_pending.front().get();
+  m_pending.pop_front();
+  if(std::fwrite(frame.data(), 1, frame.size(), m_file) != frame.size())
+    EUDAQ_THROW("CompressedFileWriter: fail to write to the file");
+  std::fflush(m_file);
+  m_bytes += frame.size();
+}
+
+void CompressedFileWriter::Flush(){
+  if(!m_chunk)
+    return;
+  std::shared_ptr<Chunk> chunk(m_chunk.release());
+  eudaq::Codec codec = m_codec;
+  int level = m_level;
+  m_pending.push_back(std::async(std::launch::async, [chunk, codec, level](){
+	return Encode(codec, level, *chunk);
+      }));
+  // keep at most m_threads chunks in flight, the oldest is written first
+  while(m_pending.size() > m_threads)
+    WriteFront();
+}
+
+void CompressedFileWriter::WriteEvent(eudaq::EventSPC ev){
+  uint32_t run_n = ev->GetRunN();
+  if(!m_file || m_run_n != run_n)
+    Open(run_n);
+  if(!m_chunk)
+    m_chunk.reset(new Chunk);
+  m_chunk->index.push_back(ev->GetEventN());
+  m_chunk->index.push_back(static_cast<uint32_t>(m_chunk->data.size()));
+  m_chunk->write(*ev);
+  if(m_chunk->index.size() / 2 >= m_chunk_events || m_chunk->data.size() >= m_chunk_bytes)
+    Flush();
+}
+
+uint64_t CompressedFileWriter::FileBytes() const{
+  return m_bytes;
+}
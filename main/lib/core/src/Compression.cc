@@ -0,0 +1,400 @@
+#include "eudaq/Compression.hh"
+#include "eudaq/Exception.hh"
+
+#include <cstring>
+
+#ifdef EUDAQ_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef EUDAQ_HAVE_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace eudaq {
+
+  bool CodecAvailable(Codec c){
+    switch(c){
+    case Codec::NONE:
+      return true;
+#ifdef EUDAQ_HAVE_ZLIB
+    case Codec::ZLIB:
+      return true;
+#endif
+#ifdef EUDAQ_HAVE_LZ4
+    case Codec::LZ4:
+      return true;
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+    case Codec::ZSTD:
+      return true;
+#endif
+    default:
+      return false;
+    }
+  }
+
+  std::string CodecName(Codec c){
+    switch(c){
+    case Codec::NONE: return "none";
+    case Codec::ZLIB: return "zlib";
+    case Codec::LZ4: return "lz4";
+    case Codec::ZSTD: return "zstd";
+    }
+    return "codec" + std::to_string(static_cast<int>(c));
+  }
+
+  Codec CodecFromName(const std::string &name){
+    for(auto c: {Codec::NONE, Codec::ZLIB, Codec::LZ4, Codec::ZSTD}){
+      if(CodecName(c) != name)
+	continue;
+      if(!CodecAvailable(c))
+	EUDAQ_THROW("Compression: codec " + name + " is not available in this build");
+      return c;
+    }
+    EUDAQ_THROW("Compression: unknown codec " + name);
+  }
+
+  Codec DefaultCodec(){
+    for(auto c: {Codec::ZSTD, Codec::LZ4, Codec::ZLIB})
+      if(CodecAvailable(c))
+	return c;
+    return Codec::NONE;
+  }
+
+  void Compress(Codec c, int level, const uint8_t *src, size_t len,
+		std::vector<uint8_t> &dst){
+    switch(c){
+    case Codec::NONE:
+      dst.assign(src, src + len);
+      return;
+#ifdef EUDAQ_HAVE_ZLIB
+    case Codec::ZLIB:{
+      uLongf n = compressBound(len);
+      dst.resize(n);
+      if(compress2(dst.data(), &n, src, len, level ? level : 1) != Z_OK)
+	EUDAQ_THROW("Compression: zlib failed");
+      dst.resize(n);
+      return;
+    }
+#endif
+#ifdef EUDAQ_HAVE_LZ4
+    case Codec::LZ4:{
+      dst.resize(LZ4_compressBound(static_cast<int>(len)));
+      int n = level > 1 ?
+	LZ4_compress_HC(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst.data()),
+			static_cast<int>(len), static_cast<int>(dst.size()), level) :
+	LZ4_compress_default(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst.data()),
+			     static_cast<int>(len), static_cast<int>(dst.size()));
+      if(n <= 0)
+	EUDAQ_THROW("Compression: lz4 failed");
+      dst.resize(n);
+      return;
+    }
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+    case Codec::ZSTD:{
+      dst.resize(ZSTD_compressBound(len));
+      size_t n = ZSTD_compress(dst.data(), dst.size(), src, len, level ? level : 1);
+      if(ZSTD_isError(n))
+	EUDAQ_THROW(std::string("Compression: zstd failed, ") + ZSTD_getErrorName(n));
+      dst.resize(n);
+      return;
+    }
+#endif
+    default:
+      EUDAQ_THROW("Compression: codec " + CodecName(c) + " is not available in this build");
+    }
+  }
+
+  void Decompress(Codec c, const uint8_t *src, size_t len, size_t raw_len,
+		  std::vector<uint8_t> &dst){
+    dst.resize(raw_len);
+    switch(c){
+    case Codec::NONE:
+      if(len != raw_len)
+	EUDAQ_THROW("Compression: size mismatch of uncompressed block");
+      if(len)
+	std::memcpy(dst.data(), src, len);
+      return;
+#ifdef EUDAQ_HAVE_ZLIB
+    case Codec::ZLIB:{
+      uLongf n = raw_len;
+      if(uncompress(dst.data(), &n, src, len) != Z_OK || n != raw_len)
+	EUDAQ_THROW("Compression: corrupted zlib block");
+      return;
+    }
+#endif
+#ifdef EUDAQ_HAVE_LZ4
+    case Codec::LZ4:{
+      int n = LZ4_decompress_safe(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst.data()),
+				  static_cast<int>(len), static_cast<int>(raw_len));
+      if(n < 0 || static_cast<size_t>(n) != raw_len)
+	EUDAQ_THROW("Compression: corrupted lz4 block");
+      return;
+    }
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+    case Codec::ZSTD:{
+      size_t n = ZSTD_decompress(dst.data(), raw_len, src, len);
+      if(ZSTD_isError(n) || n != raw_len)
+	EUDAQ_THROW("Compression: corrupted zstd block");
+      return;
+    }
+#endif
+    default:
+      EUDAQ_THROW("Compression: codec " + CodecName(c) + " is not available in this build");
+    }
+  }
+
+  namespace{
+    // history kept by the lz4 streams, the maximum lz4 can refer to
+    const size_t LZ4_HISTORY = 64 * 1024;
+  }
+
+  struct StreamCompressor::State {
+#ifdef EUDAQ_HAVE_ZLIB
+    z_stream zs;
+#endif
+#ifdef EUDAQ_HAVE_LZ4
+    LZ4_stream_t *lz4;
+    std::vector<char> dict;
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+    ZSTD_CCtx *zstd;
+#endif
+  };
+
+  StreamCompressor::StreamCompressor(Codec c, int level)
+    :m_codec(c), m_state(new State){
+    switch(c){
+    case Codec::NONE:
+      return;
+#ifdef EUDAQ_HAVE_ZLIB
+    case Codec::ZLIB:
+      std::memset(&m_state->zs, 0, sizeof(z_stream));
+      if(deflateInit(&m_state->zs, level ? level : 1) != Z_OK)
+	EUDAQ_THROW("Compression: unable to initialise zlib stream");
+      return;
+#endif
+#ifdef EUDAQ_HAVE_LZ4
+    case Codec::LZ4:
+      m_state->lz4 = LZ4_createStream();
+      m_state->dict.resize(LZ4_HISTORY);
+      return;
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+    case Codec::ZSTD:
+      m_state->zstd = ZSTD_createCCtx();
+      ZSTD_CCtx_setParameter(m_state->zstd, ZSTD_c_compressionLevel, level ? level : 1);
+      return;
+#endif
+    default:
+      EUDAQ_THROW("Compression: codec " + CodecName(c) + " is not available in this build");
+    }
+  }
+
+  StreamCompressor::~StreamCompressor(){
+    switch(m_codec){
+#ifdef EUDAQ_HAVE_ZLIB
+    case Codec::ZLIB:
+      deflateEnd(&m_state->zs);
+      break;
+#endif
+#ifdef EUDAQ_HAVE_LZ4
+    case Codec::LZ4:
+      LZ4_freeStream(m_state->lz4);
+      break;
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+    case Codec::ZSTD:
+      ZSTD_freeCCtx(m_state->zstd);
+      break;
+#endif
+    default:
+      break;
+    }
+  }
+
+  void StreamCompressor::Compress(const uint8_t *src, size_t len, std::vector<uint8_t> &dst){
+    switch(m_codec){
+    case Codec::NONE:
+      dst.assign(src, src + len);
+      return;
+#ifdef EUDAQ_HAVE_ZLIB
+    case Codec::ZLIB:{
+      // a sync flush ends every block on a byte boundary without resetting the history
+      z_stream &zs = m_state->zs;
+      zs.next_in = const_cast<Bytef*>(src);
+      zs.avail_in = static_cast<uInt>(len);
+      dst.resize(deflateBound(&zs, len) + 16);
+      size_t out = 0;
+      do{
+	if(out == dst.size())
+	  dst.resize(dst.size() * 2);
+	zs.next_out = dst.data() + out;
+	zs.avail_out = static_cast<uInt>(dst.size() - out);
+	if(deflate(&zs, Z_SYNC_FLUSH) == Z_STREAM_ERROR)
+	  EUDAQ_THROW("Compression: zlib stream failed");
+	out = dst.size() - zs.avail_out;
+      }while(zs.avail_out == 0);
+      dst.resize(out);
+      return;
+    }
+#endif
+#ifdef EUDAQ_HAVE_LZ4
+    case Codec::LZ4:{
+      dst.resize(LZ4_compressBound(static_cast<int>(len)));
+      int n = LZ4_compress_fast_continue(m_state->lz4, reinterpret_cast<const char*>(src),
+					 reinterpret_cast<char*>(dst.data()),
+					 static_cast<int>(len), static_cast<int>(dst.size()), 1);
+      if(n <= 0)
+	EUDAQ_THROW("Compression: lz4 stream failed");
+      dst.resize(n);
+      // src is gone after this call, keep the history in our own buffer
+      LZ4_saveDict(m_state->lz4, m_state->dict.data(), static_cast<int>(m_state->dict.size()));
+      return;
+    }
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+    case Codec::ZSTD:{
+      ZSTD_inBuffer in = {src, len, 0};
+      dst.resize(ZSTD_compressBound(len) + 16);
+      size_t out = 0;
+      size_t rem;
+      do{
+	if(out == dst.size())
+	  dst.resize(dst.size() * 2);
+	ZSTD_outBuffer ob = {dst.data(), dst.size(), out};
+	rem = ZSTD_compressStream2(m_state->zstd, &ob, &in, ZSTD_e_flush);
+	if(ZSTD_isError(rem))
+	  EUDAQ_THROW(std::string("Compression: zstd stream failed, ") + ZSTD_getErrorName(rem));
+	out = ob.pos;
+      }while(rem);
+      dst.resize(out);
+      return;
+    }
+#endif
+    default:
+      EUDAQ_THROW("Compression: codec " + CodecName(m_codec) + " is not available in this build");
+    }
+  }
+
+  struct StreamDecompressor::State {
+#ifdef EUDAQ_HAVE_ZLIB
+    z_stream zs;
+#endif
+#ifdef EUDAQ_HAVE_LZ4
+    std::vector<char> dict;
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+    ZSTD_DCtx *zstd;
+#endif
+  };
+
+  StreamDecompressor::StreamDecompressor(Codec c)
+    :m_codec(c), m_state(new State){
+    switch(c){
+    case Codec::NONE:
+      return;
+#ifdef EUDAQ_HAVE_ZLIB
+    case Codec::ZLIB:
+      std::memset(&m_state->zs, 0, sizeof(z_stream));
+      if(inflateInit(&m_state->zs) != Z_OK)
+	EUDAQ_THROW("Compression: unable to initialise zlib stream");
+      return;
+#endif
+#ifdef EUDAQ_HAVE_LZ4
+    case Codec::LZ4:
+      return;
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+    case Codec::ZSTD:
+      m_state->zstd = ZSTD_createDCtx();
+      return;
+#endif
+    default:
+      EUDAQ_THROW("Compression: codec " + CodecName(c) + " is not available in this build");
+    }
+  }
+
+  StreamDecompressor::~StreamDecompressor(){
+    switch(m_codec){
+#ifdef EUDAQ_HAVE_ZLIB
+    case Codec::ZLIB:
+      inflateEnd(&m_state->zs);
+      break;
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+    case Codec::ZSTD:
+      ZSTD_freeDCtx(m_state->zstd);
+      break;
+#endif
+    default:
+      break;
+    }
+  }
+
+  void StreamDecompressor::Decompress(const uint8_t *src, size_t len, size_t raw_len,
+				      std::vector<uint8_t> &dst){
+    switch(m_codec){
+    case Codec::NONE:
+      if(len != raw_len)
+	EUDAQ_THROW("Compression: size mismatch of uncompressed block");
+      dst.assign(src, src + len);
+      return;
+#ifdef EUDAQ_HAVE_ZLIB
+    case Codec::ZLIB:{
+      // one spare byte, so that the empty block of the sync flush is consumed as well
+      z_stream &zs = m_state->zs;
+      dst.resize(raw_len + 1);
+      zs.next_in = const_cast<Bytef*>(src);
+      zs.avail_in = static_cast<uInt>(len);
+      zs.next_out = dst.data();
+      zs.avail_out = static_cast<uInt>(dst.size());
+      int r = inflate(&zs, Z_SYNC_FLUSH);
+      if((r != Z_OK && r != Z_BUF_ERROR) || zs.avail_in || zs.avail_out != 1)
+	EUDAQ_THROW("Compression: corrupted zlib stream");
+      dst.resize(raw_len);
+      return;
+    }
+#endif
+#ifdef EUDAQ_HAVE_LZ4
+    case Codec::LZ4:{
+      std::vector<char> &dict = m_state->dict;
+      dst.resize(raw_len);
+      int n = LZ4_decompress_safe_usingDict(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(dst.data()),
+					    static_cast<int>(len), static_cast<int>(raw_len),
+					    dict.data(), static_cast<int>(dict.size()));
+      if(n < 0 || static_cast<size_t>(n) != raw_len)
+	EUDAQ_THROW("Compression: corrupted lz4 stream");
+      dict.insert(dict.end(), dst.begin(), dst.end());
+      if(dict.size() > LZ4_HISTORY)
+	dict.erase(dict.begin(), dict.end() - LZ4_HISTORY);
+      return;
+    }
+#endif
+#ifdef EUDAQ_HAVE_ZSTD
+    case Codec::ZSTD:{
+      dst.resize(raw_len);
+      ZSTD_inBuffer in = {src, len, 0};
+      ZSTD_outBuffer out = {dst.data(), dst.size(), 0};
+      while(in.pos < in.size){
+	size_t in_pos = in.pos, out_pos = out.pos;
+	size_t r = ZSTD_decompressStream(m_state->zstd, &out, &in);
+	if(ZSTD_isError(r) || (in.pos == in_pos && out.pos == out_pos))
+	  EUDAQ_THROW("Compression: corrupted zstd stream");
+      }
+      if(out.pos != raw_len)
+	EUDAQ_THROW("Compression: corrupted zstd stream");
+      return;
+    }
+#endif
+    default:
+      EUDAQ_THROW("Compression: codec " + CodecName(m_codec) + " is not available in this build");
+    }
+  }
+}
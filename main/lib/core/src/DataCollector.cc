@@ -1,6 +1,7 @@
 #include "eudaq/DataCollector.hh"
 #include "eudaq/Logger.hh"
 #include "eudaq/Utils.hh"
+#include "eudaq/Metrics.hh"
 #include <iostream>
 #include <ostream>
 #include <ctime>
@@ -96,6 +97,8 @@ namespace eudaq {
       m_data_addr = Listen(m_data_addr);
       SetStatusTag("_SERVER", m_data_addr);
       m_writer = Factory<FileWriter>::Create<std::string&>(str2hash(m_fwtype), m_fwpatt);
+      if(m_writer)
+	m_writer->SetConfiguration(GetConfiguration());
       m_evt_c = 0;
 
       std::string mn_str = GetConfiguration()->Get("EUDAQ_MN", "");
@@ -130,6 +133,8 @@ namespace eudaq {
       m_senders.clear();
       lk.unlock();
       StopListen();
+      // writers buffering chunks complete the file when they are released
+      m_writer.reset();
       CommandReceiver::OnStopRun();
     } catch (const Exception &e) {
       std::string msg = "Error stopping for run " + std::to_string(GetRunNumber()) + ": " + e.what();
@@ -163,7 +168,7 @@ namespace eudaq {
   }
     
   void DataCollector::OnStatus(){
-    SetStatusTag("EventN", std::to_string(m_evt_c));
+    SetStatusCounter("EventN", m_evt_c);
     SetStatusTag("MonitorEventN", std::to_string(float(m_evt_c/m_fraction)));
     DoStatus();
     // if(m_writer && m_writer->FileBytes()){
@@ -180,6 +185,9 @@ namespace eudaq {
   }
     
   void DataCollector::OnReceive(ConnectionSPC id, EventSP ev){
+    // one shard of a producer splitting its events (EUDAQ_DC_SHARD)
+    if(ev->IsBORE() && ev->HasTag("EUDAQ_SHARD"))
+      ev->SetTag("EUDAQ_SHARD_DC", GetName());
     DoReceive(id, ev);
   }  
     
@@ -196,11 +204,18 @@ namespace eudaq {
       ev->SetEventN(m_evt_c);
       m_evt_c ++;
       ev->SetStreamN(m_dct_n);
+      static auto &metrics = Metrics::Instance();
+      static auto &h_write = metrics.Histogram("write");
+      static auto &c_written = metrics.Counter("events_written");
+      uint64_t t0 = metrics.IsEnabled() ? Metrics::NowNs() : 0;
       auto file_writer = m_writer;
       if(file_writer)
 	file_writer->WriteEvent(ev);
       else
 	EUDAQ_THROW("FileWriter is not created before writing.");
+      c_written.Add();
+      if(t0)
+	h_write.Record(Metrics::NowNs() - t0);
       std::unique_lock<std::mutex> lk(m_mtx_sender);
       auto senders = m_senders;
       lk.unlock();
@@ -3,10 +3,12 @@
 #include "eudaq/BufferSerializer.hh"
 #include "eudaq/Logger.hh"
 #include "eudaq/Utils.hh"
+#include "eudaq/Metrics.hh"
 #include <iostream>
 #include <ostream>
 #include <ctime>
 #include <iomanip>
+#include <cstring>
 namespace eudaq {
   
   DataReceiver::DataReceiver()
@@ -33,17 +35,24 @@ namespace eudaq {
     auto con = ev.id;
     bool has_con_for_discon = false;
     switch (ev.etype) {
-    case (TransportEvent::CONNECT):
-      m_dataserver->SendPacket("OK EUDAQ DATA DataReceiver", *con, true);
+    case (TransportEvent::CONNECT):{
+      // advertise the codecs, a sender picks one of them in its reply
+      std::string codecs;
+      for(auto c: {Codec::LZ4, Codec::ZSTD, Codec::ZLIB})
+	if(CodecAvailable(c))
+	  codecs += (codecs.empty() ? " CODECS=" : ",") + CodecName(c);
+      m_dataserver->SendPacket("OK EUDAQ DATA DataReceiver" + codecs, *con, true);
       break;
+    }
     case (TransportEvent::DISCONNECT):
       con->SetState(0);
+      m_decomp.erase(con);
       EUDAQ_INFO("DataReceiver: Disconnected from " + to_string(*con));
       for (size_t i = 0; i < m_vt_con.size(); ++i){
 	if (m_vt_con[i] == con){
 	  m_vt_con.erase(m_vt_con.begin() + i);
 	  std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-	  m_qu_ev.push(std::make_pair<EventSP, ConnectionSPC>(nullptr, con));
+	  m_qu_ev.emplace(nullptr, con, 0);
 	  m_cv_not_empty.notify_all();
 	  has_con_for_discon = true;
 	}
@@ -52,6 +61,8 @@ namespace eudaq {
 	EUDAQ_THROW("DataReceiver: Unrecognised Connection"  + to_string(*con));
       break;
     case (TransportEvent::RECEIVE):
+      if (con->GetState() < 0) // closed after a bad packet
+        break;
       if (con->GetState() == 0) { //unidentified connection
         do {
           size_t i0 = 0, i1 = ev.packet.find(' ');
@@ -82,26 +93,98 @@ namespace eudaq {
           i1 = ev.packet.find(' ', i0);
           part = std::string(ev.packet, i0, i1 - i0);
           con->SetName(part);
+          if (i1 == std::string::npos || ev.packet.compare(i1 + 1, 6, "CODEC=") != 0)
+            break;
+          part = ev.packet.substr(i1 + 7);
+          for(auto c: {Codec::LZ4, Codec::ZSTD, Codec::ZLIB})
+            if(CodecAvailable(c) && CodecName(c) == part){
+              try{
+                m_decomp[con].reset(new StreamDecompressor(c));
+              }
+              catch(const std::exception &e){
+                // the sender is answered without a codec and sends uncompressed
+                m_decomp.erase(con);
+                EUDAQ_ERROR("DataReceiver: " + part + " unusable, " + e.what());
+              }
+            }
         } while (false);
-        m_dataserver->SendPacket("OK", *con, true);
+        if(m_decomp.count(con)){
+          std::string codec = CodecName(m_decomp[con]->GetCodec());
+          m_dataserver->SendPacket("OK CODEC=" + codec, *con, true);
+          EUDAQ_INFO("DataReceiver: " + codec + " compressed connection from " + to_string(*con));
+        }
+        else{
+          m_dataserver->SendPacket("OK", *con, true);
+          EUDAQ_INFO("DataReceiver: Connection from " + to_string(*con));
+        }
         con->SetState(1); // successfully identified
-	EUDAQ_INFO("DataReceiver: Connection from " + to_string(*con));
 	m_vt_con.push_back(con);
 	std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-	m_qu_ev.push(std::make_pair<EventSP, ConnectionSPC>(nullptr, con));
+	m_qu_ev.emplace(nullptr, con, 0);
 	m_cv_not_empty.notify_all();
       }
       else{ //identified connection  
-	BufferSerializer ser(ev.packet.begin(), ev.packet.end());
-	uint32_t id;
-	ser.PreRead(id);
-	auto ev_con = std::make_pair<EventSP, ConnectionSPC>
-	  (Factory<Event>::MakeUnique<Deserializer&>(id, ser), con);
+	static auto &metrics = Metrics::Instance();
+	static auto &h_deser = metrics.Histogram("deserialize");
+	static auto &h_recv = metrics.Histogram("receive");
+	static auto &c_recv = metrics.Counter("events_received");
+	static auto &c_bytes = metrics.Counter("bytes_received");
+	static auto &c_raw = metrics.Counter("bytes_received_raw");
+	static auto &c_drop = metrics.Counter("events_dropped");
+	bool timed = metrics.IsEnabled();
+	uint64_t t0 = timed ? Metrics::NowNs() : 0;
+	EventSP evsp;
+	try{
+	  auto it_decomp = m_decomp.find(con);
+	  if(it_decomp != m_decomp.end()){
+	    uint32_t raw_len;
+	    if(ev.packet.size() < 4)
+	      EUDAQ_THROW("DataReceiver: Truncated packet from " + to_string(*con));
+	    std::memcpy(&raw_len, ev.packet.data(), 4);
+	    it_decomp->second->Decompress(reinterpret_cast<const uint8_t*>(ev.packet.data()) + 4,
+					  ev.packet.size() - 4, raw_len, m_decomp_buf);
+	  }
+	  BufferSerializer ser = it_decomp != m_decomp.end() ?
+	    BufferSerializer(m_decomp_buf.begin(), m_decomp_buf.end()) :
+	    BufferSerializer(ev.packet.begin(), ev.packet.end());
+	  c_raw.Add(ser.size());
+	  uint32_t id;
+	  ser.PreRead(id);
+	  evsp = Factory<Event>::MakeUnique<Deserializer&>(id, ser);
+	}
+	catch(const std::exception &e){
+	  // a corrupt stream can not be resynchronised, drop only this connection
+	  EUDAQ_ERROR("DataReceiver: Closing " + to_string(*con) + ", bad packet: " + e.what());
+	  con->SetState(-1);
+	  m_decomp.erase(con);
+	  m_dataserver->Close(*con);
+	  for (size_t i = 0; i < m_vt_con.size(); ++i){
+	    if (m_vt_con[i] == con){
+	      m_vt_con.erase(m_vt_con.begin() + i);
+	      std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+	      m_qu_ev.emplace(nullptr, con, 0);
+	      m_cv_not_empty.notify_all();
+	      break;
+	    }
+	  }
+	  break;
+	}
+	uint64_t t1 = 0;
+	if(timed){
+	  t1 = Metrics::NowNs();
+	  h_deser.Record(t1 - t0);
+	}
+	uint64_t lat;
+	if(evsp && evsp->HasTag("EUDAQ_SEND_NS") && Metrics::TakeSendStamp(*evsp, lat) && timed)
+	  h_recv.Record(lat);
+	c_recv.Add();
+	c_bytes.Add(ev.packet.size());
 	std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-	m_qu_ev.push(ev_con);
+	m_qu_ev.emplace(evsp, con, t1);
 	if(m_qu_ev.size() > 50000){
 	  m_qu_ev.pop();
-	  EUDAQ_WARN("DataReceiver: Buffer of receving event is full.");
+	  c_drop.Add();
+	  EUDAQ_WARN_LAZY("DataReceiver: Buffer of receving event is full.");
 	}
 	m_cv_not_empty.notify_all();
       }
@@ -135,11 +218,15 @@ namespace eudaq {
 	  }
 	}
       }
-      auto ev = m_qu_ev.front().first;
-      auto con = m_qu_ev.front().second;
+      auto ev = std::get<0>(m_qu_ev.front());
+      auto con = std::get<1>(m_qu_ev.front());
+      uint64_t tp_queued = std::get<2>(m_qu_ev.front());
       m_qu_ev.pop();
       lk.unlock();
       if(ev){
+	static auto &h_wait = Metrics::Instance().Histogram("queue_wait");
+	if(tp_queued)
+	  h_wait.Record(Metrics::NowNs() - tp_queued);
 	OnReceive(con, ev);
       }
       else{
@@ -226,7 +313,7 @@ namespace eudaq {
 	  }
 	  if(!m_qu_ev.empty()){
 	    EUDAQ_WARN("DataReceiver: Data buffer is not empty during the stopping");
-	    m_qu_ev = std::queue<std::pair<EventSP, ConnectionSPC>>();
+	    m_qu_ev = decltype(m_qu_ev)();
 	  }
 	  if(m_dataserver)
 	    m_dataserver.reset();
@@ -247,7 +334,7 @@ namespace eudaq {
       }
       if(!m_qu_ev.empty()){
 	EUDAQ_WARN("DataReceiver: Data buffer is not empty during the exiting");
-	m_qu_ev = std::queue<std::pair<EventSP, ConnectionSPC>>();
+	m_qu_ev = decltype(m_qu_ev)();
       }
       if(m_dataserver)
 	m_dataserver.reset();
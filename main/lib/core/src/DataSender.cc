@@ -4,13 +4,19 @@
 #include "eudaq/BufferSerializer.hh"
 #include "eudaq/Logger.hh"
 #include "eudaq/DataSender.hh"
+#include "eudaq/Metrics.hh"
+#include <cstring>
 
 namespace eudaq {
 
   DataSender::DataSender(const std::string & type, const std::string & name)
     : m_type(type),
     m_name(name),
-    m_packetCounter(0) {}
+    m_packetCounter(0),
+    m_codec(Codec::NONE),
+    m_level(0),
+    m_bytes_raw(0),
+    m_bytes_sent(0) {}
 
 
   DataSender::~DataSender(){
@@ -22,6 +28,11 @@ namespace eudaq {
     std::cout<< "dataSender cleared"<<std::endl;
   }
 
+  void DataSender::SetCompression(Codec c, int level){
+    m_codec = c;
+    m_level = level;
+  }
+
   void DataSender::Connect(const std::string & server) {
     m_is_connected = false;
     try{
@@ -67,13 +78,32 @@ namespace eudaq {
     if (part != "DataReceiver" && part != "DataCollector" && part != "Monitor" )
       EUDAQ_THROW("DataSender:: Invalid response from DataReceiver server, part=" + part);
 
-    m_dataclient->SendPacket("OK EUDAQ DATA " + m_type + " " + m_name);
+    // newer receivers list their codecs after the greeting, older ones ignore our request
+    std::string hello = "OK EUDAQ DATA " + m_type + " " + m_name;
+    std::string codec = CodecName(m_codec);
+    if (m_codec != Codec::NONE){
+      std::string codecs;
+      if (i1 != std::string::npos && packet.compare(i1 + 1, 7, "CODECS=") == 0)
+	codecs = "," + packet.substr(i1 + 8) + ",";
+      if (codecs.find("," + codec + ",") != std::string::npos)
+	hello += " CODEC=" + codec;
+      else
+	EUDAQ_WARN("DataSender:: " + server + " does not support " + codec + " compression, sending uncompressed");
+    }
+    m_dataclient->SendPacket(hello);
     packet = "";
     if (!m_dataclient->ReceivePacket(&packet, 1000000))
       EUDAQ_THROW("DataSender:: No response from DataReceiver server");
     i1 = packet.find(' ');
     if (std::string(packet, 0, i1) != "OK")
       EUDAQ_THROW("DataSender:: Connection refused by DataReceiver server: " + packet);
+    std::unique_lock<std::mutex> lk_send(m_mx_send);
+    m_comp.reset();
+    if (i1 != std::string::npos && packet.substr(i1 + 1) == "CODEC=" + codec)
+      m_comp.reset(new StreamCompressor(m_codec, m_level));
+    m_bytes_raw = 0;
+    m_bytes_sent = 0;
+    lk_send.unlock();
     m_is_connected = true;
     m_fut_async = std::async(std::launch::async, &DataSender::AsyncSending, this);
   }
@@ -94,9 +124,32 @@ namespace eudaq {
 
     BufferSerializer ser;
     ev->Serialize(ser);
+    Send(ser);
+  }
+
+  void DataSender::Send(const BufferSerializer &ser){
+    static auto &c_bytes = Metrics::Instance().Counter("bytes_sent");
+    static auto &c_raw = Metrics::Instance().Counter("bytes_sent_raw");
+    std::unique_lock<std::mutex> lk(m_mx_send);
     m_packetCounter += 1;
+    size_t sent = ser.size();
     //TODO: catch exception below
-    m_dataclient->SendPacket(ser);
+    if(m_comp){
+      // u32 serialized size followed by the next block of the connection stream
+      uint32_t raw_len = static_cast<uint32_t>(ser.size());
+      m_comp->Compress(ser.size() ? &ser[0] : nullptr, ser.size(), m_comp_block);
+      m_comp_buf.resize(4 + m_comp_block.size());
+      std::memcpy(m_comp_buf.data(), &raw_len, 4);
+      std::memcpy(m_comp_buf.data() + 4, m_comp_block.data(), m_comp_block.size());
+      m_dataclient->SendPacket(m_comp_buf.data(), m_comp_buf.size());
+      sent = m_comp_buf.size();
+    }
+    else
+      m_dataclient->SendPacket(ser);
+    m_bytes_raw += ser.size();
+    m_bytes_sent += sent;
+    c_bytes.Add(sent);
+    c_raw.Add(ser.size());
   }
 
   bool DataSender::AsyncSending(){
@@ -115,9 +168,7 @@ namespace eudaq {
       lk.unlock();
       BufferSerializer ser;
       ev->Serialize(ser);
-      m_packetCounter += 1;
-      //TODO: catch exception below
-      m_dataclient->SendPacket(ser);
+      Send(ser);
     }
 
     return true;
@@ -107,11 +107,17 @@ namespace eudaq {
   std::vector<uint8_t> Event::GetBlock(uint32_t i) const{
     auto it = m_blocks.find(i);
     if(it == m_blocks.end()){
-      EUDAQ_WARN(std::string("RAWDATAEVENT:: no bolck with ID ") + std::to_string(i) + " exists");
+      EUDAQ_WARN_LAZY(std::string("RAWDATAEVENT:: no bolck with ID ") + std::to_string(i) + " exists");
     }
     return it->second;
   }
 
+  const std::vector<uint8_t>& Event::GetBlockRef(uint32_t i) const{
+    static const std::vector<uint8_t> empty;
+    auto it = m_blocks.find(i);
+    return it == m_blocks.end() ? empty : it->second;
+  }
+
   std::vector<uint32_t> Event::GetBlockNumList() const {
     std::vector<uint32_t> vnum;
     for(auto &e : m_blocks){
@@ -163,6 +169,7 @@ namespace eudaq {
 
   bool Event::HasTag(const std::string &name) const {return m_tags.find(name) != m_tags.end();}
   void Event::SetTag(const std::string &name, const std::string &val) {m_tags[name] = val;}
+  void Event::RemoveTag(const std::string &name) {m_tags.erase(name);}
   std::map<std::string, std::string> Event::GetTags() const {return m_tags;}
     
   void Event::SetFlagBit(uint32_t f) { m_flags |= f;}
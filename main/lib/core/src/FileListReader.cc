@@ -0,0 +1,65 @@
+#include "eudaq/FileReader.hh"
+#include "eudaq/Utils.hh"
+
+#include <fstream>
+#include <vector>
+
+// Reads the files named in a list file, one per line, as one stream, e.g.
+// the parts of a run written by NativeFileWriter with EUDAQ_FW_MAX_*.
+// Relative paths are relative to the directory of the list file, the type
+// of each file follows from its extension.
+class FileListReader : public eudaq::FileReader {
+public:
+  FileListReader(const std::string& filename);
+  eudaq::EventSPC GetNextEvent()override;
+private:
+  std::vector<std::string> m_paths;
+  size_t m_next;
+  eudaq::FileReaderUP m_reader;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::FileReader>::
+    Register<FileListReader, std::string&>(eudaq::cstr2hash("list"));
+  auto dummy1 = eudaq::Factory<eudaq::FileReader>::
+    Register<FileListReader, std::string&&>(eudaq::cstr2hash("list"));
+}
+
+FileListReader::FileListReader(const std::string& filename)
+  :m_next(0){
+  std::ifstream file(filename);
+  if(!file)
+    EUDAQ_THROW("FileListReader: unable to open file: " + filename);
+  size_t i = filename.find_last_of("/\\");
+  std::string dir = i == std::string::npos ? "" : filename.substr(0, i + 1);
+  std::string line;
+  while(std::getline(file, line)){
+    line = eudaq::trim(line);
+    if(line.empty() || line[0] == '#')
+      continue;
+    if(line[0] != '/' && line.find(':') == std::string::npos)
+      line = dir + line;
+    m_paths.push_back(line);
+  }
+}
+
+eudaq::EventSPC FileListReader::GetNextEvent(){
+  while(true){
+    if(m_reader){
+      auto ev = m_reader->GetNextEvent();
+      if(ev)
+	return ev;
+      m_reader.reset();
+    }
+    if(m_next == m_paths.size())
+      return nullptr;
+    auto &path = m_paths[m_next++];
+    std::string type = path.substr(path.find_last_of('.') + 1);
+    if(type == "raw")
+      type = "native";
+    m_reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash(type), path);
+    if(!m_reader)
+      EUDAQ_THROW("FileListReader: no FileReader for " + path);
+    m_reader->SetConfiguration(GetConfiguration());
+  }
+}
@@ -0,0 +1,178 @@
+#include "eudaq/HitFile.hh"
+#include "eudaq/Exception.hh"
+
+#include <cstring>
+#include <fstream>
+
+#if EUDAQ_PLATFORM_IS(WIN32)
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace eudaq {
+
+  namespace{
+    template <typename T> T Peek(const uint8_t *data, size_t size, size_t pos){
+      if(pos + sizeof(T) > size)
+	EUDAQ_THROW("HitFile: unexpected end of file");
+      T v;
+      std::memcpy(&v, data + pos, sizeof(T));
+      return v;
+    }
+
+    size_t Pad8(size_t n){
+      return (n + 7) & ~size_t(7);
+    }
+  }
+
+  const uint32_t HitFile::VERSION;
+
+  HitFile::HitFile(const std::string &path)
+    :m_data(nullptr), m_size(0){
+    Map(path);
+    size_t pos = ParseHeader();
+    if(m_size >= pos + 16 && !std::memcmp(m_data + m_size - 8, "EUDAQEND", 8)){
+      ParseFooter(Peek<uint64_t>(m_data, m_size, m_size - 16));
+      return;
+    }
+    // no footer, the writer has not been closed properly
+    Chunk chunk;
+    while(size_t next = ParseChunk(pos, chunk)){
+      m_chunks.push_back(chunk);
+      pos = next;
+    }
+  }
+
+  HitFile::~HitFile(){
+#if !EUDAQ_PLATFORM_IS(WIN32)
+    if(m_data && m_buffer.empty())
+      munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+  }
+
+  void HitFile::Map(const std::string &path){
+#if EUDAQ_PLATFORM_IS(WIN32)
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if(!in)
+      EUDAQ_THROW("HitFile: unable to open " + path);
+    m_buffer.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+      EUDAQ_THROW("HitFile: unable to open " + path);
+    struct stat st;
+    if(fstat(fd, &st) || st.st_size == 0){
+      close(fd);
+      EUDAQ_THROW("HitFile: empty file " + path);
+    }
+    m_size = st.st_size;
+    void *p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(p == MAP_FAILED)
+      EUDAQ_THROW("HitFile: unable to map " + path);
+    madvise(p, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const uint8_t*>(p);
+#endif
+  }
+
+  size_t HitFile::ParseHeader(){
+    if(m_size < 16 || std::memcmp(m_data, "EUDAQHIT", 8))
+      EUDAQ_THROW("HitFile: not a hit file");
+    uint32_t version = Peek<uint32_t>(m_data, m_size, 8);
+    if(version > VERSION)
+      EUDAQ_THROW("HitFile: unsupported version " + std::to_string(version));
+    uint32_t ncol = Peek<uint32_t>(m_data, m_size, 12);
+    size_t pos = 16;
+    for(uint32_t i = 0; i < ncol; i++){
+      ColumnInfo col;
+      col.group = Peek<char>(m_data, m_size, pos);
+      col.type = Peek<char>(m_data, m_size, pos + 1);
+      uint16_t len = Peek<uint16_t>(m_data, m_size, pos + 2);
+      pos += 4;
+      if(pos + len > m_size)
+	EUDAQ_THROW("HitFile: unexpected end of file");
+      col.name.assign(reinterpret_cast<const char*>(m_data + pos), len);
+      pos += len;
+      m_columns.push_back(col);
+    }
+    return Pad8(pos);
+  }
+
+  size_t HitFile::ParseChunk(size_t pos, Chunk &chunk) const{
+    if(pos + 8 + sizeof(HitChunkStat) > m_size || std::memcmp(m_data + pos, "CHNK", 4))
+      return 0;
+    std::memcpy(&chunk.stat, m_data + pos + 8, sizeof(HitChunkStat));
+    pos += 8 + sizeof(HitChunkStat);
+    chunk.cols.clear();
+    for(size_t i = 0; i < m_columns.size(); i++){
+      if(pos + 8 > m_size)
+	return 0;
+      uint64_t len;
+      std::memcpy(&len, m_data + pos, 8);
+      pos += 8;
+      if(len > m_size - pos)
+	return 0;
+      chunk.cols.push_back(m_data + pos);
+      pos += Pad8(len);
+    }
+    return pos;
+  }
+
+  void HitFile::ParseFooter(size_t pos){
+    auto str = [this](size_t &p){
+      uint32_t len = Peek<uint32_t>(m_data, m_size, p);
+      p += 4;
+      if(p + len > m_size)
+	EUDAQ_THROW("HitFile: unexpected end of file");
+      std::string s(reinterpret_cast<const char*>(m_data + p), len);
+      p += len;
+      return s;
+    };
+    uint32_t nplane = Peek<uint32_t>(m_data, m_size, pos);
+    pos += 4;
+    for(uint32_t i = 0; i < nplane; i++){
+      HitPlaneInfo pl;
+      pl.id = Peek<uint32_t>(m_data, m_size, pos);
+      pl.xsize = Peek<uint32_t>(m_data, m_size, pos + 4);
+      pl.ysize = Peek<uint32_t>(m_data, m_size, pos + 8);
+      pos += 12;
+      pl.type = str(pos);
+      pl.sensor = str(pos);
+      m_planes[pl.id] = pl;
+    }
+    uint32_t nchunk = Peek<uint32_t>(m_data, m_size, pos);
+    pos += 4;
+    for(uint32_t i = 0; i < nchunk; i++){
+      Chunk chunk;
+      if(!ParseChunk(Peek<uint64_t>(m_data, m_size, pos), chunk))
+	EUDAQ_THROW("HitFile: corrupted chunk");
+      pos += 8 + sizeof(HitChunkStat);
+      m_chunks.push_back(chunk);
+    }
+  }
+
+  bool HitFile::HasColumn(const std::string &name) const{
+    for(auto &col: m_columns)
+      if(col.name == name)
+	return true;
+    return false;
+  }
+
+  const void* HitFile::ColumnData(size_t chunk, const std::string &name, char type) const{
+    for(size_t i = 0; i < m_columns.size(); i++){
+      if(m_columns[i].name != name)
+	continue;
+      if(m_columns[i].type != type)
+	EUDAQ_THROW("HitFile: column " + name + " has type " + std::string(1, m_columns[i].type));
+      return m_chunks.at(chunk).cols[i];
+    }
+    return nullptr;
+  }
+}
@@ -0,0 +1,145 @@
+#include "eudaq/FileReader.hh"
+#include "eudaq/HitFile.hh"
+#include "eudaq/StandardEvent.hh"
+
+#include <limits>
+
+// Reads a hit file back as StandardEvents. With HITS_EVENT_MIN/MAX,
+// HITS_TRIGGER_MIN/MAX or HITS_TIME_MIN/MAX in the configuration, only the
+// events inside these ranges are returned and chunks outside of them are
+// skipped on their statistics alone.
+class HitFileReader : public eudaq::FileReader {
+public:
+  HitFileReader(const std::string &filename);
+  eudaq::EventSPC GetNextEvent() override;
+private:
+  void SetRange();
+  bool InRange(const eudaq::HitChunkStat &st) const;
+  bool InRange(uint32_t event_n, uint32_t trigger_n, uint64_t tb, uint64_t te) const;
+  bool NextChunk();
+
+  std::string m_filename;
+  std::unique_ptr<eudaq::HitFile> m_file;
+  bool m_has_range;
+  uint32_t m_ev_min, m_ev_max;
+  uint32_t m_tg_min, m_tg_max;
+  uint64_t m_ts_min, m_ts_max;
+
+  size_t m_chunk;
+  uint32_t m_ev, m_pl, m_hit;
+  eudaq::HitChunkStat m_stat;
+  const uint32_t *m_run_n, *m_event_n, *m_trigger_n, *m_device_n, *m_flag;
+  const uint64_t *m_ts_begin, *m_ts_end;
+  const uint32_t *m_pl_event, *m_pl_id, *m_pl_n_hit;
+  const float *m_hit_x, *m_hit_y, *m_hit_value;
+  const uint64_t *m_hit_time;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::FileReader>::
+    Register<HitFileReader, std::string&>(eudaq::cstr2hash("hits"));
+  auto dummy1 = eudaq::Factory<eudaq::FileReader>::
+    Register<HitFileReader, std::string&&>(eudaq::cstr2hash("hits"));
+}
+
+HitFileReader::HitFileReader(const std::string &filename)
+  :m_filename(filename), m_has_range(false), m_chunk(0), m_ev(0), m_pl(0), m_hit(0){
+  m_stat = eudaq::HitChunkStat();
+}
+
+void HitFileReader::SetRange(){
+  auto conf = GetConfiguration();
+  m_ev_min = m_tg_min = 0;
+  m_ev_max = m_tg_max = std::numeric_limits<uint32_t>::max();
+  m_ts_min = 0;
+  m_ts_max = std::numeric_limits<uint64_t>::max();
+  if(!conf)
+    return;
+  m_ev_min = conf->Get("HITS_EVENT_MIN", uint64_t(m_ev_min));
+  m_ev_max = conf->Get("HITS_EVENT_MAX", uint64_t(m_ev_max));
+  m_tg_min = conf->Get("HITS_TRIGGER_MIN", uint64_t(m_tg_min));
+  m_tg_max = conf->Get("HITS_TRIGGER_MAX", uint64_t(m_tg_max));
+  m_ts_min = conf->Get("HITS_TIME_MIN", m_ts_min);
+  m_ts_max = conf->Get("HITS_TIME_MAX", m_ts_max);
+  m_has_range = true;
+}
+
+bool HitFileReader::InRange(const eudaq::HitChunkStat &st) const{
+  return st.event_max >= m_ev_min && st.event_min <= m_ev_max &&
+    st.trigger_max >= m_tg_min && st.trigger_min <= m_tg_max &&
+    st.time_max >= m_ts_min && st.time_min <= m_ts_max;
+}
+
+bool HitFileReader::InRange(uint32_t event_n, uint32_t trigger_n, uint64_t tb, uint64_t te) const{
+  return event_n >= m_ev_min && event_n <= m_ev_max &&
+    trigger_n >= m_tg_min && trigger_n <= m_tg_max &&
+    te >= m_ts_min && tb <= m_ts_max;
+}
+
+bool HitFileReader::NextChunk(){
+  for(; m_chunk < m_file->NumChunks(); m_chunk++){
+    if(m_has_range && !InRange(m_file->GetChunkStat(m_chunk)))
+      continue;
+    m_stat = m_file->GetChunkStat(m_chunk);
+    m_run_n = m_file->Column<uint32_t>(m_chunk, "run_n");
+    m_event_n = m_file->Column<uint32_t>(m_chunk, "event_n");
+    m_trigger_n = m_file->Column<uint32_t>(m_chunk, "trigger_n");
+    m_device_n = m_file->Column<uint32_t>(m_chunk, "device_n");
+    m_flag = m_file->Column<uint32_t>(m_chunk, "event_flag");
+    m_ts_begin = m_file->Column<uint64_t>(m_chunk, "ts_begin");
+    m_ts_end = m_file->Column<uint64_t>(m_chunk, "ts_end");
+    m_pl_event = m_file->Column<uint32_t>(m_chunk, "plane_event");
+    m_pl_id = m_file->Column<uint32_t>(m_chunk, "plane_id");
+    m_pl_n_hit = m_file->Column<uint32_t>(m_chunk, "plane_n_hit");
+    m_hit_x = m_file->Column<float>(m_chunk, "hit_x");
+    m_hit_y = m_file->Column<float>(m_chunk, "hit_y");
+    m_hit_value = m_file->Column<float>(m_chunk, "hit_value");
+    m_hit_time = m_file->Column<uint64_t>(m_chunk, "hit_time");
+    if(!m_run_n || !m_event_n || !m_trigger_n || !m_device_n || !m_flag || !m_ts_begin || !m_ts_end ||
+       !m_pl_event || !m_pl_id || !m_pl_n_hit || !m_hit_x || !m_hit_y || !m_hit_value || !m_hit_time)
+      EUDAQ_THROW("HitFileReader: missing column in " + m_filename);
+    m_chunk++;
+    m_ev = m_pl = m_hit = 0;
+    return true;
+  }
+  return false;
+}
+
+eudaq::EventSPC HitFileReader::GetNextEvent(){
+  if(!m_file){
+    m_file.reset(new eudaq::HitFile(m_filename));
+    SetRange();
+  }
+  while(1){
+    if(m_ev == m_stat.n_event && !NextChunk())
+      return nullptr;
+    uint32_t i = m_ev++;
+    if(m_has_range && !InRange(m_event_n[i], m_trigger_n[i], m_ts_begin[i], m_ts_end[i])){
+      for(; m_pl < m_stat.n_plane && m_pl_event[m_pl] == i; m_pl++)
+	m_hit += m_pl_n_hit[m_pl];
+      continue;
+    }
+    auto ev = eudaq::StandardEvent::MakeShared();
+    ev->SetRunN(m_run_n[i]);
+    ev->SetEventN(m_event_n[i]);
+    ev->SetDeviceN(m_device_n[i]);
+    ev->SetTriggerN(m_trigger_n[i], false);
+    ev->SetTimestamp(m_ts_begin[i], m_ts_end[i], false);
+    ev->SetFlag(m_flag[i]);
+    auto &planes = m_file->GetPlanes();
+    for(; m_pl < m_stat.n_plane && m_pl_event[m_pl] == i; m_pl++){
+      uint32_t id = m_pl_id[m_pl];
+      uint32_t nh = m_pl_n_hit[m_pl];
+      auto it = planes.find(id);
+      eudaq::StandardPlane plane(id, it != planes.end() ? it->second.type : "",
+				 it != planes.end() ? it->second.sensor : "");
+      plane.SetSizeZS(it != planes.end() ? it->second.xsize : 0,
+		      it != planes.end() ? it->second.ysize : 0, 0);
+      for(uint32_t h = 0; h < nh; h++, m_hit++)
+	plane.PushPixel(static_cast<uint32_t>(m_hit_x[m_hit]), static_cast<uint32_t>(m_hit_y[m_hit]),
+			m_hit_value[m_hit], m_hit_time[m_hit]);
+      ev->AddPlane(plane);
+    }
+    return ev;
+  }
+}
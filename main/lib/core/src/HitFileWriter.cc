@@ -0,0 +1,282 @@
+#include "eudaq/FileNamer.hh"
+#include "eudaq/FileWriter.hh"
+#include "eudaq/HitFile.hh"
+#include "eudaq/StdEventConverter.hh"
+#include "eudaq/StandardEvent.hh"
+#include "eudaq/Logger.hh"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+
+// Writes the StandardEvent hits of the converted events in the columnar
+// format described in HitFile.hh. Events are buffered per column and
+// written as one chunk every HITS_CHUNK_EVENTS events.
+class HitFileWriter : public eudaq::FileWriter {
+public:
+  HitFileWriter(const std::string &patt);
+  ~HitFileWriter() override;
+  void WriteEvent(eudaq::EventSPC ev) override;
+  uint64_t FileBytes() const override;
+private:
+  void Open(uint32_t run_n);
+  void Close();
+  void Flush();
+  void Write(const void *data, size_t len);
+  template <typename T> void Write(const T &v){Write(&v, sizeof(T));}
+  template <typename T> void WriteColumn(const std::vector<T> &col);
+  void AddPlanes(const eudaq::StandardEvent &ev, uint32_t ev_idx);
+
+  std::string m_filepattern;
+  uint32_t m_run_n;
+  std::FILE *m_file;
+  uint64_t m_bytes;
+  uint32_t m_chunk_events;
+  std::vector<std::pair<uint64_t, eudaq::HitChunkStat>> m_index;
+  std::map<uint32_t, eudaq::HitPlaneInfo> m_planes;
+
+  eudaq::HitChunkStat m_stat;
+  std::vector<uint32_t> m_ev_run;
+  std::vector<uint32_t> m_ev_event;
+  std::vector<uint32_t> m_ev_trigger;
+  std::vector<uint32_t> m_ev_device;
+  std::vector<uint32_t> m_ev_flag;
+  std::vector<uint64_t> m_ev_ts_begin;
+  std::vector<uint64_t> m_ev_ts_end;
+  std::vector<uint32_t> m_pl_event;
+  std::vector<uint32_t> m_pl_id;
+  std::vector<uint32_t> m_pl_n_hit;
+  std::vector<uint32_t> m_hit_event;
+  std::vector<uint32_t> m_hit_plane;
+  std::vector<float> m_hit_x;
+  std::vector<float> m_hit_y;
+  std::vector<float> m_hit_value;
+  std::vector<uint64_t> m_hit_time;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::FileWriter>::
+    Register<HitFileWriter, std::string&>(eudaq::cstr2hash("hits"));
+  auto dummy1 = eudaq::Factory<eudaq::FileWriter>::
+    Register<HitFileWriter, std::string&&>(eudaq::cstr2hash("hits"));
+
+  // group, type and name of the columns, in the order of the chunk body
+  const struct {char group; char type; const char *name;} columns[] = {
+    {'E', 'I', "run_n"}, {'E', 'I', "event_n"}, {'E', 'I', "trigger_n"},
+    {'E', 'I', "device_n"}, {'E', 'I', "event_flag"},
+    {'E', 'L', "ts_begin"}, {'E', 'L', "ts_end"},
+    {'P', 'I', "plane_event"}, {'P', 'I', "plane_id"}, {'P', 'I', "plane_n_hit"},
+    {'H', 'I', "hit_event"}, {'H', 'I', "hit_plane"}, {'H', 'F', "hit_x"},
+    {'H', 'F', "hit_y"}, {'H', 'F', "hit_value"}, {'H', 'L', "hit_time"}
+  };
+
+  const uint8_t zeros[8] = {0};
+}
+
+HitFileWriter::HitFileWriter(const std::string &patt)
+  :m_filepattern(patt), m_run_n(0), m_file(nullptr), m_bytes(0), m_chunk_events(4096){
+}
+
+HitFileWriter::~HitFileWriter(){
+  try{
+    Close();
+  }catch(const eudaq::Exception &e){
+    EUDAQ_ERROR(e.what());
+  }
+}
+
+void HitFileWriter::Write(const void *data, size_t len){
+  if(len && std::fwrite(data, 1, len, m_file) != len)
+    EUDAQ_THROW("HitFileWriter: fail to write to the file");
+  m_bytes += len;
+}
+
+template <typename T> void HitFileWriter::WriteColumn(const std::vector<T> &col){
+  uint64_t len = col.size() * sizeof(T);
+  Write(len);
+  Write(col.data(), len);
+  Write(zeros, (8 - len % 8) % 8);
+}
+
+void HitFileWriter::Open(uint32_t run_n){
+  Close();
+  auto conf = GetConfiguration();
+  if(conf)
+    m_chunk_events = std::max(1, conf->Get("HITS_CHUNK_EVENTS", 4096));
+  std::time_t time_now = std::time(nullptr);
+  char time_buff[13];
+  time_buff[12] = 0;
+  std::strftime(time_buff, sizeof(time_buff), "%y%m%d%H%M%S", std::localtime(&time_now));
+  std::string time_str(time_buff);
+  std::string path = eudaq::FileNamer(m_filepattern).Set('X', ".hits").Set('R', run_n).Set('D', time_str);
+  m_file = std::fopen(path.c_str(), "wb");
+  if(!m_file)
+    EUDAQ_THROW("HitFileWriter: unable to open " + path);
+  m_run_n = run_n;
+  m_bytes = 0;
+  m_index.clear();
+  m_planes.clear();
+  m_stat = eudaq::HitChunkStat();
+
+  Write("EUDAQHIT", 8);
+  Write(eudaq::HitFile::VERSION);
+  Write(static_cast<uint32_t>(sizeof(columns) / sizeof(columns[0])));
+  for(auto &col: columns){
+    uint16_t len = static_cast<uint16_t>(std::strlen(col.name));
+    Write(col.group);
+    Write(col.type);
+    Write(len);
+    Write(col.name, len);
+  }
+  Write(zeros, (8 - m_bytes % 8) % 8);
+}
+
+void HitFileWriter::Flush(){
+  if(!m_stat.n_event)
+    return;
+  m_index.emplace_back(m_bytes, m_stat);
+  Write("CHNK", 4);
+  Write(static_cast<uint32_t>(0));
+  Write(m_stat);
+  WriteColumn(m_ev_run);
+  WriteColumn(m_ev_event);
+  WriteColumn(m_ev_trigger);
+  WriteColumn(m_ev_device);
+  WriteColumn(m_ev_flag);
+  WriteColumn(m_ev_ts_begin);
+  WriteColumn(m_ev_ts_end);
+  WriteColumn(m_pl_event);
+  WriteColumn(m_pl_id);
+  WriteColumn(m_pl_n_hit);
+  WriteColumn(m_hit_event);
+  WriteColumn(m_hit_plane);
+  WriteColumn(m_hit_x);
+  WriteColumn(m_hit_y);
+  WriteColumn(m_hit_value);
+  WriteColumn(m_hit_time);
+  std::fflush(m_file);
+
+  m_stat = eudaq::HitChunkStat();
+  m_ev_run.clear();
+  m_ev_event.clear();
+  m_ev_trigger.clear();
+  m_ev_device.clear();
+  m_ev_flag.clear();
+  m_ev_ts_begin.clear();
+  m_ev_ts_end.clear();
+  m_pl_event.clear();
+  m_pl_id.clear();
+  m_pl_n_hit.clear();
+  m_hit_event.clear();
+  m_hit_plane.clear();
+  m_hit_x.clear();
+  m_hit_y.clear();
+  m_hit_value.clear();
+  m_hit_time.clear();
+}
+
+void HitFileWriter::Close(){
+  if(!m_file)
+    return;
+  Flush();
+  uint64_t footer = m_bytes;
+  Write(static_cast<uint32_t>(m_planes.size()));
+  for(auto &e: m_planes){
+    auto &pl = e.second;
+    Write(pl.id);
+    Write(pl.xsize);
+    Write(pl.ysize);
+    Write(static_cast<uint32_t>(pl.type.size()));
+    Write(pl.type.data(), pl.type.size());
+    Write(static_cast<uint32_t>(pl.sensor.size()));
+    Write(pl.sensor.data(), pl.sensor.size());
+  }
+  Write(static_cast<uint32_t>(m_index.size()));
+  for(auto &e: m_index){
+    Write(e.first);
+    Write(e.second);
+  }
+  Write(footer);
+  Write("EUDAQEND", 8);
+  std::fclose(m_file);
+  m_file = nullptr;
+}
+
+void HitFileWriter::AddPlanes(const eudaq::StandardEvent &ev, uint32_t ev_idx){
+  for(size_t i = 0; i < ev.NumPlanes(); i++){
+    auto &plane = ev.GetPlane(i);
+    uint32_t id = plane.ID();
+    uint32_t nh = plane.HitPixels();
+    if(!m_planes.count(id))
+      m_planes[id] = eudaq::HitPlaneInfo{id, plane.XSize(), plane.YSize(), plane.Type(), plane.Sensor()};
+    m_pl_event.push_back(ev_idx);
+    m_pl_id.push_back(id);
+    m_pl_n_hit.push_back(nh);
+    for(uint32_t j = 0; j < nh; j++){
+      m_hit_event.push_back(ev_idx);
+      m_hit_plane.push_back(id);
+      m_hit_x.push_back(plane.GetX(j));
+      m_hit_y.push_back(plane.GetY(j));
+      m_hit_value.push_back(plane.GetPixel(j));
+      m_hit_time.push_back(plane.GetTimestamp(j));
+    }
+    m_stat.n_plane++;
+    m_stat.n_hit += nh;
+  }
+}
+
+void HitFileWriter::WriteEvent(eudaq::EventSPC ev){
+  uint32_t run_n = ev->GetRunN();
+  if(!m_file || m_run_n != run_n)
+    Open(run_n);
+
+  auto stdev = std::dynamic_pointer_cast<const eudaq::StandardEvent>(ev);
+  if(!stdev){
+    auto cvt = eudaq::StandardEvent::MakeShared();
+    try{
+      if(eudaq::StdEventConverter::Convert(ev, cvt, GetConfiguration()))
+	stdev = cvt;
+    }catch(const eudaq::StdEventConverterException &e){
+      EUDAQ_WARN_LAZY(std::string("HitFileWriter: ") + e.what());
+    }
+  }
+  // events without a conversion keep their header, so that event numbers stay aligned
+  const eudaq::Event &hd = stdev ? static_cast<const eudaq::Event&>(*stdev) : *ev;
+  uint32_t ev_idx = m_stat.n_event;
+  uint32_t event_n = ev->GetEventN();
+  uint32_t trigger_n = hd.GetTriggerN();
+  uint64_t ts_begin = hd.GetTimestampBegin();
+  uint64_t ts_end = hd.GetTimestampEnd();
+  m_ev_run.push_back(run_n);
+  m_ev_event.push_back(event_n);
+  m_ev_trigger.push_back(trigger_n);
+  m_ev_device.push_back(ev->GetDeviceN());
+  m_ev_flag.push_back(hd.GetFlag());
+  m_ev_ts_begin.push_back(ts_begin);
+  m_ev_ts_end.push_back(ts_end);
+  if(stdev)
+    AddPlanes(*stdev, ev_idx);
+
+  if(!ev_idx){
+    m_stat.event_min = m_stat.event_max = event_n;
+    m_stat.trigger_min = m_stat.trigger_max = trigger_n;
+    m_stat.time_min = ts_begin;
+    m_stat.time_max = ts_end;
+  }
+  else{
+    m_stat.event_min = std::min(m_stat.event_min, event_n);
+    m_stat.event_max = std::max(m_stat.event_max, event_n);
+    m_stat.trigger_min = std::min(m_stat.trigger_min, trigger_n);
+    m_stat.trigger_max = std::max(m_stat.trigger_max, trigger_n);
+    m_stat.time_min = std::min(m_stat.time_min, ts_begin);
+    m_stat.time_max = std::max(m_stat.time_max, ts_end);
+  }
+  m_stat.n_event++;
+  if(m_stat.n_event >= m_chunk_events)
+    Flush();
+}
+
+uint64_t HitFileWriter::FileBytes() const{
+  return m_bytes;
+}
@@ -4,11 +4,17 @@
 #include "eudaq/Exception.hh"
 #include "eudaq/BufferSerializer.hh"
 
+#include <algorithm>
+
 namespace eudaq {
 
   LogSender::LogSender()
-      : m_logclient(0), m_errlevel(Status::LVL_DEBUG),
-        m_shownotconnected(false) {}
+      : m_logclient(0), m_level(Status::LVL_DEBUG),
+        m_errlevel(Status::LVL_DEBUG), m_sendlevel(Status::LVL_DEBUG),
+        m_is_sending(false), m_threshold(Status::LVL_DEBUG),
+        m_shownotconnected(false), m_is_async(false),
+        m_qu_max(10000), m_n_dropped(0), m_n_dropped_reported(0),
+        m_repeat_window_ms(0), m_n_suppressed(0), m_n_repeat(0) {}
 
   void LogSender::Connect(const std::string &type, const std::string &name,
                           const std::string &server) {
@@ -58,22 +64,128 @@ namespace eudaq {
     i1 = packet.find(' ');
     if (std::string(packet, 0, i1) != "OK")
       EUDAQ_THROW("Connection refused by LogCollector server: " + packet);
+    m_is_sending = true;
+    UpdateThreshold();
+  }
+
+  void LogSender::UpdateThreshold() {
+    int level = m_level;
+    if (m_is_sending)
+      level = std::min<int>(level, m_sendlevel);
+    m_threshold.store(level, std::memory_order_relaxed);
   }
 
   void LogSender::Disconnect() {
     std::lock_guard<std::recursive_mutex> lk(m_mutex);
+    m_is_sending = false;
+    UpdateThreshold();
     delete m_logclient;
+    m_logclient = 0;
     isConnected = false;
   }
 
-  void LogSender::SendLogMessage(const LogMessage &msg) {
+  void LogSender::SetAsync(bool async, size_t queue_size) {
+    std::lock_guard<std::mutex> lk_async(m_mx_async);
+    StopAsync();
+    if (!async)
+      return;
+    std::unique_lock<std::mutex> lk(m_mx_qu_msg);
+    m_qu_max = queue_size ? queue_size : 1;
+    m_is_async = true;
+    lk.unlock();
+    m_th_async = std::thread(&LogSender::AsyncSending, this);
+  }
+
+  void LogSender::StopAsync() {
+    std::unique_lock<std::mutex> lk(m_mx_qu_msg);
+    m_is_async = false;
+    lk.unlock();
+    m_cv_not_empty.notify_all();
+    if (m_th_async.joinable())
+      m_th_async.join();
+    // messages queued while the thread was stopping are sent here
+    lk.lock();
+    std::deque<LogMessage> qu_remain;
+    qu_remain.swap(m_qu_msg);
+    lk.unlock();
+    for (auto &msg : qu_remain)
+      DoSendLogMessage(msg, std::cout, std::cerr);
+  }
+
+  void LogSender::AsyncSending() {
+    std::unique_lock<std::mutex> lk(m_mx_qu_msg);
+    while (m_is_async || !m_qu_msg.empty()) {
+      m_cv_not_empty.wait(lk, [this] { return !m_is_async || !m_qu_msg.empty(); });
+      std::deque<LogMessage> qu_msg;
+      qu_msg.swap(m_qu_msg);
+      lk.unlock();
+      for (auto &msg : qu_msg)
+        DoSendLogMessage(msg, std::cout, std::cerr);
+      uint64_t n_dropped = m_n_dropped;
+      if (n_dropped != m_n_dropped_reported) {
+        DoSendLogMessage(
+            LogMessage("LogSender: " +
+                           std::to_string(n_dropped - m_n_dropped_reported) +
+                           " log messages dropped, queue is full",
+                       LogMessage::LVL_WARN),
+            std::cout, std::cerr);
+        m_n_dropped_reported = n_dropped;
+      }
+      lk.lock();
+    }
+  }
 
-    SendLogMessage(msg, std::cout, std::cerr);
+  void LogSender::SendLogMessage(const LogMessage &msg) {
+    if (m_is_async) {
+      std::unique_lock<std::mutex> lk(m_mx_qu_msg);
+      if (m_is_async) {
+        if (m_qu_msg.size() >= m_qu_max) {
+          m_n_dropped++;
+          return;
+        }
+        m_qu_msg.push_back(msg);
+        lk.unlock();
+        m_cv_not_empty.notify_one();
+        return;
+      }
+    }
+    DoSendLogMessage(msg, std::cout, std::cerr);
   }
 
   void LogSender::SendLogMessage(const LogMessage &msg, std::ostream &out,
                                  std::ostream &error_out) {
+    DoSendLogMessage(msg, out, error_out);
+  }
+
+  bool LogSender::IsRepeated(const LogMessage &msg, std::ostream &error_out) {
+    uint32_t window = m_repeat_window_ms;
+    if (!window)
+      return false;
+    auto tp_now = std::chrono::steady_clock::now();
+    std::string key = std::to_string(msg.GetLevel()) + msg.GetMessage();
+    if (key == m_last_key &&
+        (tp_now - m_tp_last) < std::chrono::milliseconds(window)) {
+      m_n_repeat++;
+      m_n_suppressed++;
+      return true;
+    }
+    if (m_n_repeat) {
+      if (m_name != "")
+        error_out << "[" << m_name << "] ";
+      error_out << "### last log message repeated " << m_n_repeat
+                << " times ###" << std::endl;
+    }
+    m_last_key = key;
+    m_n_repeat = 0;
+    m_tp_last = tp_now;
+    return false;
+  }
+
+  void LogSender::DoSendLogMessage(const LogMessage &msg, std::ostream &out,
+                                   std::ostream &error_out) {
     std::lock_guard<std::recursive_mutex> lk(m_mutex);
+    if (IsRepeated(msg, error_out))
+      return;
     if (msg.GetLevel() >= m_level) {
       if (msg.GetLevel() >= m_errlevel) {
         if (m_name != "")
@@ -89,7 +201,7 @@ namespace eudaq {
     if (!m_logclient) {
       if (m_shownotconnected)
         error_out << "### Log message triggered but Logger not connected ###\n";
-    } else {
+    } else if (msg.GetLevel() >= m_sendlevel) {
       BufferSerializer ser;
       msg.Serialize(ser);
       try {
@@ -100,15 +212,22 @@ namespace eudaq {
         error_out << " -> will delete LogClient" << std::endl;
         delete m_logclient;
         m_logclient = 0;
+        m_is_sending = false;
+        UpdateThreshold();
       } catch (...) {
         error_out << "Caught exception trying to log message '" << msg << "'! "
                   << std::endl;
         error_out << " -> will delete LogClient" << std::endl;
         delete m_logclient;
         m_logclient = 0;
+        m_is_sending = false;
+        UpdateThreshold();
       }
     }
   }
 
-  LogSender::~LogSender() { delete m_logclient; }
+  LogSender::~LogSender() {
+    StopAsync();
+    delete m_logclient;
+  }
 }
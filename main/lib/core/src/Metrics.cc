@@ -0,0 +1,214 @@
+#include "eudaq/Metrics.hh"
+#include "eudaq/Event.hh"
+#include "eudaq/Exception.hh"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace eudaq {
+
+  namespace{
+    uint32_t MostSignificantBit(uint64_t v){
+#ifdef _MSC_VER
+      unsigned long idx;
+      _BitScanReverse64(&idx, v);
+      return idx;
+#else
+      return 63 - __builtin_clzll(v);
+#endif
+    }
+
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+  }
+
+  LatencyHistogram::LatencyHistogram()
+    :m_sum(0), m_max(0){
+    for(auto &b: m_bucket)
+      b.store(0, std::memory_order_relaxed);
+  }
+
+  uint32_t LatencyHistogram::Index(uint64_t ns){
+    if(ns < (1ull << SUB_BITS))
+      return static_cast<uint32_t>(ns);
+    if(ns >= (1ull << MAX_BITS))
+      ns = (1ull << MAX_BITS) - 1;
+    uint32_t shift = MostSignificantBit(ns) - SUB_BITS;
+    return ((shift + 1) << SUB_BITS) + ((ns >> shift) & ((1u << SUB_BITS) - 1));
+  }
+
+  uint64_t LatencyHistogram::Value(uint32_t idx){
+    if(idx < (1u << SUB_BITS))
+      return idx;
+    uint32_t shift = (idx >> SUB_BITS) - 1;
+    uint64_t low = static_cast<uint64_t>((1u << SUB_BITS) + (idx & ((1u << SUB_BITS) - 1))) << shift;
+    return low + ((1ull << shift) >> 1);
+  }
+
+  void LatencyHistogram::Record(uint64_t ns){
+    m_bucket[Index(ns)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while(ns > max && !m_max.compare_exchange_weak(max, ns, std::memory_order_relaxed));
+  }
+
+  uint64_t LatencyHistogram::Count() const{
+    uint64_t n = 0;
+    for(auto &b: m_bucket)
+      n += b.load(std::memory_order_relaxed);
+    return n;
+  }
+
+  uint64_t LatencyHistogram::Percentile(double q) const{
+    uint64_t n = Count();
+    if(!n)
+      return 0;
+    uint64_t target = static_cast<uint64_t>(q * n + 0.5);
+    if(!target)
+      target = 1;
+    uint64_t acc = 0;
+    for(uint32_t i = 0; i < N_BUCKET; i++){
+      acc += m_bucket[i].load(std::memory_order_relaxed);
+      if(acc >= target)
+	return std::min(Value(i), Max());
+    }
+    return Max();
+  }
+
+  Metrics::Metrics()
+    :m_enabled(false){
+  }
+
+  Metrics& Metrics::Instance(){
+    static Metrics m;
+    return m;
+  }
+
+  MetricCounter& Metrics::Counter(const std::string &name){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    auto &c = m_counters[name];
+    if(!c)
+      c.reset(new MetricCounter);
+    return *c;
+  }
+
+  LatencyHistogram& Metrics::Histogram(const std::string &stage){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    auto &h = m_hists[stage];
+    if(!h)
+      h.reset(new LatencyHistogram);
+    return *h;
+  }
+
+  std::map<std::string, uint64_t> Metrics::StatusCounters(){
+    std::map<std::string, uint64_t> counters;
+    std::unique_lock<std::mutex> lk(m_mtx);
+    for(auto &c: m_counters)
+      counters[c.first] = c.second->Get();
+    return counters;
+  }
+
+  std::map<std::string, std::string> Metrics::StatusTags(){
+    std::map<std::string, std::string> tags;
+    std::unique_lock<std::mutex> lk(m_mtx);
+    for(auto &h: m_hists){
+      if(!h.second->Count())
+	continue;
+      std::ostringstream ss;
+      ss<<std::fixed<<std::setprecision(1)
+	<<h.second->Percentile(0.5)/1e3<<"/"
+	<<h.second->Percentile(0.99)/1e3<<"/"
+	<<h.second->Max()/1e3;
+      tags[h.first+" p50/p99/max [us]"] = ss.str();
+    }
+    return tags;
+  }
+
+  std::string Metrics::Prometheus(const std::string &component){
+    std::string lb = "component=\"" + component + "\"";
+    std::ostringstream ss;
+    std::unique_lock<std::mutex> lk(m_mtx);
+    for(auto &c: m_counters){
+      std::string name = "eudaq_" + c.first + "_total";
+      ss<<"# TYPE "<<name<<" counter\n"
+	<<name<<"{"<<lb<<"} "<<c.second->Get()<<"\n";
+    }
+    if(m_hists.empty())
+      return ss.str();
+    ss<<"# TYPE eudaq_latency_seconds summary\n";
+    for(auto &h: m_hists){
+      std::string lbs = lb + ",stage=\"" + h.first + "\"";
+      for(auto q: quantiles)
+	ss<<"eudaq_latency_seconds{"<<lbs<<",quantile=\""<<q<<"\"} "
+	  <<h.second->Percentile(q)/1e9<<"\n";
+      ss<<"eudaq_latency_seconds_sum{"<<lbs<<"} "<<h.second->Sum()/1e9<<"\n"
+	<<"eudaq_latency_seconds_count{"<<lbs<<"} "<<h.second->Count()<<"\n";
+    }
+    ss<<"# TYPE eudaq_latency_max_seconds gauge\n";
+    for(auto &h: m_hists)
+      ss<<"eudaq_latency_max_seconds{"<<lb<<",stage=\""<<h.first<<"\"} "
+	<<h.second->Max()/1e9<<"\n";
+    return ss.str();
+  }
+
+  void Metrics::WritePrometheus(const std::string &path, const std::string &component){
+    // write aside and rename, so that a scraper never reads a partial file
+    std::string tmp = path + ".tmp";
+    {
+      std::ofstream out(tmp);
+      if(!out)
+	EUDAQ_THROW("Metrics: unable to write " + tmp);
+      out<<Prometheus(component);
+    }
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    if(std::rename(tmp.c_str(), path.c_str()))
+      EUDAQ_THROW("Metrics: unable to rename " + tmp + " to " + path);
+  }
+
+  const std::string& Metrics::HostName(){
+    static const std::string host = [](){
+#ifdef _WIN32
+      const char *env = std::getenv("COMPUTERNAME");
+      return std::string(env ? env : "");
+#else
+      char buf[256] = {0};
+      gethostname(buf, sizeof(buf) - 1);
+      return std::string(buf);
+#endif
+    }();
+    return host;
+  }
+
+  void Metrics::StampSend(Event &ev){
+    ev.SetTag("EUDAQ_SEND_NS", std::to_string(NowNs()) + "@" + HostName());
+  }
+
+  bool Metrics::TakeSendStamp(Event &ev, uint64_t &since_ns){
+    std::string ts = ev.GetTag("EUDAQ_SEND_NS");
+    if(ts.empty())
+      return false;
+    // never written to the files
+    ev.RemoveTag("EUDAQ_SEND_NS");
+    size_t i = ts.find('@');
+    // the monotonic clocks of different hosts are not comparable
+    if(i == std::string::npos || ts.substr(i + 1) != HostName())
+      return false;
+    uint64_t now = NowNs();
+    uint64_t send = std::strtoull(ts.substr(0, i).c_str(), nullptr, 10);
+    if(!send || now < send)
+      return false;
+    since_ns = now - send;
+    return true;
+  }
+}
@@ -127,7 +127,7 @@ namespace eudaq {
   }
     
   void Monitor::OnStatus(){
-    SetStatusTag("EventN", std::to_string(m_evt_c));
+    SetStatusCounter("EventN", m_evt_c);
     DoStatus();
     CommandReceiver::OnStatus();
   }
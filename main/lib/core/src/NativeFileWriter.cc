@@ -1,16 +1,48 @@
 #include "eudaq/FileNamer.hh"
 #include "eudaq/FileWriter.hh"
 #include "eudaq/FileSerializer.hh"
+#include "eudaq/Logger.hh"
 
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <future>
+
+// Without a limit, one file per run. With EUDAQ_FW_MAX_MB, EUDAQ_FW_MAX_EVENTS
+// or EUDAQ_FW_MAX_SECONDS a run is split into parts, numbered through $N of
+// the pattern (or _$3N inserted before the extension). The name of each
+// completed part is appended to the list file (the pattern without the part
+// number and the extension .list), which the FileReader "list" reads as one
+// run. Parts are closed in the background, the last one before the writer is
+// destroyed, and EUDAQ_FW_CLOSE_CMD, if set, is run on each closed file with
+// its path as last argument.
 class NativeFileWriter : public eudaq::FileWriter {
 public:
   NativeFileWriter(const std::string &patt);
+  ~NativeFileWriter() override;
   void WriteEvent(eudaq::EventSPC ev) override;
   uint64_t FileBytes() const override;
 private:
+  void Open(uint32_t run_n, uint32_t part_n);
+  void Close();
+  bool IsFull() const;
+
   std::unique_ptr<eudaq::FileSerializer> m_ser;
   std::string m_filepattern;
+  std::string m_partpattern;
+  std::string m_path;
+  std::string m_list_path;
   uint32_t m_run_n;
+  uint32_t m_part_n;
+  bool m_conf_read;
+  uint64_t m_max_bytes;
+  uint64_t m_max_events;
+  uint64_t m_max_seconds;
+  std::string m_close_cmd;
+  uint64_t m_part_events;
+  std::chrono::steady_clock::time_point m_part_start;
+  std::shared_future<void> m_closing;
 };
 
 namespace{
@@ -20,31 +52,124 @@ namespace{
     Register<NativeFileWriter, std::string&&>(eudaq::cstr2hash("native"));
 }
 
-NativeFileWriter::NativeFileWriter(const std::string &patt){
-  m_filepattern = patt;
+NativeFileWriter::NativeFileWriter(const std::string &patt)
+  :m_filepattern(patt), m_run_n(0), m_part_n(0), m_conf_read(false), m_max_bytes(0),
+   m_max_events(0), m_max_seconds(0), m_part_events(0){
+}
+
+NativeFileWriter::~NativeFileWriter(){
+  try{
+    Close();
+  }catch(const std::exception &e){
+    EUDAQ_ERROR(std::string("NativeFileWriter: ") + e.what());
+  }
+  // the file is complete once the writer is released
+  if(m_closing.valid())
+    m_closing.wait();
+}
+
+void NativeFileWriter::Open(uint32_t run_n, uint32_t part_n){
+  if(!m_conf_read){
+    auto conf = GetConfiguration();
+    if(conf){
+      m_max_bytes = conf->Get("EUDAQ_FW_MAX_MB", uint64_t(0)) << 20;
+      m_max_events = conf->Get("EUDAQ_FW_MAX_EVENTS", uint64_t(0));
+      m_max_seconds = conf->Get("EUDAQ_FW_MAX_SECONDS", uint64_t(0));
+      m_close_cmd = conf->Get("EUDAQ_FW_CLOSE_CMD", "");
+    }
+    m_partpattern = m_filepattern;
+    bool rotate = m_max_bytes || m_max_events || m_max_seconds;
+    if(rotate && std::string(eudaq::FileNamer(m_filepattern).Set('N', 1)) ==
+       std::string(eudaq::FileNamer(m_filepattern).Set('N', 2))){
+      size_t i = m_partpattern.rfind("$X");
+      m_partpattern.insert(i == std::string::npos ? m_partpattern.size() : i, "_$3N");
+    }
+    if(!rotate)
+      m_partpattern.clear();
+    m_conf_read = true;
+  }
+
+  std::time_t time_now = std::time(nullptr);
+  char time_buff[13];
+  time_buff[12] = 0;
+  std::strftime(time_buff, sizeof(time_buff),
+		"%y%m%d%H%M%S", std::localtime(&time_now));
+  std::string time_str(time_buff);
+  if(m_partpattern.empty())
+    m_path = eudaq::FileNamer(m_filepattern).Set('X', ".raw").Set('R', run_n).Set('D', time_str);
+  else{
+    m_path = eudaq::FileNamer(m_partpattern).Set('X', ".raw").Set('R', run_n).Set('D', time_str).Set('N', part_n);
+    if(!part_n){
+      m_list_path = eudaq::FileNamer(m_filepattern).Set('X', ".list").Set('R', run_n).Set('D', time_str);
+      std::ofstream(m_list_path, std::ios::trunc);
+    }
+  }
+  m_ser.reset(new eudaq::FileSerializer(m_path));
+  m_run_n = run_n;
+  m_part_n = part_n;
+  m_part_events = 0;
+  m_part_start = std::chrono::steady_clock::now();
 }
-  
+
+void NativeFileWriter::Close(){
+  if(!m_ser)
+    return;
+  if(m_partpattern.empty() && m_close_cmd.empty()){
+    m_ser.reset();
+    return;
+  }
+  std::shared_ptr<eudaq::FileSerializer> ser(std::move(m_ser));
+  std::string path = m_path;
+  std::string list_path = m_partpattern.empty() ? "" : m_list_path;
+  std::string cmd = m_close_cmd;
+  auto prev = m_closing;
+  // one after the other, so that the list keeps the order of the parts
+  m_closing = std::async(std::launch::async, [ser, path, list_path, cmd, prev]() mutable {
+      // release the previous task, or every completed one stays chained to the next
+      if(prev.valid()){
+	prev.wait();
+	prev = std::shared_future<void>();
+      }
+      ser.reset();
+      if(!list_path.empty()){
+	std::ofstream list(list_path, std::ios::app);
+	list<<path.substr(path.find_last_of("/\\") + 1)<<"\n";
+	if(!list)
+	  EUDAQ_WARN("NativeFileWriter: unable to append to " + list_path);
+      }
+      if(!cmd.empty()){
+	int ret = std::system((cmd + " \"" + path + "\"").c_str());
+	if(ret != 0)
+	  EUDAQ_WARN("NativeFileWriter: '" + cmd + "' failed on " + path + " (" + std::to_string(ret) + ")");
+      }
+    }).share();
+}
+
+bool NativeFileWriter::IsFull() const {
+  if(m_partpattern.empty() || !m_part_events)
+    return false;
+  return (m_max_bytes && m_ser->FileBytes() >= m_max_bytes) ||
+    (m_max_events && m_part_events >= m_max_events) ||
+    (m_max_seconds && std::chrono::steady_clock::now() - m_part_start >= std::chrono::seconds(m_max_seconds));
+}
+
 void NativeFileWriter::WriteEvent(eudaq::EventSPC ev) {
   uint32_t run_n = ev->GetRunN();
   if(!m_ser || m_run_n != run_n){
-    std::time_t time_now = std::time(nullptr);
-    char time_buff[13];
-    time_buff[12] = 0;
-    std::strftime(time_buff, sizeof(time_buff),
-		  "%y%m%d%H%M%S", std::localtime(&time_now));
-    std::string time_str(time_buff);
-    m_ser.reset(new eudaq::FileSerializer((eudaq::FileNamer(m_filepattern).
-					   Set('X', ".raw").
-					   Set('R', run_n).
-					   Set('D', time_str))));
-    m_run_n = run_n;
+    Close();
+    Open(run_n, 0);
+  }
+  else if(IsFull()){
+    Close();
+    Open(run_n, m_part_n + 1);
   }
   if(!m_ser)
     EUDAQ_THROW("NativeFileWriter: Attempt to write unopened file");
   m_ser->write(*(ev.get())); //TODO: Serializer accepts EventSPC
   m_ser->Flush();
+  m_part_events++;
 }
-  
+
 uint64_t NativeFileWriter::FileBytes() const {
   return m_ser ?m_ser->FileBytes() :0;
 }
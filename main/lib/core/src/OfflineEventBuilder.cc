@@ -0,0 +1,169 @@
+#include "eudaq/OfflineEventBuilder.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/Logger.hh"
+
+#include <algorithm>
+#include <functional>
+
+namespace eudaq {
+  OfflineEventBuilder::OfflineEventBuilder(const std::vector<std::string> &paths, Mode mode)
+    :m_mode(mode), m_window(0), m_require_all(false), m_queue_size(1024), m_started(false),
+     m_exit(false), m_run_n(0), m_ev_n(0), m_n_built(0), m_n_dropped(0), m_n_unordered(0){
+    if(paths.empty())
+      EUDAQ_THROW("OfflineEventBuilder: no input file");
+    for(auto &path: paths){
+      m_inputs.emplace_back(new Input);
+      m_inputs.back()->path = path;
+    }
+  }
+
+  OfflineEventBuilder::~OfflineEventBuilder(){
+    m_exit = true;
+    for(auto &in: m_inputs){
+      {
+	std::lock_guard<std::mutex> lk(in->mtx);
+      }
+      in->cv.notify_all();
+      if(in->th.joinable())
+	in->th.join();
+    }
+  }
+
+  void OfflineEventBuilder::Start(){
+    for(auto &in: m_inputs)
+      in->th = std::thread(&OfflineEventBuilder::Reading, this, std::ref(*in));
+    for(auto &in: m_inputs)
+      Advance(*in);
+    m_started = true;
+  }
+
+  void OfflineEventBuilder::Reading(Input &in){
+    try{
+      std::string type = in.path.substr(in.path.find_last_of('.') + 1);
+      if(type == "raw")
+	type = "native";
+      auto reader = Factory<FileReader>::MakeUnique(str2hash(type), in.path);
+      if(!reader)
+	EUDAQ_THROW("OfflineEventBuilder: no FileReader for " + in.path);
+      while(!m_exit){
+	auto ev = reader->GetNextEvent();
+	if(!ev)
+	  break;
+	std::unique_lock<std::mutex> lk(in.mtx);
+	in.cv.wait(lk, [&](){return m_exit || in.que.size() < m_queue_size;});
+	in.que.push_back(ev);
+	lk.unlock();
+	in.cv.notify_all();
+      }
+    }
+    catch(const std::exception &e){
+      EUDAQ_ERROR("OfflineEventBuilder: reading " + in.path + ": " + e.what());
+    }
+    std::lock_guard<std::mutex> lk(in.mtx);
+    in.done = true;
+    in.cv.notify_all();
+  }
+
+  bool OfflineEventBuilder::Advance(Input &in){
+    while(true){
+      std::unique_lock<std::mutex> lk(in.mtx);
+      in.cv.wait(lk, [&](){return in.done || !in.que.empty();});
+      if(in.que.empty()){
+	in.front.reset();
+	return false;
+      }
+      in.front = in.que.front();
+      in.que.pop_front();
+      lk.unlock();
+      in.cv.notify_all();
+      if(Key(in.front) >= in.last_key)
+	return true;
+      m_n_unordered++;
+      if(!in.warned){
+	EUDAQ_WARN("OfflineEventBuilder: events out of order in " + in.path + " are dropped");
+	in.warned = true;
+      }
+    }
+  }
+
+  uint64_t OfflineEventBuilder::Key(const EventSPC &ev) const {
+    if(m_mode == SEQUENCE){
+      // the producer's event number, kept by the collector, or of its event within a packet
+      auto e = ev;
+      if(!e->HasTag("EUDAQ_SHARD_SEQ") && e->GetNumSubEvent())
+	e = e->GetSubEvent(0);
+      return e->GetTag("EUDAQ_SHARD_SEQ", uint64_t(e->GetEventN()));
+    }
+    return m_mode == TRIGGER_N ? ev->GetTriggerN() : ev->GetTimestampBegin();
+  }
+
+  EventSP OfflineEventBuilder::GetNextEvent(){
+    if(!m_started)
+      Start();
+    while(true){
+      bool any = false;
+      uint64_t key = UINT64_MAX;
+      for(auto &in: m_inputs)
+	if(in->front){
+	  any = true;
+	  key = std::min(key, Key(in->front));
+	}
+      if(!any)
+	return nullptr;
+
+      if(m_mode == SEQUENCE){
+	EventSP ev;
+	for(auto &in: m_inputs){
+	  if(!in->front || Key(in->front) != key)
+	    continue;
+	  in->last_key = key;
+	  if(!ev){
+	    // the builder holds the only reference
+	    ev = std::const_pointer_cast<Event>(in->front);
+	    if(ev->HasTag("EUDAQ_SHARD_SEQ"))
+	      ev->SetEventN(static_cast<uint32_t>(key));
+	  }
+	  Advance(*in);
+	}
+	m_n_built++;
+	return ev;
+      }
+
+      auto ev = Event::MakeShared(m_mode == TRIGGER_N ? "TriggerIDSyncOffline" : "TimestampSyncOffline");
+      ev->SetFlagPacket();
+      uint64_t ts_beg = UINT64_MAX;
+      uint64_t ts_end = 0;
+      size_t n_in = 0;
+      for(auto &in: m_inputs){
+	bool found = false;
+	// one event per input and trigger number, all the events of an input within the window
+	while(in->front && (m_mode == TRIGGER_N ? Key(in->front) == key : Key(in->front) <= key + m_window)){
+	  if(!m_run_n)
+	    m_run_n = in->front->GetRunN();
+	  ts_beg = std::min(ts_beg, in->front->GetTimestampBegin());
+	  ts_end = std::max(ts_end, in->front->GetTimestampEnd());
+	  ev->AddSubEvent(in->front);
+	  in->last_key = Key(in->front);
+	  found = true;
+	  Advance(*in);
+	  if(m_mode == TRIGGER_N)
+	    break;
+	}
+	if(found)
+	  n_in++;
+      }
+      if(m_require_all && n_in < m_inputs.size()){
+	m_n_dropped++;
+	continue;
+      }
+      if(m_mode == TRIGGER_N)
+	ev->SetTriggerN(static_cast<uint32_t>(key));
+      else
+	ev->SetTimestamp(ts_beg, ts_end);
+      ev->SetRunN(m_run_n);
+      ev->SetEventN(m_ev_n++);
+      m_n_built++;
+      return ev;
+    }
+  }
+}
@@ -1,17 +1,47 @@
 #include "Processor.hh"
+#include "ProcessorPool.hh"
+#include "Logger.hh"
 #include "Utils.hh"
 
+#include <algorithm>
+#include <cstdlib>
+
 using namespace eudaq;
 
 template DLLEXPORT
 std::map<uint32_t, typename Factory<Processor>::UP_BASE (*)()>& Factory<Processor>::Instance<>();
 
+namespace{
+  std::atomic<int>& DefaultScheduler(){
+    static std::atomic<int> sched([](){
+	char *env = std::getenv("EUDAQ_PROC_SCHEDULER");
+	bool pool = env && (std::string(env) == "pool" || std::string(env) == "POOL");
+	return pool ? Processor::SCHED_POOL : Processor::SCHED_THREAD;
+      }());
+    return sched;
+  }
+
+  // the pool mode processor whose batch runs on this thread, and its output
+  thread_local Processor *t_batch_ps = nullptr;
+  thread_local std::vector<EventSPC> *t_batch_out = nullptr;
+}
+
+void Processor::SetDefaultScheduler(Scheduler sched){
+  DefaultScheduler() = sched;
+}
+
+Processor::Scheduler Processor::GetDefaultScheduler(){
+  return static_cast<Scheduler>(DefaultScheduler().load());
+}
+
 ProcessorSP Processor::MakeShared(const std::string& pstype,
 				  std::initializer_list
 				  <std::pair<const std::string, const std::string>> l){
   ProcessorSP ps = Factory<Processor>::MakeShared(str2hash(pstype));
-  ps->m_th_hub = std::thread(&Processor::HubProcessing, ps.get());
-  ps->m_ps_hub = ps;
+  if(!ps->m_sched_pool){
+    ps->m_th_hub = std::thread(&Processor::HubProcessing, ps.get());
+    ps->m_ps_hub = ps;
+  }
   for(auto &p: l){
     ps->ProcessSysCommand(p.first, p.second);
   }
@@ -20,7 +50,9 @@ ProcessorSP Processor::MakeShared(const std::string& pstype,
 
 
 Processor::Processor(const std::string& dsp)
-  :m_description(dsp), m_csm_go_stop(0), m_hub_go_stop(0), m_hub_force(0){
+  :m_description(dsp), m_csm_go_stop(0), m_hub_go_stop(0), m_hub_force(0),
+   m_sched_pool(GetDefaultScheduler() == SCHED_POOL), m_stateless(false), m_batch_n(64),
+   m_pool_running(0), m_seq_take(0), m_seq_commit(0){
   m_instance_n = static_cast<uint32_t>(reinterpret_cast<uint64_t>(this));
 }
 
@@ -55,6 +87,11 @@ void Processor::Processing(EventSPC ev){
 
 
 void Processor::ForwardEvent(EventSPC ev) {
+  if(t_batch_ps == this){
+    // forwarded together with the rest of the batch
+    t_batch_out->push_back(ev);
+    return;
+  }
   std::lock_guard<std::mutex> lk(m_mtx_output);
   uint32_t evid = ev->GetEventID();
   for(auto &psev: m_ps_downstream){
@@ -66,11 +103,122 @@ void Processor::ForwardEvent(EventSPC ev) {
 }
 
 void Processor::RegisterEvent(EventSPC ev){
+  if(m_sched_pool){
+    std::unique_lock<std::mutex> lk(m_mtx_pool);
+    m_que_pool.push_back(ev);
+    PoolSchedule(lk);
+    return;
+  }
   std::lock_guard<std::mutex> lk(m_mtx_input);
   auto ps_hub = m_ps_hub.lock();
   ps_hub->RegisterProcessing(shared_from_this(), ev);
 }
 
+void Processor::RegisterEvents(const std::vector<EventSPC> &evs){
+  if(!m_sched_pool){
+    for(auto &ev: evs)
+      RegisterEvent(ev);
+    return;
+  }
+  std::unique_lock<std::mutex> lk(m_mtx_pool);
+  m_que_pool.insert(m_que_pool.end(), evs.begin(), evs.end());
+  PoolSchedule(lk);
+}
+
+void Processor::PoolSchedule(std::unique_lock<std::mutex> &lk){
+  // an ordered processor has at most one task, a stateless one up to a task per worker
+  uint32_t n_max = m_stateless ? ProcessorPool::Instance().GetNumThreads() : 1;
+  size_t n_batch = (m_que_pool.size() + m_batch_n - 1) / m_batch_n;
+  uint32_t n_new = 0;
+  while(m_pool_running < n_max && n_new < n_batch){
+    m_pool_running++;
+    n_new++;
+  }
+  lk.unlock();
+  if(!n_new)
+    return;
+  auto self = shared_from_this();
+  for(uint32_t i = 0; i < n_new; i++)
+    ProcessorPool::Instance().Submit([self](){self->PoolProcessing();});
+}
+
+void Processor::PoolProcessing(){
+  std::vector<EventSPC> batch;
+  uint64_t seq;
+  {
+    std::lock_guard<std::mutex> lk(m_mtx_pool);
+    size_t n = std::min<size_t>(m_batch_n, m_que_pool.size());
+    batch.assign(m_que_pool.begin(), m_que_pool.begin() + n);
+    m_que_pool.erase(m_que_pool.begin(), m_que_pool.begin() + n);
+    seq = m_seq_take++;
+  }
+  std::vector<EventSPC> out;
+  t_batch_ps = this;
+  t_batch_out = &out;
+  for(auto &ev: batch){
+    try{
+      ProcessEvent(ev);
+    }
+    catch(const std::exception &e){
+      EUDAQ_ERROR(m_description + ": exception in ProcessEvent: " + e.what());
+    }
+    catch(...){
+      EUDAQ_ERROR(m_description + ": unknown exception in ProcessEvent");
+    }
+  }
+  t_batch_ps = nullptr;
+  t_batch_out = nullptr;
+  PoolCommit(seq, out);
+  std::unique_lock<std::mutex> lk(m_mtx_pool);
+  m_pool_running--;
+  PoolSchedule(lk);
+}
+
+void Processor::PoolCommit(uint64_t seq, std::vector<EventSPC> &out){
+  std::lock_guard<std::mutex> lk(m_mtx_commit);
+  if(seq != m_seq_commit){
+    // a batch taken earlier is still in progress
+    m_out_pending[seq].swap(out);
+    return;
+  }
+  // every sequence number is committed, else all later batches stall
+  auto deliver = [this](const std::vector<EventSPC> &evs){
+    try{
+      DeliverEvents(evs);
+    }
+    catch(const std::exception &e){
+      EUDAQ_ERROR(m_description + ": exception in delivering events: " + e.what());
+    }
+    catch(...){
+      EUDAQ_ERROR(m_description + ": unknown exception in delivering events");
+    }
+  };
+  deliver(out);
+  m_seq_commit++;
+  auto it = m_out_pending.begin();
+  while(it != m_out_pending.end() && it->first == m_seq_commit){
+    deliver(it->second);
+    m_seq_commit++;
+    it = m_out_pending.erase(it);
+  }
+}
+
+void Processor::DeliverEvents(const std::vector<EventSPC> &evs){
+  if(evs.empty())
+    return;
+  std::lock_guard<std::mutex> lk(m_mtx_output);
+  std::vector<EventSPC> sel;
+  for(auto &psev: m_ps_downstream){
+    auto &evset = psev.second;
+    sel.clear();
+    for(auto &ev: evs)
+      if(evset.find(ev->GetEventID()) != evset.end())
+	sel.push_back(ev);
+    if(!sel.empty())
+      psev.first->RegisterEvents(sel);
+  }
+}
+
 void Processor::RegisterDownstream(ProcessorSP ps, const std::set<uint32_t>& evset){
   std::lock_guard<std::mutex> lk(m_mtx_output);
   auto evs = evset;
@@ -103,6 +251,9 @@ void Processor::RegisterUpstream(ProcessorSP up, ProcessorWP hub){
   if(!found)
     m_ps_upstream.push_back(up);
 
+  //pool scheduler, no hub in this processor or in the upstream one
+  if(m_sched_pool || !hub.lock())
+    return;
   //same
   if(m_ps_hub.lock() == hub.lock())
     return;
@@ -243,6 +394,14 @@ void Processor::ProcessSysCommand(const std::string& cmd, const std::string& arg
     m_ev_out_default.erase(str2hash(arg));
     break;
   }
+  case cstr2hash("SYS:STATELESS"):{
+    m_stateless = arg.empty() || arg != "0";
+    break;
+  }
+  case cstr2hash("SYS:BATCH"):{
+    m_batch_n = std::max<uint32_t>(1, std::stoul(arg));
+    break;
+  }
   case cstr2hash("SYS:PSID"):{
     m_instance_n = std::stoul(arg);
     break;
@@ -258,7 +417,10 @@ void Processor::Print(std::ostream &os, uint32_t offset) const{
   os << std::string(offset, ' ') << "<Processor>\n";
   os << std::string(offset + 2, ' ') << "<Description> " << m_description <<" </Description>\n";
   os << std::string(offset + 2, ' ') << "<InstanceN> " << m_instance_n << " </InstanceN>\n";
-  os << std::string(offset + 2, ' ') << "<HubInstanceN> " << m_ps_hub.lock()->m_instance_n << " </HubInstanceN>\n";
+  if(auto hub = m_ps_hub.lock())
+    os << std::string(offset + 2, ' ') << "<HubInstanceN> " << hub->m_instance_n << " </HubInstanceN>\n";
+  else
+    os << std::string(offset + 2, ' ') << "<Scheduler> pool" << (m_stateless ? ", stateless" : "") << " </Scheduler>\n";
   if(!m_ps_upstream.empty()){
     os << std::string(offset + 2, ' ') << "<Upstreams> \n";
     for (auto &pswp: m_ps_upstream){
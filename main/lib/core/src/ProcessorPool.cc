@@ -0,0 +1,105 @@
+#include "ProcessorPool.hh"
+#include "Logger.hh"
+
+#include <cstdlib>
+#include <string>
+
+using namespace eudaq;
+
+namespace{
+  // the pool and index of the worker running on this thread
+  thread_local ProcessorPool *t_pool = nullptr;
+  thread_local uint32_t t_worker_n = 0;
+}
+
+ProcessorPool& ProcessorPool::Instance(){
+  static ProcessorPool pool([](){
+      char *env = std::getenv("EUDAQ_PROC_THREADS");
+      return env ? static_cast<uint32_t>(std::stoul(env)) : 0u;
+    }());
+  return pool;
+}
+
+ProcessorPool::ProcessorPool(uint32_t n_thread)
+  :m_n_task(0), m_n_next(0), m_exit(false){
+  if(!n_thread)
+    n_thread = std::thread::hardware_concurrency();
+  if(!n_thread)
+    n_thread = 4;
+  for(uint32_t i = 0; i < n_thread; i++)
+    m_workers.emplace_back(new Worker);
+  for(uint32_t i = 0; i < n_thread; i++)
+    m_threads.emplace_back(&ProcessorPool::Working, this, i);
+}
+
+ProcessorPool::~ProcessorPool(){
+  {
+    std::lock_guard<std::mutex> lk(m_mtx_idle);
+    m_exit = true;
+  }
+  m_cv_idle.notify_all();
+  for(auto &th: m_threads)
+    th.join();
+}
+
+void ProcessorPool::Submit(Task t){
+  uint32_t n = (t_pool == this) ? t_worker_n : m_n_next++ % m_workers.size();
+  {
+    std::lock_guard<std::mutex> lk(m_workers[n]->mtx);
+    m_workers[n]->que.push_back(std::move(t));
+  }
+  {
+    std::lock_guard<std::mutex> lk(m_mtx_idle);
+    m_n_task++;
+  }
+  m_cv_idle.notify_one();
+}
+
+bool ProcessorPool::PopTask(uint32_t n, Task &t){
+  {
+    auto &w = *m_workers[n];
+    std::lock_guard<std::mutex> lk(w.mtx);
+    if(!w.que.empty()){
+      t = std::move(w.que.back());
+      w.que.pop_back();
+      m_n_task--;
+      return true;
+    }
+  }
+  for(size_t i = 1; i < m_workers.size(); i++){
+    auto &w = *m_workers[(n + i) % m_workers.size()];
+    std::lock_guard<std::mutex> lk(w.mtx);
+    if(!w.que.empty()){
+      t = std::move(w.que.front());
+      w.que.pop_front();
+      m_n_task--;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ProcessorPool::Working(uint32_t n){
+  t_pool = this;
+  t_worker_n = n;
+  Task t;
+  while(true){
+    if(PopTask(n, t)){
+      try{
+	t();
+      }
+      catch(const std::exception &e){
+	EUDAQ_ERROR(std::string("ProcessorPool: uncaught exception in a task: ") + e.what());
+      }
+      catch(...){
+	EUDAQ_ERROR("ProcessorPool: uncaught unrecognised exception in a task");
+      }
+      t = nullptr;
+      continue;
+    }
+    std::unique_lock<std::mutex> lk(m_mtx_idle);
+    if(m_exit)
+      break;
+    m_cv_idle.wait(lk, [this](){return m_exit || m_n_task > 0;});
+  }
+}
@@ -1,5 +1,8 @@
 #include "eudaq/TransportClient.hh"
 #include "eudaq/Producer.hh"
+#include "eudaq/Metrics.hh"
+#include <sstream>
+#include <iomanip>
 
 namespace eudaq {
 
@@ -12,6 +15,10 @@ namespace eudaq {
     : CommandReceiver("Producer", name, runcontrol){
     m_evt_c = 0;
     m_pdc_n = str2hash(GetFullName());
+    m_shard = SHARD_NONE;
+    m_shard_slice = 1000000;
+    m_shard_rr = 0;
+    m_shard_no_trg = 0;
   }
 
   void Producer::OnInitialise(){
@@ -60,24 +67,43 @@ namespace eudaq {
       if(!IsStatus(Status::STATE_CONF) && !IsStatus(Status::STATE_STOPPED))
 	EUDAQ_THROW("OnStartRun can not be called unless in STATE_CONF");
       std::map<std::string, std::shared_ptr<DataSender>> senders;
+      std::vector<std::shared_ptr<DataSender>> shards;
       std::string dc_str = GetConfiguration()->Get("EUDAQ_DC", "");
+      Codec codec = CodecFromName(GetConfiguration()->Get("EUDAQ_DATA_CODEC", "none"));
+      int codec_level = GetConfiguration()->Get("EUDAQ_DATA_CODEC_LEVEL", 0);
+      std::string shard_str = GetConfiguration()->Get("EUDAQ_DC_SHARD", "none");
+      ShardPolicy shard = ShardPolicyFromName(shard_str);
+      uint64_t shard_slice = GetConfiguration()->Get("EUDAQ_DC_SHARD_SLICE", uint64_t(1000000));
+      if(!shard_slice)
+	EUDAQ_THROW("EUDAQ_DC_SHARD_SLICE has to be larger than 0");
       std::vector<std::string> col_dc_name = split(dc_str, ";,", true);
       std::string cur_backup = GetConfiguration()->GetCurrentSectionName();
       GetConfiguration()->SetSection("");
       for(auto &dc_name: col_dc_name){
 	std::string dc_addr =  GetConfiguration()->Get("DataCollector."+dc_name, "");
-	if(!dc_addr.empty()){
+	if(!dc_addr.empty() && !senders.count(dc_addr)){
 	  senders[dc_addr]
 	    = std::unique_ptr<DataSender>(new DataSender("Producer", GetName()));
+	  senders[dc_addr]->SetCompression(codec, codec_level);
 	  senders[dc_addr]->Connect(dc_addr);
+	  shards.push_back(senders[dc_addr]);
 	}
       }
       GetConfiguration()->SetSection(cur_backup);
+      if(shard != SHARD_NONE && shards.size() < 2){
+	EUDAQ_WARN(GetFullName() + ": EUDAQ_DC_SHARD needs more than one DataCollector, sending to all");
+	shard = SHARD_NONE;
+      }
       std::unique_lock<std::mutex> lk(m_mtx_sender);
       m_senders = senders;
+      m_shards = shards;
+      m_shard = shard;
+      m_shard_slice = shard_slice;
+      m_shard_rr = 0;
+      m_shard_no_trg = 0;
       lk.unlock();
       m_evt_c = 0;
-      SetStatusTag("EventN", "0");
+      SetStatusCounter("EventN", 0);
       DoStartRun();
       CommandReceiver::OnStartRun();
     }catch (const std::exception &e) {
@@ -98,6 +124,7 @@ namespace eudaq {
       CommandReceiver::OnStopRun();
       std::unique_lock<std::mutex> lk(m_mtx_sender);
       m_senders.clear();
+      m_shards.clear();
     } catch (const std::exception &e) {
       printf("Caught exception: %s\n", e.what());
       SetStatus(Status::STATE_ERROR, "Stop Error");
@@ -114,6 +141,7 @@ namespace eudaq {
       CommandReceiver::OnReset();
       std::unique_lock<std::mutex> lk(m_mtx_sender);
       m_senders.clear();
+      m_shards.clear();
     } catch (const std::exception &e) {
       printf("Producer Reset:: Caught exception: %s\n", e.what());
       SetStatus(Status::STATE_ERROR, "Reset Error");
@@ -139,7 +167,19 @@ namespace eudaq {
 
   void Producer::OnStatus(){
     try{
-      SetStatusTag("EventN", std::to_string(m_evt_c));
+      SetStatusCounter("EventN", m_evt_c);
+      uint64_t raw = 0, sent = 0;
+      std::unique_lock<std::mutex> lk(m_mtx_sender);
+      for(auto &e: m_senders){
+	raw += e.second->GetRawBytes();
+	sent += e.second->GetSentBytes();
+      }
+      lk.unlock();
+      if(sent){
+	std::ostringstream ss;
+	ss<<std::fixed<<std::setprecision(2)<<double(raw)/sent;
+	SetStatusTag("CompressionRatio", ss.str());
+      }
       DoStatus();
     }catch (const std::exception &e) {
       printf("Caught exception: %s\n", e.what());
@@ -161,17 +201,75 @@ namespace eudaq {
     ev->SetEventN(m_evt_c);
     m_evt_c ++;
     ev->SetDeviceN(m_pdc_n);
+    static auto &metrics = Metrics::Instance();
+    static auto &h_send = metrics.Histogram("send");
+    static auto &c_sent = metrics.Counter("events_sent");
+    bool timed = metrics.IsEnabled();
+    uint64_t t0 = 0;
+    if(timed){
+      Metrics::StampSend(*ev);
+      t0 = Metrics::NowNs();
+    }
     std::unique_lock<std::mutex> lk(m_mtx_sender);
-    auto senders = m_senders; //hold on the ptrs
-    lk.unlock();
-    for(auto &e: senders){
-      if(e.second)
-	e.second->SendEvent(ev);
-      else
-	EUDAQ_THROW("Producer::SendEvent, using a null pointer of DataSender");
+    size_t i = m_shards.size();
+    if(m_shard != SHARD_NONE){
+      i = ShardRoute(*ev, m_shard, m_shards.size(), m_shard_slice, m_shard_rr);
+      if(m_shard == SHARD_TRIGGER && i < m_shards.size() && m_shard_no_trg < 1000){
+	if(ev->GetTriggerN())
+	  m_shard_no_trg = 1000;
+	else if(++m_shard_no_trg == 1000)
+	  EUDAQ_WARN(GetFullName() + ": EUDAQ_DC_SHARD = trigger, but the events carry no trigger number, "
+		     "all of them go to one DataCollector");
+      }
+    }
+    if(i < m_shards.size()){
+      auto sender = m_shards[i];
+      lk.unlock();
+      sender->SendEvent(ev);
     }
+    else{
+      auto senders = m_senders; //hold on the ptrs
+      lk.unlock();
+      for(auto &e: senders){
+	if(e.second)
+	  e.second->SendEvent(ev);
+	else
+	  EUDAQ_THROW("Producer::SendEvent, using a null pointer of DataSender");
+      }
+    }
+    c_sent.Add();
+    if(timed)
+      h_send.Record(Metrics::NowNs() - t0);
   }
   
+  Producer::ShardPolicy Producer::ShardPolicyFromName(const std::string &name){
+    if(name == "none")
+      return SHARD_NONE;
+    if(name == "roundrobin")
+      return SHARD_ROUNDROBIN;
+    if(name == "trigger")
+      return SHARD_TRIGGER;
+    if(name == "time")
+      return SHARD_TIME;
+    EUDAQ_THROW("Unknown EUDAQ_DC_SHARD '" + name + "' (none, roundrobin, trigger or time)");
+  }
+
+  size_t Producer::ShardRoute(Event &ev, ShardPolicy policy, size_t n,
+			      uint64_t slice, uint64_t &rr){
+    // the collectors number the events they write, the tag keeps the global order
+    ev.SetTag("EUDAQ_SHARD_SEQ", std::to_string(ev.GetEventN()));
+    // each event to a single collector, the BORE and EORE to all of them
+    if(ev.IsBORE() || ev.IsEORE() || policy == SHARD_NONE){
+      ev.SetTag("EUDAQ_SHARD", std::to_string(n));
+      return n;
+    }
+    if(policy == SHARD_ROUNDROBIN)
+      return rr++ % n;
+    if(policy == SHARD_TRIGGER)
+      return ev.GetTriggerN() % n;
+    return ev.GetTimestampBegin() / slice % n;
+  }
+
   ProducerSP Producer::Make(const std::string &code_name,
 			    const std::string &run_name,
 			    const std::string &runcontrol){
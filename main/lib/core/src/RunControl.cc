@@ -22,6 +22,18 @@ namespace eudaq {
       Register<RunControl, const std::string&>(RunControl::m_id_factory);
     auto dummy1 = Factory<RunControl>::
       Register<RunControl, const std::string&>(eudaq::cstr2hash("RunControl"));
+
+    int TargetState(const std::string &cmd){
+      if(cmd == "INIT")
+	return Status::STATE_UNCONF;
+      if(cmd == "CONFIG")
+	return Status::STATE_CONF;
+      if(cmd == "START")
+	return Status::STATE_RUNNING;
+      if(cmd == "STOP")
+	return Status::STATE_STOPPED;
+      return -1;
+    }
   }
   
   RunControl::RunControl(const std::string &listenaddress)
@@ -97,7 +109,7 @@ namespace eudaq {
 	}
       }
     m_conf_init->SetSection("RunControl"); //TODO: RunControl section must exist
-    SendCommand("INIT", to_string(*m_conf_init), id);	  
+    SendTransition("INIT", to_string(*m_conf_init), {id});
   }
   
   void RunControl::Configure(){
@@ -138,8 +150,7 @@ namespace eudaq {
     if(!m_conf->HasSection("RunControl"))
            EUDAQ_THROW("No global RunControl section given in config file");
     m_conf->SetSection("RunControl");
-    for(auto &conn: conn_to_conf)
-      SendCommand("CONFIG", to_string(*m_conf), conn);
+    SendTransition("CONFIG", to_string(*m_conf), conn_to_conf);
   }
   
   void RunControl::ConfigureSingleConnection(ConnectionSPC id) {  
@@ -172,7 +183,7 @@ namespace eudaq {
     if(!m_conf->HasSection("RunControl"))
         EUDAQ_THROW("No global RunControl section given in config file");
     m_conf->SetSection("RunControl");
-    SendCommand("CONFIG", to_string(*m_conf), id);
+    SendTransition("CONFIG", to_string(*m_conf), {id});
   }
 
   void RunControl::ReadConfigureFile(const std::string &path){
@@ -214,78 +225,24 @@ namespace eudaq {
     }
     lk.unlock();
     
-    for(auto &conn :conn_to_run){
-      if(conn->GetType() != "Producer" && conn->GetType() != "DataCollector"){
-	SendCommand("START", to_string(m_run_n), conn);
-	while(1){
-	  int n = 0;
-	  n++;
-	  std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	  auto st = GetConnectionStatus(conn);
-	  if(st && st->GetState() == Status::STATE_RUNNING)
-	    break;
-	  if(n>30)
-	    EUDAQ_ERROR("Timesout waiting running status");
-	}
-      }
-    }
-
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    for(auto &conn :conn_to_run){
-      if(conn->GetType() == "DataCollector"){
-	SendCommand("START", to_string(m_run_n), conn);
-	while(1){
-	  int n = 0;
-	  n++;
-	  std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	  auto st = GetConnectionStatus(conn);
-	  if(st && st->GetState() == Status::STATE_RUNNING)
-	    break;
-	  if(n>30)
-	    EUDAQ_ERROR("Timesout waiting running status");
-	}
-      }
-    }
-
-
-    //TODO: make sure datacollector is started before producer. waiting
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    // monitors and other services, data collectors, producers and the
+    // producer starting last: each tier is started at once and running
+    // before the next one is started
     std::string producer_last_start;
     m_conf->SetSection("RunControl");
     producer_last_start = m_conf->Get("EUDAQ_CTRL_PRODUCER_LAST_START", producer_last_start);
+    std::vector<ConnectionSPC> tiers[4];
     for(auto &conn :conn_to_run){
-      if(conn->GetType() == "Producer" &&
-	 conn->GetName() != producer_last_start){
-	SendCommand("START", to_string(m_run_n), conn);
-      }
-    }
-
-    auto tp_timeout = std::chrono::steady_clock::now()
-      + std::chrono::seconds(60);
-    for(auto &conn :conn_to_run){
-      if(conn->GetName() == producer_last_start){
-	continue;
-      }
-      while(1){
-	auto st = GetConnectionStatus(conn)->GetState();
-	if(st == Status::STATE_CONF){
-	  if(std::chrono::steady_clock::now()>tp_timeout){
-	    EUDAQ_ERROR("Timesout waiting running status from "+ conn->GetName());
-	  }
-	  std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	  continue;
-	}else{
-	  break;
-	}
-      }
+      if(conn->GetType() == "Producer")
+	tiers[conn->GetName() == producer_last_start ? 3 : 2].push_back(conn);
+      else if(conn->GetType() == "DataCollector")
+	tiers[1].push_back(conn);
+      else
+	tiers[0].push_back(conn);
     }
-    
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    for(auto &conn :conn_to_run){
-      if(conn->GetType() == "Producer" &&
-	 conn->GetName() == producer_last_start){
-	SendCommand("START", to_string(m_run_n), conn);
-      }
+    for(auto &tier: tiers){
+      SendTransition("START", to_string(m_run_n), tier);
+      WaitTransition(tier);
     }
   }
   
@@ -298,7 +255,7 @@ namespace eudaq {
     }
     lk.unlock();
     
-    SendCommand("START", to_string(m_run_n), id);	  
+    SendTransition("START", to_string(m_run_n), {id});
   }
 
   void RunControl::StopRun(){
@@ -325,57 +282,21 @@ namespace eudaq {
     m_conf->SetSection("RunControl");
     producer_first_stop = m_conf->Get("EUDAQ_CTRL_PRODUCER_FIRST_STOP", producer_first_stop);
 
-    auto tp_timeout = std::chrono::steady_clock::now()
-      + std::chrono::seconds(60);
-
-    for(auto &conn : conn_to_stop){
-      if (conn->GetType() == "Producer" &&
-	  conn->GetName() == producer_first_stop){
-	SendCommand("STOP", "", conn);
-
-	while(1){
-	  std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	  auto st =  GetConnectionStatus(conn)->GetState();
-	  if (st == Status::STATE_RUNNING) {
-	    if(std::chrono::steady_clock::now() > tp_timeout){
-	      EUDAQ_ERROR("Timesout waiting stopping status from "+ conn->GetName());
-	    }
-	    continue;
-	  }else break;
-	}// make sure the first producer has stopped
-      }// find the first stop producer!
-    }// loop to find the key producer.
-
-    
+    // the producer stopping first, the other producers, data collectors,
+    // monitors and other services: each tier is stopped at once and has
+    // left the running state before the next one is stopped
+    std::vector<ConnectionSPC> tiers[4];
     for(auto &conn :conn_to_stop){
-      if(conn->GetType() == "Producer" &&
-	 conn->GetName() != producer_first_stop){
-    	SendCommand("STOP", "", conn);
-      }
+      if(conn->GetType() == "Producer")
+	tiers[conn->GetName() == producer_first_stop ? 0 : 1].push_back(conn);
+      else if(conn->GetType() == "DataCollector")
+	tiers[2].push_back(conn);
+      else
+	tiers[3].push_back(conn);
     }
-
-    for(auto &conn :conn_to_stop)
-      if(conn->GetType() == "Producer" &&
-	 conn->GetName() != producer_first_stop){
-        while(1){
-          auto st =  GetConnectionStatus(conn)->GetState();
-          if (st != Status::STATE_RUNNING) break;
-          if(std::chrono::steady_clock::now() > tp_timeout) 
-            EUDAQ_ERROR("Timesout waiting stopping status from "+ conn->GetName());
-          std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-      }
-
-    for(auto &conn :conn_to_stop)
-      if(conn->GetType() == "DataCollector")
-	SendCommand("STOP", "", conn);
-
-    //TODO: make sure datacollector is stoped after producer. waiting. check status
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    for(auto &conn :conn_to_stop){
-      if(conn->GetType() != "Producer" && conn->GetType() != "DataCollector"){
-	SendCommand("STOP", "", conn);
-      }
+    for(auto &tier: tiers){
+      SendTransition("STOP", "", tier);
+      WaitTransition(tier);
     }
   }
   
@@ -388,21 +309,24 @@ namespace eudaq {
       }
     lk.unlock();
 
-    SendCommand("STOP", "", id);	  
+    SendTransition("STOP", "", {id});
   }
 
   void RunControl::Terminate() {
     EUDAQ_INFO("Processing Terminate command");
     m_listening = false;
     SendCommand("TERMINATE", "");
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    std::unique_lock<std::mutex> lk(m_mtx_conn);
+    m_cv_conn.wait_for(lk, std::chrono::seconds(1), [this](){return m_conn_status.empty();});
+    lk.unlock();
     CloseRunControl();
   }
   
   void RunControl::TerminateSingleConnection(ConnectionSPC id) {
     EUDAQ_INFO("Processing Terminate command for connection ");
     SendCommand("TERMINATE", "", id);
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    std::unique_lock<std::mutex> lk(m_mtx_conn);
+    m_cv_conn.wait_for(lk, std::chrono::seconds(1), [this, &id](){return !m_conn_status.count(id);});
   }
   
   void RunControl::SendCommand(const std::string &cmd, const std::string &param,
@@ -418,6 +342,45 @@ namespace eudaq {
       m_cmdserver->SendPacket(packet, ConnectionInfo::ALL);
   }
 
+  void RunControl::SendTransition(const std::string &cmd, const std::string &param,
+				  const std::vector<ConnectionSPC> &conns){
+    std::unique_lock<std::mutex> lk(m_mtx_conn);
+    auto tp = std::chrono::steady_clock::now();
+    for(auto &conn: conns){
+      auto it = m_conn_status.find(conn);
+      if(it != m_conn_status.end())
+	m_conn_pending[conn] = Transition{cmd, it->second->GetState(), TargetState(cmd), tp};
+    }
+    lk.unlock();
+    for(auto &conn: conns)
+      SendCommand(cmd, param, conn);
+  }
+
+  bool RunControl::WaitTransition(const std::vector<ConnectionSPC> &conns){
+    int timeout = 60;
+    if(m_conf){
+      m_conf->SetSection("RunControl");
+      timeout = m_conf->Get("EUDAQ_CTRL_TRANSITION_TIMEOUT", timeout);
+    }
+    auto done = [this, &conns](){
+      for(auto &conn: conns)
+	if(m_conn_pending.count(conn))
+	  return false;
+      return true;
+    };
+    std::unique_lock<std::mutex> lk(m_mtx_conn);
+    if(m_cv_conn.wait_for(lk, std::chrono::seconds(timeout), done))
+      return true;
+    for(auto &conn: conns){
+      auto it = m_conn_pending.find(conn);
+      if(it == m_conn_pending.end())
+	continue;
+      EUDAQ_ERROR("Timeout waiting for "+it->second.cmd+" of "+conn->GetName());
+      m_conn_pending.erase(it);
+    }
+    return false;
+  }
+
   void RunControl::CommandThread() {
     while (!m_exit) {
       m_cmdserver->Process(100000);
@@ -441,17 +404,22 @@ namespace eudaq {
 	std::string msg = "OK EUDAQ CMD RunControl " + con->GetRemote();
         m_cmdserver->SendPacket(msg.c_str(), *con, true);
 	m_conn_status[con].reset(new Status());
+	PublishStatusView();
       } else {
 	EUDAQ_INFO(std::string("Refused connect:    ") + con->GetName());
         m_cmdserver->SendPacket("ERROR EUDAQ CMD Not accepting new connections",
                                 *con, true);
         m_cmdserver->Close(*con);
 	m_conn_status.erase(con);
+	PublishStatusView();
       }
       break;
     case (TransportEvent::DISCONNECT):
       DoDisconnect(con);
       m_conn_status.erase(con);
+      m_conn_pending.erase(con);
+      PublishStatusView();
+      m_cv_conn.notify_all();
       break;
     case (TransportEvent::RECEIVE):
       if (con->GetState() == 0) { // waiting for identification
@@ -492,8 +460,25 @@ namespace eudaq {
       }
       else {
         BufferSerializer ser(ev.packet.begin(), ev.packet.end());
-        auto status = std::make_shared<Status>(ser);
-	m_conn_status.at(con) = status;
+	// a delta only carries the changed tags, readers keep the status they hold
+	auto &status_last = m_conn_status.at(con);
+	auto status = status_last ? std::make_shared<Status>(*status_last) : std::make_shared<Status>();
+	status->Update(ser);
+	status_last = status;
+	PublishStatusView();
+	auto it = m_conn_pending.find(con);
+	if(it != m_conn_pending.end() && (status->GetState() != it->second.state_from ||
+					  status->GetState() == it->second.state_to)){
+	  auto dt = std::chrono::duration_cast<std::chrono::milliseconds>
+	    (std::chrono::steady_clock::now() - it->second.tp_sent).count();
+	  std::string msg = it->second.cmd+" of "+con->GetName()+" took "+std::to_string(dt)+" ms";
+	  if(status->GetState() == Status::STATE_ERROR)
+	    EUDAQ_WARN(msg+" and failed");
+	  else
+	    EUDAQ_INFO(msg);
+	  m_conn_pending.erase(it);
+	  m_cv_conn.notify_all();
+	}
 	DoStatus(con, status);
       }
       break;
@@ -527,8 +512,16 @@ namespace eudaq {
   }
   
   std::map<ConnectionSPC, StatusSPC> RunControl::GetActiveConnectionStatusMap(){
-    std::unique_lock<std::mutex> lk(m_mtx_conn);
-    return m_conn_status;
+    auto view = GetStatusView();
+    return view ? *view : std::map<ConnectionSPC, StatusSPC>();
+  }
+
+  RunControl::StatusView RunControl::GetStatusView() const{
+    return std::atomic_load(&m_conn_status_view);
+  }
+
+  void RunControl::PublishStatusView(){
+    std::atomic_store(&m_conn_status_view, StatusView(std::make_shared<std::map<ConnectionSPC, StatusSPC>>(m_conn_status)));
   }
   
   void RunControl::StartRunControl(){
@@ -100,6 +100,22 @@ namespace eudaq{
     }
   }
 
+  void StandardPlane::ReservePixels(uint32_t npix, uint32_t frame) {
+    if (frame >= m_pix.size())
+      EUDAQ_THROW("Bad frame number " + to_string(frame) + " in ReservePixels");
+    m_pix[frame].reserve(npix);
+    m_waveform[frame].reserve(npix);
+    m_waveform_x0[frame].reserve(npix);
+    m_waveform_dx[frame].reserve(npix);
+    if (frame >= m_x.size())
+      return;
+    m_x[frame].reserve(npix);
+    m_y[frame].reserve(npix);
+    m_time[frame].reserve(npix);
+    if (m_pivot.size())
+      m_pivot[frame].reserve(npix);
+  }
+
   void StandardPlane::PushPixelHelper(uint32_t x, uint32_t y, double p, uint64_t time_ps,
 				      bool pivot, uint32_t frame) {
     if (frame > m_x.size())
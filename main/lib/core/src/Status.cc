@@ -5,6 +5,8 @@
 
 namespace eudaq {
 
+  constexpr uint32_t Status::DELTA_MARK;
+
   Status::Status(int level, const std::string &msg )
     :m_level(level), m_state(STATE_UNINIT), m_msg(msg){
   }
@@ -24,7 +26,67 @@ namespace eudaq {
     ser.write(m_level);
     ser.write(m_state);
     ser.write(m_msg);
-    ser.write(m_tags);
+    if(m_counters.empty())
+      ser.write(m_tags);
+    else
+      ser.write(GetTags());
+  }
+
+  void Status::SerializeDelta(Serializer &ser, const std::set<std::string> *keys) const {
+    ser.write(DELTA_MARK);
+    ser.write(m_level);
+    ser.write(m_state);
+    ser.write(m_msg);
+    std::map<std::string, std::string> tags;
+    std::map<std::string, int64_t> counters;
+    if(keys){
+      for(auto &key: *keys){
+	auto it_c = m_counters.find(key);
+	if(it_c != m_counters.end()){
+	  counters.insert(*it_c);
+	  continue;
+	}
+	auto it_t = m_tags.find(key);
+	if(it_t != m_tags.end())
+	  tags.insert(*it_t);
+      }
+      ser.write(tags);
+      ser.write(counters);
+    }
+    else{
+      ser.write(m_tags);
+      ser.write(m_counters);
+    }
+  }
+
+  void Status::Update(Deserializer &ds){
+    uint32_t mark;
+    ds.read(mark);
+    if(mark != DELTA_MARK){
+      m_level = static_cast<int>(mark);
+      ds.read(m_state);
+      ds.read(m_msg);
+      m_tags.clear();
+      m_counters.clear();
+      ds.read(m_tags);
+      return;
+    }
+    ds.read(m_level);
+    ds.read(m_state);
+    ds.read(m_msg);
+    uint32_t n;
+    ds.read(n);
+    for(uint32_t i = 0; i < n; i++){
+      auto key = ds.read<std::string>();
+      m_counters.erase(key);
+      m_tags[key] = ds.read<std::string>();
+    }
+    ds.read(n);
+    for(uint32_t i = 0; i < n; i++){
+      auto key = ds.read<std::string>();
+      m_tags.erase(key);
+      m_counters[key] = ds.read<int64_t>();
+    }
   }
 
   void Status::ResetStatus(State st, Level lvl, const std::string &msg){
@@ -78,15 +140,45 @@ namespace eudaq {
   }
 
   std::map<std::string, std::string> Status::GetTags() const{
-    return m_tags;
-  }
-
-  void Status::SetTag(const std::string &name, const std::string &val){
-    m_tags[name] = val;
+    if(m_counters.empty())
+      return m_tags;
+    std::map<std::string, std::string> tags(m_tags);
+    for(auto &c: m_counters)
+      tags[c.first] = std::to_string(c.second);
+    return tags;
+  }
+
+  bool Status::SetTag(const std::string &name, const std::string &val){
+    bool changed = m_counters.erase(name) != 0;
+    auto it = m_tags.find(name);
+    if(it == m_tags.end()){
+      m_tags.emplace(name, val);
+      return true;
+    }
+    if(it->second == val)
+      return changed;
+    it->second = val;
+    return true;
+  }
+
+  bool Status::SetCounter(const std::string &name, int64_t val){
+    bool changed = m_tags.erase(name) != 0;
+    auto it = m_counters.find(name);
+    if(it == m_counters.end()){
+      m_counters.emplace(name, val);
+      return true;
+    }
+    if(it->second == val)
+      return changed;
+    it->second = val;
+    return true;
   }
 
   std::string Status::GetTag(const std::string &name,
                              const std::string &def) const{
+    auto it_c = m_counters.find(name);
+    if(it_c != m_counters.end())
+      return std::to_string(it_c->second);
     std::map<std::string, std::string>::const_iterator i = m_tags.find(name);
     if (i == m_tags.end())
       return def;
@@ -98,9 +190,9 @@ namespace eudaq {
     os << std::string(offset + 2, ' ') << "<Level>" << Level2String(m_level) <<"</Level>\n";
     os << std::string(offset + 2, ' ') << "<State>" << m_state <<"</State>\n";
     os << std::string(offset + 2, ' ') << "<Message>" <<m_msg <<"</Message>\n";
-    if(!m_tags.empty()){
+    if(!m_tags.empty() || !m_counters.empty()){
       os << std::string(offset + 2, ' ') << "<Tags>\n";
-      for (auto &tag: m_tags){
+      for (auto &tag: GetTags()){
 	os << std::string(offset+4, ' ') <<"<Tag name=\""<<tag.first<<"\">"<< tag.second <<"</Tag>\n";
       }
       os << std::string(offset + 2, ' ') << "</Tags>\n";
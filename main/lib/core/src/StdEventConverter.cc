@@ -1,4 +1,5 @@
 #include "eudaq/StdEventConverter.hh"
+#include "eudaq/Metrics.hh"
 
 namespace eudaq{
 
@@ -44,7 +45,16 @@ namespace eudaq{
     uint32_t id = d1->GetType();
     auto cvt = Factory<StdEventConverter>::MakeUnique(id);
     if(cvt){
-      return cvt->Converting(d1, d2, conf);
+      static auto &metrics = Metrics::Instance();
+      static auto &h_convert = metrics.Histogram("convert");
+      static auto &c_converted = metrics.Counter("events_converted");
+      if(!metrics.IsEnabled())
+	return cvt->Converting(d1, d2, conf);
+      uint64_t t0 = Metrics::NowNs();
+      bool ok = cvt->Converting(d1, d2, conf);
+      h_convert.Record(Metrics::NowNs() - t0);
+      c_converted.Add();
+      return ok;
     }
     else{
       std::cerr<<"StdEventConverter: WARNING, no converter for EventID = "<<d1<<"\n";
@@ -0,0 +1,572 @@
+#include "eudaq/TransportSHM.hh"
+#include "eudaq/Exception.hh"
+#include "eudaq/Logger.hh"
+#include "eudaq/Utils.hh"
+
+#if !(EUDAQ_PLATFORM_IS(WIN32) || EUDAQ_PLATFORM_IS(MINGW))
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <ostream>
+#include <fstream>
+#include <functional>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace eudaq {
+  const std::string SHMServer::name = "shm";
+  const std::string SHMClient::name = "shm";
+
+  namespace{
+    auto d0=Factory<TransportServer>::Register<SHMServer, const std::string&>
+      (str2hash(SHMServer::name));
+    auto d1=Factory<TransportClient>::Register<SHMClient, const std::string&>
+      (str2hash(SHMClient::name));
+  }
+
+  namespace {
+    static const uint32_t SHM_MAGIC = 0x45534d31;
+    static const uint32_t SHM_MAX_CONN = 64;
+    static const size_t SHM_NAME_MAX = 40;
+    static const uint64_t SHM_RECV_RING = 256 * 1024;
+    static const int SHM_ALIVE_MS = 500;
+    enum SlotState : uint32_t {SLOT_FREE = 0, SLOT_CLAIMED, SLOT_REQUEST, SLOT_CONNECTED};
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+
+    void WaitWord(std::atomic<uint32_t> &w, uint32_t val, int timeout_us){
+#ifdef __linux__
+      timespec ts;
+      ts.tv_sec = timeout_us / 1000000;
+      ts.tv_nsec = (timeout_us % 1000000) * 1000;
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&w), FUTEX_WAIT, val, &ts, nullptr, 0);
+#else
+      // no futex: poll the word
+      auto tp_end = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
+      while(w.load() == val && std::chrono::steady_clock::now() < tp_end)
+	std::this_thread::sleep_for(std::chrono::microseconds(50));
+#endif
+    }
+
+    void WakeWord(std::atomic<uint32_t> &w){
+#ifdef __linux__
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&w), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+      (void)w;
+#endif
+    }
+
+    bool PidAlive(int32_t pid){
+      if(pid <= 0 || (kill(pid, 0) != 0 && errno == ESRCH))
+	return false;
+#ifdef __linux__
+      // a killed process stays a zombie until its parent reaps it
+      std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+      std::string line;
+      if(std::getline(stat, line)){
+	size_t i = line.rfind(')');
+	if(i != std::string::npos && i + 2 < line.size() && line[i + 2] == 'Z')
+	  return false;
+      }
+#endif
+      return true;
+    }
+
+    std::string SegmentName(const std::string &name){
+      if(name.empty() || name.size() > SHM_NAME_MAX || name.find('/') != std::string::npos)
+	EUDAQ_THROW_NOLOG("TransportSHM:: Invalid name '" + name + "', at most " +
+			  std::to_string(SHM_NAME_MAX) + " characters without '/'");
+      return "/eudaq." + name;
+    }
+  }
+
+  // A futex word bumped by the notifier, which only enters the kernel when
+  // somebody is sleeping on it.
+  struct ShmSignal {
+    std::atomic<uint32_t> seq;
+    std::atomic<uint32_t> waiters;
+    void Notify(){
+      seq.fetch_add(1);
+      if(waiters.load())
+	WakeWord(seq);
+    }
+    uint32_t Prepare() const {return seq.load();}
+    void Wait(uint32_t seen, int timeout_us){
+      waiters.fetch_add(1);
+      WaitWord(seq, seen, timeout_us);
+      waiters.fetch_sub(1);
+    }
+  };
+
+  struct ShmSlot {
+    std::atomic<uint32_t> state;
+    uint32_t gen;
+    std::atomic<int32_t> client_pid;
+    char segname[64];
+  };
+
+  struct ShmControl {
+    uint32_t magic;
+    std::atomic<int32_t> server_pid;
+    ShmSignal srv;
+    ShmSlot slot[SHM_MAX_CONN];
+  };
+
+  struct ShmRingHeader {
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+    std::atomic<uint32_t> closed;
+    uint64_t size;
+    ShmSignal data;
+    ShmSignal space;
+  };
+
+  struct ShmConnHeader {
+    uint32_t magic;
+    ShmRingHeader c2s;
+    ShmRingHeader s2c;
+  };
+
+  class ShmSegment {
+  public:
+    // Creates (exclusively) or opens a segment
+    ShmSegment(const std::string &name, size_t size, bool create)
+      :m_name(name), m_addr(nullptr), m_size(size){
+      int fd = shm_open(name.c_str(), create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0600);
+      if(fd < 0)
+	EUDAQ_THROW_NOLOG("TransportSHM:: Unable to " + std::string(create ? "create" : "open") +
+			  " " + name + ": " + std::strerror(errno));
+      if(create && ftruncate(fd, size) != 0){
+	int err = errno;
+	close(fd);
+	shm_unlink(name.c_str());
+	EUDAQ_THROW_NOLOG("TransportSHM:: Unable to size " + name + ": " + std::strerror(err));
+      }
+      if(!create){
+	struct stat st;
+	fstat(fd, &st);
+	m_size = st.st_size;
+      }
+      if(m_size < size){
+	close(fd);
+	EUDAQ_THROW_NOLOG("TransportSHM:: " + name + " is too small");
+      }
+      void *addr = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if(addr == MAP_FAILED)
+	EUDAQ_THROW_NOLOG("TransportSHM:: Unable to map " + name + ": " + std::strerror(errno));
+      m_addr = addr;
+    }
+    ~ShmSegment(){
+      if(m_addr)
+	munmap(m_addr, m_size);
+    }
+    void Unlink(){shm_unlink(m_name.c_str());}
+    void *Addr() const {return m_addr;}
+    size_t Size() const {return m_size;}
+  private:
+    std::string m_name;
+    void *m_addr;
+    size_t m_size;
+  };
+
+  // One direction of a connection: a byte ring with one writing and one
+  // reading process. Packets are a u32 length followed by the payload and
+  // may be larger than the ring, the reader then drains it while it is filled.
+  class ShmRing {
+  public:
+    ShmRing(ShmRingHeader *h, uint8_t *data, ShmSignal *data_sig)
+      :m_h(h), m_data(data), m_data_sig(data_sig), m_in_packet(false), m_len_fill(0), m_fill(0){}
+
+    void WritePacket(const unsigned char *p, size_t n, const std::function<bool()> &peer_alive){
+      uint32_t len = static_cast<uint32_t>(n);
+      Write(reinterpret_cast<const uint8_t*>(&len), 4, peer_alive);
+      Write(p, n, peer_alive);
+      m_data_sig->Notify();
+    }
+
+    // Appends the available bytes to the pending packet, true once it is complete
+    bool ReadPacket(std::string &out){
+      if(!m_in_packet){
+	m_len_fill += Read(m_len_buf + m_len_fill, 4 - m_len_fill);
+	if(m_len_fill < 4)
+	  return false;
+	uint32_t len;
+	std::memcpy(&len, m_len_buf, 4);
+	m_pkt.resize(len);
+	m_fill = 0;
+	m_len_fill = 0;
+	m_in_packet = true;
+      }
+      if(m_fill < m_pkt.size())
+	m_fill += Read(reinterpret_cast<uint8_t*>(&m_pkt[0]) + m_fill, m_pkt.size() - m_fill);
+      if(m_fill < m_pkt.size())
+	return false;
+      m_in_packet = false;
+      out = std::move(m_pkt);
+      m_pkt = std::string();
+      return true;
+    }
+
+    bool Empty() const {return m_h->head.load() == m_h->tail.load();}
+    bool IsClosed() const {return m_h->closed.load() != 0;}
+    void SetClosed(){
+      m_h->closed.store(1);
+      m_h->data.Notify();
+      m_h->space.Notify();
+      m_data_sig->Notify();
+    }
+    ShmSignal &DataSignal() {return *m_data_sig;}
+
+  private:
+    void Write(const uint8_t *p, size_t n, const std::function<bool()> &peer_alive){
+      uint64_t size = m_h->size;
+      size_t done = 0;
+      while(done < n){
+	if(IsClosed())
+	  EUDAQ_THROW_NOLOG("TransportSHM:: Connection reset by peer");
+	uint64_t head = m_h->head.load(std::memory_order_relaxed);
+	uint64_t space = size - (head - m_h->tail.load(std::memory_order_acquire));
+	if(!space){
+	  // let the reader drain what is already there
+	  m_data_sig->Notify();
+	  uint32_t seen = m_h->space.Prepare();
+	  if(size - (head - m_h->tail.load(std::memory_order_acquire)) == 0){
+	    m_h->space.Wait(seen, SHM_ALIVE_MS * 1000);
+	    if(!peer_alive())
+	      EUDAQ_THROW_NOLOG("TransportSHM:: Connection reset by peer");
+	  }
+	  continue;
+	}
+	size_t k = static_cast<size_t>(std::min<uint64_t>(space, n - done));
+	size_t off = static_cast<size_t>(head % size);
+	size_t k1 = std::min<size_t>(k, size - off);
+	std::memcpy(m_data + off, p + done, k1);
+	std::memcpy(m_data, p + done + k1, k - k1);
+	m_h->head.store(head + k, std::memory_order_release);
+	done += k;
+      }
+    }
+
+    size_t Read(uint8_t *p, size_t n){
+      uint64_t size = m_h->size;
+      uint64_t tail = m_h->tail.load(std::memory_order_relaxed);
+      uint64_t avail = m_h->head.load(std::memory_order_acquire) - tail;
+      size_t k = static_cast<size_t>(std::min<uint64_t>(avail, n));
+      if(!k)
+	return 0;
+      size_t off = static_cast<size_t>(tail % size);
+      size_t k1 = std::min<size_t>(k, size - off);
+      std::memcpy(p, m_data + off, k1);
+      std::memcpy(p + k1, m_data, k - k1);
+      m_h->tail.store(tail + k, std::memory_order_release);
+      m_h->space.Notify();
+      return k;
+    }
+
+    ShmRingHeader *m_h;
+    uint8_t *m_data;
+    ShmSignal *m_data_sig;
+    bool m_in_packet;
+    uint8_t m_len_buf[4];
+    size_t m_len_fill;
+    std::string m_pkt;
+    size_t m_fill;
+  };
+
+  namespace {
+    size_t ConnSize(uint64_t c2s, uint64_t s2c){
+      return sizeof(ShmConnHeader) + c2s + s2c;
+    }
+    // the views of both rings of a connection segment, from the server (c2s) or client side
+    void MakeRings(ShmSegment &seg, ShmSignal &srv, bool server,
+		   std::unique_ptr<ShmRing> &send, std::unique_ptr<ShmRing> &recv){
+      auto h = static_cast<ShmConnHeader*>(seg.Addr());
+      uint8_t *c2s_data = static_cast<uint8_t*>(seg.Addr()) + sizeof(ShmConnHeader);
+      uint8_t *s2c_data = c2s_data + h->c2s.size;
+      // the client wakes the server through the signal of the control segment
+      std::unique_ptr<ShmRing> c2s(new ShmRing(&h->c2s, c2s_data, &srv));
+      std::unique_ptr<ShmRing> s2c(new ShmRing(&h->s2c, s2c_data, &h->s2c.data));
+      if(server){
+	send = std::move(s2c);
+	recv = std::move(c2s);
+      }
+      else{
+	send = std::move(c2s);
+	recv = std::move(s2c);
+      }
+    }
+  }
+
+  bool ConnectionInfoSHM::Matches(const ConnectionInfo &other) const {
+    auto ptr = dynamic_cast<const ConnectionInfoSHM *>(&other);
+    return ptr && ptr->m_slot == m_slot && ptr->m_gen == m_gen;
+  }
+
+  void ConnectionInfoSHM::Print(std::ostream &os, size_t offset) const {
+    os << std::string(offset, ' ') << "<ConnectionSHM>\n";
+    os << std::string(offset + 2, ' ') << "<Remote>" << m_remote <<"</Remote>\n";
+    ConnectionInfo::Print(os, offset+2);
+    os << std::string(offset, ' ') << "</ConnectionSHM>\n";
+  }
+
+  struct SHMServer::Conn {
+    std::unique_ptr<ShmSegment> seg;
+    std::unique_ptr<ShmRing> send;
+    std::unique_ptr<ShmRing> recv;
+    std::shared_ptr<ConnectionInfoSHM> info;
+    int32_t pid;
+    std::mutex mtx_send; // one writer at a time into the ring
+  };
+
+  SHMServer::SHMServer(const std::string &param)
+    :m_name(trim(param)), m_ctl(nullptr), m_conn(SHM_MAX_CONN){
+    std::string segname = SegmentName(m_name);
+    try{
+      m_ctl_seg.reset(new ShmSegment(segname, sizeof(ShmControl), true));
+    }
+    catch(const Exception &){
+      // left over by a server which did not exit cleanly?
+      {
+	ShmSegment old(segname, sizeof(ShmControl), false);
+	auto ctl = static_cast<ShmControl*>(old.Addr());
+	if(ctl->magic == SHM_MAGIC && PidAlive(ctl->server_pid.load()) && ctl->server_pid.load() != getpid())
+	  EUDAQ_THROW_NOLOG("TransportSHM:: shm://" + m_name + " is already used by process " +
+			    std::to_string(ctl->server_pid.load()));
+	old.Unlink();
+      }
+      m_ctl_seg.reset(new ShmSegment(segname, sizeof(ShmControl), true));
+    }
+    m_ctl = new (m_ctl_seg->Addr()) ShmControl();
+    m_ctl->server_pid.store(getpid());
+    m_ctl->magic = SHM_MAGIC;
+  }
+
+  SHMServer::~SHMServer() {
+    std::unique_lock<std::mutex> lk(m_mtx_conn);
+    for(size_t i = 0; i < m_conn.size(); i++)
+      CloseConn(i);
+    m_ctl->server_pid.store(0);
+    m_ctl_seg->Unlink();
+  }
+
+  void SHMServer::CloseConn(size_t i){
+    auto &conn = m_conn[i];
+    if(!conn)
+      return;
+    conn->send->SetClosed();
+    conn->recv->SetClosed();
+    conn.reset();
+    m_ctl->slot[i].client_pid.store(0);
+    m_ctl->slot[i].state.store(SLOT_FREE);
+  }
+
+  void SHMServer::Close(const ConnectionInfo &id) {
+    std::unique_lock<std::mutex> lk(m_mtx_conn);
+    for(size_t i = 0; i < m_conn.size(); i++)
+      if(m_conn[i] && id.Matches(*m_conn[i]->info))
+	CloseConn(i);
+  }
+
+  std::vector<ConnectionSPC> SHMServer::GetConnections() const {
+    std::unique_lock<std::mutex> lk(m_mtx_conn);
+    std::vector<ConnectionSPC> conns;
+    for(auto &conn: m_conn)
+      if(conn)
+	conns.push_back(conn->info);
+    return conns;
+  }
+
+  void SHMServer::SendPacket(const unsigned char *data, size_t len,
+			     const ConnectionInfo &id, bool duringconnect) {
+    // a full ring blocks the writer, which must not stall Poll meanwhile
+    std::vector<std::shared_ptr<Conn>> targets;
+    {
+      std::unique_lock<std::mutex> lk(m_mtx_conn);
+      for(auto &conn: m_conn)
+	if(conn && id.Matches(*conn->info) && (conn->info->GetState() > 0 || duringconnect))
+	  targets.push_back(conn);
+    }
+    for(auto &conn: targets){
+      std::unique_lock<std::mutex> lk(conn->mtx_send);
+      int32_t pid = conn->pid;
+      conn->send->WritePacket(data, len, [pid](){return PidAlive(pid);});
+    }
+  }
+
+  bool SHMServer::Poll(bool check_alive) {
+    std::unique_lock<std::mutex> lk(m_mtx_conn);
+    bool done = false;
+    for(uint32_t i = 0; i < SHM_MAX_CONN; i++){
+      auto &slot = m_ctl->slot[i];
+      auto &conn = m_conn[i];
+      uint32_t expected = SLOT_REQUEST;
+      if(!conn && slot.state.load() == SLOT_REQUEST &&
+	 slot.state.compare_exchange_strong(expected, SLOT_CONNECTED)){
+	std::string segname(slot.segname, strnlen(slot.segname, sizeof(slot.segname)));
+	std::unique_ptr<Conn> conn_new(new Conn);
+	try{
+	  conn_new->seg.reset(new ShmSegment(segname, sizeof(ShmConnHeader), false));
+	}
+	catch(const Exception &e){
+	  EUDAQ_WARN(std::string("TransportSHM:: Refused connection: ") + e.what());
+	  slot.state.store(SLOT_FREE);
+	  continue;
+	}
+	// both sides keep their mapping, the name is not needed any more
+	conn_new->seg->Unlink();
+	MakeRings(*conn_new->seg, m_ctl->srv, true, conn_new->send, conn_new->recv);
+	conn_new->pid = slot.client_pid.load();
+	conn_new->info = std::make_shared<ConnectionInfoSHM>
+	  (i, slot.gen, name + "://" + m_name + "/" + std::to_string(i) + " pid " + std::to_string(conn_new->pid));
+	conn = std::move(conn_new);
+	m_events.push(TransportEvent(TransportEvent::CONNECT, conn->info));
+	done = true;
+      }
+      if(!conn)
+	continue;
+      std::string packet;
+      while(conn->recv->ReadPacket(packet)){
+	m_events.push(TransportEvent(TransportEvent::RECEIVE, conn->info, std::move(packet)));
+	done = true;
+      }
+      if((conn->recv->IsClosed() && conn->recv->Empty()) || (check_alive && !PidAlive(conn->pid))){
+	m_events.push(TransportEvent(TransportEvent::DISCONNECT, conn->info));
+	CloseConn(i);
+	done = true;
+      }
+    }
+    return done;
+  }
+
+  void SHMServer::ProcessEvents(int timeout) {
+    auto tp_end = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout);
+    bool check_alive = false;
+    for(;;){
+      uint32_t seen = m_ctl->srv.Prepare();
+      if(Poll(check_alive))
+	break;
+      auto remain = std::chrono::duration_cast<std::chrono::microseconds>(tp_end - std::chrono::steady_clock::now()).count();
+      if(remain <= 0)
+	break;
+      int wait_us = static_cast<int>(std::min<int64_t>(remain, SHM_ALIVE_MS * 1000));
+      m_ctl->srv.Wait(seen, wait_us);
+      // a client which did not close its connection is only noticed by its pid
+      check_alive = m_ctl->srv.Prepare() == seen;
+    }
+  }
+
+  std::string SHMServer::ConnectionString() const {
+    return name + "://" + m_name;
+  }
+
+  SHMClient::SHMClient(const std::string &param)
+    :m_name(trim(param)), m_ctl(nullptr), m_slot(SHM_MAX_CONN){
+    std::string segname = SegmentName(m_name);
+    try{
+      m_ctl_seg.reset(new ShmSegment(segname, sizeof(ShmControl), false));
+    }
+    catch(const Exception &e){
+      EUDAQ_THROW_NOLOG(std::string(e.what()) + " - Are you sure the server is running?");
+    }
+    m_ctl = static_cast<ShmControl*>(m_ctl_seg->Addr());
+    if(m_ctl->magic != SHM_MAGIC || !ServerAlive())
+      EUDAQ_THROW_NOLOG("TransportSHM:: No server on shm://" + m_name);
+
+    for(uint32_t i = 0; i < SHM_MAX_CONN; i++){
+      uint32_t expected = SLOT_FREE;
+      if(m_ctl->slot[i].state.compare_exchange_strong(expected, SLOT_CLAIMED)){
+	m_slot = i;
+	break;
+      }
+    }
+    if(m_slot == SHM_MAX_CONN)
+      EUDAQ_THROW_NOLOG("TransportSHM:: No free connection slot on shm://" + m_name);
+    auto &slot = m_ctl->slot[m_slot];
+    uint32_t gen = ++slot.gen;
+
+    uint64_t c2s_size = 16;
+    const char *env = std::getenv("EUDAQ_SHM_RING_MB");
+    if(env)
+      c2s_size = std::max<uint64_t>(1, std::strtoull(env, nullptr, 10));
+    c2s_size <<= 20;
+    std::string connname = segname + "." + std::to_string(m_slot) + "." + std::to_string(gen);
+    try{
+      shm_unlink(connname.c_str()); // left over by a crashed client
+      m_seg.reset(new ShmSegment(connname, ConnSize(c2s_size, SHM_RECV_RING), true));
+    }
+    catch(...){
+      slot.state.store(SLOT_FREE);
+      throw;
+    }
+    auto h = new (m_seg->Addr()) ShmConnHeader();
+    h->c2s.size = c2s_size;
+    h->s2c.size = SHM_RECV_RING;
+    h->magic = SHM_MAGIC;
+    MakeRings(*m_seg, m_ctl->srv, false, m_send, m_recv);
+    m_info = std::make_shared<ConnectionInfoSHM>(m_slot, gen, name + "://" + m_name);
+
+    std::strncpy(slot.segname, connname.c_str(), sizeof(slot.segname) - 1);
+    slot.segname[sizeof(slot.segname) - 1] = 0;
+    slot.client_pid.store(getpid());
+    slot.state.store(SLOT_REQUEST);
+    m_ctl->srv.Notify();
+  }
+
+  SHMClient::~SHMClient() {
+    auto &slot = m_ctl->slot[m_slot];
+    uint32_t expected = SLOT_REQUEST;
+    if(slot.state.compare_exchange_strong(expected, SLOT_FREE))
+      m_seg->Unlink(); // never accepted
+    m_send->SetClosed();
+  }
+
+  bool SHMClient::ServerAlive() const {
+    return PidAlive(m_ctl->server_pid.load());
+  }
+
+  void SHMClient::SendPacket(const unsigned char *data, size_t len,
+			     const ConnectionInfo &id, bool) {
+    if(!id.Matches(*m_info))
+      return;
+    std::unique_lock<std::mutex> lk(m_mtx_send);
+    m_send->WritePacket(data, len, [this](){return ServerAlive();});
+  }
+
+  void SHMClient::ProcessEvents(int timeout) {
+    auto tp_end = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout);
+    for(;;){
+      auto &sig = m_recv->DataSignal();
+      uint32_t seen = sig.Prepare();
+      bool done = false;
+      std::string packet;
+      while(m_recv->ReadPacket(packet)){
+	m_events.push(TransportEvent(TransportEvent::RECEIVE, m_info, std::move(packet)));
+	done = true;
+      }
+      if(done)
+	break;
+      if(m_recv->IsClosed() || !ServerAlive())
+	EUDAQ_THROW_NOLOG("TransportSHM:: Connection closed by shm://" + m_name);
+      auto remain = std::chrono::duration_cast<std::chrono::microseconds>(tp_end - std::chrono::steady_clock::now()).count();
+      if(remain <= 0)
+	break;
+      sig.Wait(seen, static_cast<int>(std::min<int64_t>(remain, SHM_ALIVE_MS * 1000)));
+    }
+  }
+}
+
+#endif
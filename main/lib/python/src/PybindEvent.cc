@@ -4,6 +4,14 @@
 
 namespace py = pybind11;
 
+namespace{
+  // exports a data block to the buffer protocol, the event stays alive with it
+  struct BlockBuffer{
+    eudaq::EventSPC ev;
+    uint32_t n;
+  };
+}
+
 class PyEvent : public eudaq::Event {
 public:
   using eudaq::Event::Event;
@@ -19,6 +27,14 @@ class PyEvent : public eudaq::Event {
 };
 
 void  init_pybind_event(py::module &m){
+  py::class_<BlockBuffer>(m, "BlockBuffer", py::buffer_protocol())
+    .def_buffer([](BlockBuffer &b){
+	auto &block = b.ev->GetBlockRef(b.n);
+	return py::buffer_info(const_cast<uint8_t*>(block.data()), sizeof(uint8_t),
+			       py::format_descriptor<uint8_t>::format(), 1,
+			       {block.size()}, {sizeof(uint8_t)}, true);
+      });
+
   py::class_<eudaq::Event, PyEvent, eudaq::EventSP> event_(m, "Event");
   py::enum_<eudaq::Event::Flags>(event_, "Flags")
     .value("FLAG_BORE", eudaq::Event::Flags::FLAG_BORE)
@@ -106,10 +122,16 @@ void  init_pybind_event(py::module &m){
   
   event_.def("GetBlock",
 	     [](const eudaq::EventSP ev,uint32_t n){
-	        std::vector<uint8_t> block=ev->GetBlock(n);
+	        auto &block=ev->GetBlockRef(n);
 	        return py::bytes((const char*)block.data(),block.size());
              },
      	     "Get block", py::arg("n"));
+  event_.def("GetBlockView",
+	     [](const eudaq::EventSP ev,uint32_t n){
+	       return py::memoryview(py::cast(BlockBuffer{ev, n}));
+	     },
+	     "Get a read-only memoryview of block n without copying it (e.g. for numpy.frombuffer),"
+	     " valid until the block is replaced", py::arg("n"));
 
   event_.def("GetNumBlock", &eudaq::Event::GetNumBlock);
   event_.def("GetNumBlockList", &eudaq::Event::GetBlockNumList);
@@ -1,5 +1,12 @@
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+#include "pybind11/numpy.h"
 #include "eudaq/FileReader.hh"
+#include "eudaq/StdEventConverter.hh"
+#include "eudaq/StandardEvent.hh"
+#include "eudaq/Configuration.hh"
+
+#include <cstring>
 
 namespace py = pybind11;
 
@@ -14,9 +21,76 @@ class PyFileReader : public eudaq::FileReader {
   }
 };
 
+namespace{
+  struct HitRecord{
+    uint32_t event;
+    uint32_t trigger;
+    uint32_t plane;
+    uint32_t frame;
+    double x;
+    double y;
+    double charge;
+    uint64_t time; // ps
+  };
+
+  // registered on first use, so that numpy is only needed by GetNextHits
+  void RegisterHitDtype(){
+    PYBIND11_NUMPY_DTYPE(HitRecord, event, trigger, plane, frame, x, y, charge, time);
+  }
+}
+
 void init_pybind_filereader(py::module &m){
   py::class_<eudaq::FileReader, PyFileReader, std::shared_ptr<eudaq::FileReader>>
     filereader_(m, "FileReader");
   filereader_.def(py::init(&eudaq::FileReader::Make));
   filereader_.def("GetNextEvent", &eudaq::FileReader::GetNextEvent);
+  filereader_.def("GetNextEvents",
+		  [](eudaq::FileReader &r, uint32_t n){
+		    std::vector<eudaq::EventSPC> evs;
+		    py::gil_scoped_release release;
+		    evs.reserve(n);
+		    while(evs.size() < n){
+		      auto ev = r.GetNextEvent();
+		      if(!ev)
+			break;
+		      evs.push_back(ev);
+		    }
+		    return evs;
+		  },
+		  "Read up to n events, an empty list at the end of the file", py::arg("n"));
+  filereader_.def("GetNextHits",
+		  [](eudaq::FileReader &r, uint32_t n, eudaq::ConfigurationSP conf){
+		    static bool dtype_registered = (RegisterHitDtype(), true);
+		    (void)dtype_registered;
+		    if(!conf)
+		      conf = std::make_shared<eudaq::Configuration>();
+		    std::vector<HitRecord> hits;
+		    uint32_t n_ev = 0;
+		    {
+		      py::gil_scoped_release release;
+		      for(; n_ev < n; n_ev++){
+			auto ev = r.GetNextEvent();
+			if(!ev)
+			  break;
+			auto stdev = eudaq::StandardEvent::MakeShared();
+			if(!eudaq::StdEventConverter::Convert(ev, stdev, conf))
+			  continue;
+			for(size_t p = 0; p < stdev->NumPlanes(); p++){
+			  auto &plane = stdev->GetPlane(p);
+			  for(uint32_t f = 0; f < plane.NumFrames(); f++)
+			    for(uint32_t i = 0; i < plane.HitPixels(f); i++)
+			      hits.push_back({ev->GetEventN(), ev->GetTriggerN(), plane.ID(), f,
+				    plane.GetX(i, f), plane.GetY(i, f), plane.GetPixel(i, f),
+				    plane.GetTimestamp(i, f)});
+			}
+		      }
+		    }
+		    py::array_t<HitRecord> arr(hits.size());
+		    if(!hits.empty())
+		      std::memcpy(arr.mutable_data(), hits.data(), hits.size() * sizeof(HitRecord));
+		    return py::make_tuple(n_ev, arr);
+		  },
+		  "Read up to n events and convert them to StandardEvent, returns the number of events read"
+		  " and a numpy structured array of their hits (event, trigger, plane, frame, x, y, charge, time)",
+		  py::arg("n"), py::arg("conf") = nullptr);
 }
@@ -76,6 +76,7 @@ void init_pybind_producer(py::module &m){
     producer_(m, "Producer");
   producer_.def(py::init([](const std::string &name,const std::string &runctrl){return PyProducer::Make("PyProducer", name, runctrl);}));
   producer_.def("SetStatusTag", &eudaq::Producer::SetStatusTag);
+  producer_.def("SetStatusCounter", &eudaq::Producer::SetStatusCounter);
   producer_.def("SetStatusMsg", &eudaq::Producer::SetStatusMsg);
   producer_.def("RunLoop", &eudaq::Producer::RunLoop);
   producer_.def("SendEvent", &eudaq::Producer::SendEvent,
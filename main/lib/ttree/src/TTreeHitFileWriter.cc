@@ -0,0 +1,187 @@
+#include "eudaq/FileNamer.hh"
+#include "eudaq/FileWriter.hh"
+#include "eudaq/Configuration.hh"
+#include "eudaq/StdEventConverter.hh"
+#include "eudaq/StandardEvent.hh"
+#include "eudaq/Logger.hh"
+#include <ctime>
+#include <vector>
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TBranch.h"
+#include "TROOT.h"
+
+namespace eudaq {
+  class TTreeHitFileWriter;
+  namespace{
+    auto dummy01 = Factory<FileWriter>::Register<TTreeHitFileWriter, std::string&>(cstr2hash("roothits"));
+    auto dummy11 = Factory<FileWriter>::Register<TTreeHitFileWriter, std::string&&>(cstr2hash("roothits"));
+  }
+
+  // Converts every event to a StandardEvent and stores one tree entry per
+  // event: the event header plus the hits of all planes as variable length
+  // arrays (hit_plane, hit_x, hit_y, hit_charge, hit_time). All branches
+  // point to buffers owned by the writer, which are only rebound when the
+  // hit arrays have to grow.
+  class TTreeHitFileWriter : public FileWriter {
+  public:
+    TTreeHitFileWriter(const std::string &patt);
+    ~TTreeHitFileWriter() override;
+    void WriteEvent(EventSPC ev) override;
+    uint64_t FileBytes() const override;
+  private:
+    void Open(uint32_t run_n);
+    void Close();
+    void Reserve(uint32_t n);
+
+    std::string m_filepattern;
+    uint32_t m_run_n;
+    std::unique_ptr<TFile> m_tfile;
+    TTree *m_ttree; // owned by m_tfile
+
+    UInt_t m_b_run_n;
+    UInt_t m_b_event_n;
+    UInt_t m_b_trigger_n;
+    UInt_t m_b_device_n;
+    UInt_t m_b_flag;
+    ULong64_t m_b_ts_begin;
+    ULong64_t m_b_ts_end;
+    UInt_t m_b_n_hit;
+    std::vector<UInt_t> m_b_plane;
+    std::vector<Float_t> m_b_x;
+    std::vector<Float_t> m_b_y;
+    std::vector<Float_t> m_b_charge;
+    std::vector<ULong64_t> m_b_time;
+    std::vector<TBranch*> m_br_hit;
+  };
+
+  TTreeHitFileWriter::TTreeHitFileWriter(const std::string &patt)
+    :m_filepattern(patt), m_run_n(0), m_ttree(nullptr){
+  }
+
+  TTreeHitFileWriter::~TTreeHitFileWriter(){
+    Close();
+  }
+
+  void TTreeHitFileWriter::Open(uint32_t run_n){
+    Close();
+    auto conf = GetConfiguration();
+    int compress = conf ? conf->Get("ROOT_COMPRESSION", 404) : 404;
+    int basket = conf ? conf->Get("ROOT_BASKET_SIZE", 256000) : 256000;
+    int flush_mb = conf ? conf->Get("ROOT_AUTOFLUSH_MB", 32) : 32;
+    int imt = conf ? conf->Get("ROOT_IMT_THREADS", 0) : 0;
+    // baskets of all branches are compressed in parallel when a cluster is
+    // flushed; implicit MT is process wide, so only on request
+    if(imt > 0 && !ROOT::IsImplicitMTEnabled())
+      ROOT::EnableImplicitMT(imt);
+
+    std::time_t time_now = std::time(nullptr);
+    char time_buff[13];
+    time_buff[12] = 0;
+    std::strftime(time_buff, sizeof(time_buff), "%y%m%d%H%M%S", std::localtime(&time_now));
+    std::string time_str(time_buff);
+    std::string foutput(FileNamer(m_filepattern).Set('X', ".root").Set('R', run_n).Set('D', time_str));
+    m_tfile.reset(new TFile(foutput.c_str(), "RECREATE", "", compress));
+    if(m_tfile->IsZombie()){
+      m_tfile.reset();
+      EUDAQ_THROW("TTreeHitFileWriter: Fail to open ROOT file " + foutput);
+    }
+    EUDAQ_INFO("Preparing the outputfile: " + foutput);
+    m_run_n = run_n;
+
+    m_ttree = new TTree("Hits", "StandardEvent hits converted from .raw");
+    m_ttree->SetAutoFlush(-static_cast<Long64_t>(flush_mb) * 1024 * 1024);
+    m_ttree->Branch("run_n", &m_b_run_n, "run_n/i", basket);
+    m_ttree->Branch("event_n", &m_b_event_n, "event_n/i", basket);
+    m_ttree->Branch("trigger_n", &m_b_trigger_n, "trigger_n/i", basket);
+    m_ttree->Branch("device_n", &m_b_device_n, "device_n/i", basket);
+    m_ttree->Branch("event_flag", &m_b_flag, "event_flag/i", basket);
+    m_ttree->Branch("ts_begin", &m_b_ts_begin, "ts_begin/l", basket);
+    m_ttree->Branch("ts_end", &m_b_ts_end, "ts_end/l", basket);
+    m_ttree->Branch("n_hit", &m_b_n_hit, "n_hit/i", basket);
+    Reserve(1024);
+    m_br_hit.push_back(m_ttree->Branch("hit_plane", m_b_plane.data(), "hit_plane[n_hit]/i", basket));
+    m_br_hit.push_back(m_ttree->Branch("hit_x", m_b_x.data(), "hit_x[n_hit]/F", basket));
+    m_br_hit.push_back(m_ttree->Branch("hit_y", m_b_y.data(), "hit_y[n_hit]/F", basket));
+    m_br_hit.push_back(m_ttree->Branch("hit_charge", m_b_charge.data(), "hit_charge[n_hit]/F", basket));
+    m_br_hit.push_back(m_ttree->Branch("hit_time", m_b_time.data(), "hit_time[n_hit]/l", basket));
+  }
+
+  void TTreeHitFileWriter::Close(){
+    if(!m_tfile)
+      return;
+    m_tfile->cd();
+    m_ttree->Write("", TObject::kOverwrite);
+    m_tfile->Close();
+    m_tfile.reset();
+    m_ttree = nullptr;
+    m_br_hit.clear();
+  }
+
+  void TTreeHitFileWriter::Reserve(uint32_t n){
+    if(n <= m_b_plane.size())
+      return;
+    m_b_plane.resize(n);
+    m_b_x.resize(n);
+    m_b_y.resize(n);
+    m_b_charge.resize(n);
+    m_b_time.resize(n);
+    if(m_br_hit.empty())
+      return;
+    m_br_hit[0]->SetAddress(m_b_plane.data());
+    m_br_hit[1]->SetAddress(m_b_x.data());
+    m_br_hit[2]->SetAddress(m_b_y.data());
+    m_br_hit[3]->SetAddress(m_b_charge.data());
+    m_br_hit[4]->SetAddress(m_b_time.data());
+  }
+
+  void TTreeHitFileWriter::WriteEvent(EventSPC ev){
+    uint32_t run_n = ev->GetRunN();
+    if(!m_tfile || m_run_n != run_n)
+      Open(run_n);
+
+    m_b_run_n = run_n;
+    m_b_event_n = ev->GetEventN();
+    m_b_trigger_n = ev->GetTriggerN();
+    m_b_device_n = ev->GetDeviceN();
+    m_b_flag = ev->GetFlag();
+    m_b_ts_begin = ev->GetTimestampBegin();
+    m_b_ts_end = ev->GetTimestampEnd();
+    m_b_n_hit = 0;
+
+    auto stdev = StandardEvent::MakeShared();
+    bool ok = false;
+    try{
+      ok = StdEventConverter::Convert(ev, stdev, GetConfiguration());
+    }catch(const StdEventConverterException &e){
+      EUDAQ_WARN_LAZY(std::string("TTreeHitFileWriter: ") + e.what());
+    }
+    if(ok){
+      uint32_t n = 0;
+      for(size_t i = 0; i < stdev->NumPlanes(); i++)
+	n += stdev->GetPlane(i).HitPixels();
+      Reserve(n);
+      for(size_t i = 0; i < stdev->NumPlanes(); i++){
+	auto &plane = stdev->GetPlane(i);
+	uint32_t id = plane.ID();
+	uint32_t nh = plane.HitPixels();
+	for(uint32_t j = 0; j < nh; j++, m_b_n_hit++){
+	  m_b_plane[m_b_n_hit] = id;
+	  m_b_x[m_b_n_hit] = plane.GetX(j);
+	  m_b_y[m_b_n_hit] = plane.GetY(j);
+	  m_b_charge[m_b_n_hit] = plane.GetPixel(j);
+	  m_b_time[m_b_n_hit] = plane.GetTimestamp(j);
+	}
+      }
+      m_b_trigger_n = stdev->GetTriggerN();
+      m_b_ts_begin = stdev->GetTimestampBegin();
+      m_b_ts_end = stdev->GetTimestampEnd();
+    }
+    m_ttree->Fill();
+  }
+
+  uint64_t TTreeHitFileWriter::FileBytes() const{
+    return m_tfile ? static_cast<uint64_t>(m_tfile->GetBytesWritten()) : 0;
+  }
+}
@@ -32,6 +32,8 @@
 // STL includes
 #include <string>
 #include <memory>
+#include <chrono>
+#include <mutex>
 
 using namespace std;
 
@@ -43,7 +45,8 @@ class RootMonitor : public eudaq::Monitor{
 public:
   RootMonitor(const std::string &runcontrol, 
 	      int x, int y, int w, int h,
-              const std::string &conffile = "", const std::string &monname = "");
+              const std::string &conffile = "", const std::string &monname = "",
+              bool headless = false);
   ~RootMonitor() override;
   void DoConfigure() override;
   void DoStartRun() override;
@@ -61,6 +64,10 @@ class RootMonitor : public eudaq::Monitor{
   void setUseTrack_corr(const bool t_c);
   void setTracksPerEvent(const unsigned int tracks);
   void SetSnapShotDir(string s);
+  /// Headless mode: seconds between two snapshot files and files kept per run
+  void setSnapshotInterval(const unsigned int interval);
+  void setSnapshotKeep(const unsigned int keep);
+  void WriteSnapshot();
 
   bool getUseTrack_corr() const;
   unsigned int getTracksPerEvent() const;
@@ -90,6 +97,16 @@ class RootMonitor : public eudaq::Monitor{
   unsigned int tracksPerEvent;
   uint32_t m_plane_c;
   uint32_t m_ev_rec_n = 0;
+  bool m_headless;
+  bool m_autoreset = false;
+  unsigned int m_reduce = 1;
+  unsigned int m_snapshot_interval = 60;
+  unsigned int m_snapshot_keep = 10;
+  unsigned int m_snapshot_seq = 0;
+  uint32_t m_run_n = 0;
+  std::chrono::steady_clock::time_point m_snapshot_last;
+  // held while the collections are filled, reset or written
+  std::mutex m_mtx_fill;
 };
 
 #ifdef __CINT__
@@ -395,7 +395,7 @@ void CorrelationCollection::registerPlaneCorrelations(
   pair<SimpleStandardPlane, SimpleStandardPlane> pdouble(p1, p2);
   _map[pdouble] = tmphisto;
 
-  if (_mon != NULL) {
+  if (_mon != NULL && _mon->getOnlineMon() != NULL) {
     std::string dirName;
 
     if (_mon->getUseTrack_corr() == true)
@@ -427,7 +427,7 @@ void CorrelationCollection::registerPlaneCorrelations(
   }
 
 
-  if (_mon != NULL) {
+  if (_mon != NULL && _mon->getOnlineMon() != NULL) {
     std::string dirName;
 
     if (_mon->getUseTrack_corr() == true)
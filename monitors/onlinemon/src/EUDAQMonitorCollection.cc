@@ -43,7 +43,7 @@ void EUDAQMonitorCollection::Write(TFile *file) {
 
 void EUDAQMonitorCollection::bookHistograms(
     const SimpleStandardEvent & /*simpev*/) {
-  if (_mon != NULL) {
+  if (_mon != NULL && _mon->getOnlineMon() != NULL) {
     string performance_folder_name = "EUDAQ Monitor";
     _mon->getOnlineMon()->registerTreeItem(
         (performance_folder_name + "/Number of Planes"));
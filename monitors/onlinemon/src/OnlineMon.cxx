@@ -40,6 +40,10 @@
 #include <chrono>
 #include <thread>
 #include <memory>
+#include <cstdio>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 //ONLINE MONITOR Includes
 #include "OnlineMon.hh"
@@ -50,13 +54,18 @@ using namespace std;
 
 RootMonitor::RootMonitor(const std::string & runcontrol,
 			 int /*x*/, int /*y*/, int /*w*/, int /*h*/,
-			 const std::string & conffile, const std::string & monname)
-  :eudaq::Monitor(monname, runcontrol), _planesInitialized(false), onlinemon(NULL){
-  onlinemon = new OnlineMonWindow(gClient->GetRoot(),800,600);
-
-  if (onlinemon==NULL){
-    std::cerr<< "Error Allocationg OnlineMonWindow"<<endl;
-    exit(-1);
+			 const std::string & conffile, const std::string & monname,
+			 bool headless)
+  :eudaq::Monitor(monname, runcontrol), _planesInitialized(false), onlinemon(NULL),
+   m_headless(headless){
+  // without a window the collections do not register their histograms for display
+  if(!m_headless){
+    onlinemon = new OnlineMonWindow(gClient->GetRoot(),800,600);
+
+    if (onlinemon==NULL){
+      std::cerr<< "Error Allocationg OnlineMonWindow"<<endl;
+      exit(-1);
+    }
   }
 
   m_plane_c = 0;
@@ -82,7 +91,8 @@ RootMonitor::RootMonitor(const std::string & runcontrol,
   eudaqCollection->setRootMonitor(this);
   paraCollection->setRootMonitor(this);
 
-  onlinemon->setCollections(_colls);
+  if(onlinemon)
+    onlinemon->setCollections(_colls);
 
   // Config for converters
   eu_cfgPtr = eudaq::Configuration::MakeUniqueReadFile(conffile);
@@ -109,12 +119,14 @@ RootMonitor::RootMonitor(const std::string & runcontrol,
   previous_event_clustering_time=0;
   previous_event_correlation_time=0;
 
-  onlinemon->SetOnlineMon(this);    
+  if(onlinemon)
+    onlinemon->SetOnlineMon(this);
 
 }
 
 RootMonitor::~RootMonitor(){
-  gApplication->Terminate();
+  if(gApplication)
+    gApplication->Terminate();
 }
 
 OnlineMonWindow* RootMonitor::getOnlineMon() const {
@@ -133,7 +145,9 @@ void RootMonitor::setCorr_planes(const unsigned c_p) {
 }
 
 void RootMonitor::setReduce(const unsigned int red) {
-  onlinemon->setReduce(red);
+  m_reduce = red;
+  if(onlinemon)
+    onlinemon->setReduce(red);
   for (unsigned int i = 0 ; i < _colls.size(); ++i)
   {
     _colls.at(i)->setReduce(red);
@@ -162,13 +176,16 @@ void RootMonitor::DoConfigure(){
 }
 
 void RootMonitor::DoTerminate(){
-  gApplication->Terminate();
+  if(gApplication)
+    gApplication->Terminate();
 }  
 
 void RootMonitor::DoReceive(eudaq::EventSP evsp) {
-  if(evsp->GetEventN() > 10 && evsp->GetEventN() % onlinemon->getReduce() != 0){
+  unsigned int reduce = onlinemon ? onlinemon->getReduce() : m_reduce;
+  if(evsp->GetEventN() > 10 && evsp->GetEventN() % reduce != 0){
     return;
   }
+  std::unique_lock<std::mutex> lk(m_mtx_fill);
   
   auto stdev = std::dynamic_pointer_cast<eudaq::StandardEvent>(evsp);
   if(!stdev){
@@ -299,19 +316,31 @@ void RootMonitor::DoReceive(eudaq::EventSP evsp) {
         }
     }
 
-  onlinemon->setEventNumber(stdev->GetEventNumber());
-  onlinemon->increaseAnalysedEventsCounter();
+  if(onlinemon){
+    onlinemon->setEventNumber(stdev->GetEventNumber());
+    onlinemon->increaseAnalysedEventsCounter();
+  }
     
   my_event_processing_time.Stop();
   previous_event_fill_time=my_event_processing_time.RealTime();
+
+  // the histograms are only filled here, so the snapshots are written here too
+  if(m_headless && m_snapshot_interval &&
+     std::chrono::steady_clock::now() - m_snapshot_last >= std::chrono::seconds(m_snapshot_interval)){
+    WriteSnapshot();
+  }
 }
 
 void RootMonitor::autoReset(const bool reset) {
-  onlinemon->setAutoReset(reset);
+  m_autoreset = reset;
+  if(onlinemon)
+    onlinemon->setAutoReset(reset);
 }
 
 void RootMonitor::DoStopRun()
 {
+  // called on the command thread while events may still be received
+  std::unique_lock<std::mutex> lk(m_mtx_fill);
   m_plane_c = 0;
   m_ev_rec_n = 0;
 
@@ -324,17 +353,22 @@ void RootMonitor::DoStopRun()
     }
     f->Close();
   }
-  onlinemon->UpdateStatus("Run stopped");
+  if(m_headless)
+    WriteSnapshot();
+  if(onlinemon)
+    onlinemon->UpdateStatus("Run stopped");
 }
 
 void RootMonitor::DoStartRun() {
+  std::unique_lock<std::mutex> lk(m_mtx_fill);
   m_plane_c = 0;
   m_ev_rec_n = 0;
   uint32_t runnumber = GetRunNumber();
 
-  if (onlinemon->getAutoReset())
+  if (onlinemon ? onlinemon->getAutoReset() : m_autoreset)
   {
-    onlinemon->UpdateStatus("Resetting..");
+    if(onlinemon)
+      onlinemon->UpdateStatus("Resetting..");
     for (unsigned int i = 0 ; i < _colls.size(); ++i)
     {
       if (_colls.at(i) != NULL)
@@ -342,19 +376,80 @@ void RootMonitor::DoStartRun() {
     }
   }
 
-  onlinemon->UpdateStatus("Starting run..");
   char out[255];
   sprintf(out, "run%d.root", runnumber);
   rootfilename = std::string(out);
-  onlinemon->setRunNumber(runnumber);
-  onlinemon->setRootFileName(rootfilename);
+  m_run_n = runnumber;
+  m_snapshot_seq = 0;
+  m_snapshot_last = std::chrono::steady_clock::now();
+  if(onlinemon){
+    onlinemon->UpdateStatus("Starting run..");
+    onlinemon->setRunNumber(runnumber);
+    onlinemon->setRootFileName(rootfilename);
+  }
 
   // Reset the planes initializer on new run start:
   _planesInitialized = false;
 }
 
 void RootMonitor::setUpdate(const unsigned int up) {
-  onlinemon->setUpdate(up);
+  if(onlinemon)
+    onlinemon->setUpdate(up);
+}
+
+void RootMonitor::setSnapshotInterval(const unsigned int interval) {
+  m_snapshot_interval = interval;
+}
+
+void RootMonitor::setSnapshotKeep(const unsigned int keep) {
+  m_snapshot_keep = keep;
+}
+
+// Writes all collections to <SnapShotDir>Snapshot_<run>_<seq>.root, keeping the
+// last m_snapshot_keep files of the run. The file is renamed into place once
+// complete and hard linked (or copied) as Snapshot_latest.root, so that a viewer never
+// opens a partially written snapshot. Called with m_mtx_fill held.
+void RootMonitor::WriteSnapshot(){
+  m_snapshot_last = std::chrono::steady_clock::now();
+  std::string base = snapshotdir + "Snapshot_" + std::to_string(m_run_n) + "_";
+  std::string tmpname = base + "tmp.root";
+  {
+    TFile f(tmpname.c_str(), "RECREATE");
+    if(f.IsZombie()){
+      EUDAQ_WARN("OnlineMon: unable to write the snapshot " + tmpname);
+      return;
+    }
+    for (unsigned int i = 0 ; i < _colls.size(); ++i)
+      _colls.at(i)->Write(&f);
+    f.Close();
+  }
+  std::string filename = base + std::to_string(m_snapshot_seq) + ".root";
+  std::string latest = snapshotdir + "Snapshot_latest.root";
+  std::string latest_tmp = latest + ".tmp";
+  std::rename(tmpname.c_str(), filename.c_str());
+  std::remove(latest_tmp.c_str());
+#ifndef _WIN32
+  bool linked = link(filename.c_str(), latest_tmp.c_str()) == 0;
+#else
+  bool linked = false;
+#endif
+  if(!linked){
+    // no hard links, copy instead
+    std::ifstream src(filename, std::ios::binary);
+    std::ofstream dst(latest_tmp, std::ios::binary);
+    dst<<src.rdbuf();
+    linked = src && dst;
+  }
+  if(linked){
+    // rename does not replace an existing file on WIN32
+#ifdef _WIN32
+    std::remove(latest.c_str());
+#endif
+    std::rename(latest_tmp.c_str(), latest.c_str());
+  }
+  if(m_snapshot_keep && m_snapshot_seq >= m_snapshot_keep)
+    std::remove((base + std::to_string(m_snapshot_seq - m_snapshot_keep) + ".root").c_str());
+  m_snapshot_seq++;
 }
 
 //sets the location for the snapshots
@@ -413,6 +508,9 @@ int main(int argc, const char ** argv) {
   eudaq::Option<std::string>     monitorname(op, "t", "monitor_name","StdEventMonitor", "StdEventMonitor","Name for onlinemon");	
   eudaq::OptionFlag do_rootatend (op, "rf","root","Write out root-file after each run");
   eudaq::OptionFlag do_resetatend (op, "rs","reset","Reset Histograms when run stops");
+  eudaq::OptionFlag headless (op, "hl","headless","Run without GUI, writing snapshot files of the histograms to the SnapShotDir");
+  eudaq::Option<unsigned>        snapshot_interval(op, "si", "snapshot_interval", 60, "seconds", "headless mode - seconds between two snapshot files, 0 for one at the end of run only");
+  eudaq::Option<unsigned>        snapshot_keep(op, "sk", "snapshot_keep", 10, "files", "headless mode - snapshot files kept per run, 0 to keep all");
   
   try {
     op.Parse(argv);
@@ -429,10 +527,14 @@ int main(int argc, const char ** argv) {
   if(!rctrl.IsSet())
     rctrl.SetValue("tcp://localhost:44000");
     
-  TApplication theApp("App", &argc, const_cast<char**>(argv),0,0);
+  std::unique_ptr<TApplication> theApp;
+  if(headless.IsSet())
+    gROOT->SetBatch(kTRUE);
+  else
+    theApp.reset(new TApplication("App", &argc, const_cast<char**>(argv),0,0));
   RootMonitor mon(rctrl.Value(),
 		  100, 0, 1400, 700,
-                  configfile.Value(), monitorname.Value());
+                  configfile.Value(), monitorname.Value(), headless.IsSet());
   mon.setWriteRoot(do_rootatend.IsSet());
   mon.autoReset(do_resetatend.IsSet());
   mon.setReduce(reduce.Value());
@@ -440,6 +542,8 @@ int main(int argc, const char ** argv) {
   mon.setCorr_width(corr_width.Value());
   mon.setCorr_planes(corr_planes.Value());
   mon.setUseTrack_corr(track_corr.Value());
+  mon.setSnapshotInterval(snapshot_interval.Value());
+  mon.setSnapshotKeep(snapshot_keep.Value());
   eudaq::Monitor *m = dynamic_cast<eudaq::Monitor*>(&mon);
   std::future<uint64_t> fut_async_rd;
 
@@ -456,7 +560,12 @@ int main(int argc, const char ** argv) {
     m->Connect();
   }
 
-  theApp.Run(); //execute
+  if(theApp)
+    theApp->Run(); //execute
+  else if(!offline){
+    while(mon.IsConnected())
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  }
   if(fut_async_rd.valid())
     fut_async_rd.get();
   return 0;
@@ -82,7 +82,7 @@ void ParaMonitorCollection::Fill(const SimpleStandardEvent &simpev) {
 
 void ParaMonitorCollection::bookHistograms(
     const SimpleStandardEvent & /*simpev*/) {
-  if (_mon != NULL) {
+  if (_mon != NULL && _mon->getOnlineMon() != NULL) {
     string folder_name = "Paramater Monitor";
     for(auto &e: m_graphMap){
       std::string name = folder_name+"/"+e.first;
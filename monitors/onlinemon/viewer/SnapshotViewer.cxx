@@ -0,0 +1,106 @@
+// ROOT includes
+#include "TApplication.h"
+#include "TBrowser.h"
+#include "TCanvas.h"
+#include "TFile.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TGraph.h"
+#include "TTimer.h"
+
+// EUDAQ includes
+#include "eudaq/OptionParser.hh"
+#include "eudaq/Utils.hh"
+
+// STL includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <memory>
+
+// Displays the snapshot files written by StdEventMonitor --headless, either
+// in a TBrowser or as a fixed set of histograms reloaded periodically.
+namespace{
+  class SnapshotCanvas : public TTimer {
+  public:
+    SnapshotCanvas(const std::string &file, const std::vector<std::string> &paths, long ms)
+      :TTimer(ms), m_file(file), m_paths(paths), m_objs(paths.size(), nullptr){
+      int nx = std::ceil(std::sqrt(double(paths.size())));
+      int ny = (paths.size() + nx - 1) / nx;
+      m_canvas = new TCanvas("SnapshotViewer", file.c_str(), 1200, 800);
+      m_canvas->Divide(nx, ny);
+    }
+    // Reads the objects again from the file, which is replaced as a whole by the monitor
+    void Reload(){
+      std::unique_ptr<TFile> f(TFile::Open(m_file.c_str(), "READ"));
+      if(!f || f->IsZombie()){
+	std::cerr<<"SnapshotViewer: unable to open "<<m_file<<std::endl;
+	return;
+      }
+      for(size_t i = 0; i < m_paths.size(); i++){
+	TObject *obj = f->Get(m_paths[i].c_str());
+	if(!obj){
+	  std::cerr<<"SnapshotViewer: no "<<m_paths[i]<<" in "<<m_file<<std::endl;
+	  continue;
+	}
+	m_canvas->cd(i + 1);
+	if(dynamic_cast<TH2*>(obj))
+	  obj->Draw("COLZ");
+	else if(dynamic_cast<TGraph*>(obj))
+	  obj->Draw("AP");
+	else
+	  obj->Draw();
+	delete m_objs[i];
+	m_objs[i] = obj;
+      }
+      m_canvas->Update();
+    }
+    Bool_t Notify() override {
+      Reload();
+      Reset();
+      return kTRUE;
+    }
+  private:
+    std::string m_file;
+    std::vector<std::string> m_paths;
+    std::vector<TObject*> m_objs;
+    TCanvas *m_canvas;
+  };
+}
+
+int main(int argc, const char **argv) {
+  eudaq::OptionParser op("EUDAQ StdEventMonitor Snapshot Viewer", "1.0", "Displays the snapshot files of a headless StdEventMonitor");
+  eudaq::Option<std::string> file(op, "f", "file", "../snapshots/Snapshot_latest.root", "filename", "snapshot file");
+  eudaq::Option<std::string> paths(op, "p", "paths", "", "path1,path2", "objects to draw, e.g. Hitmaps/MIMOSA26_1/..., all in a browser if empty");
+  eudaq::Option<unsigned> update(op, "u", "update", 10, "seconds", "reload the objects every <num> seconds, 0 to disable");
+  try {
+    op.Parse(argv);
+  } catch (...) {
+    return op.HandleMainException();
+  }
+
+  // the objects read are owned by the viewer, not by the file
+  TH1::AddDirectory(kFALSE);
+  TApplication theApp("App", &argc, const_cast<char**>(argv), 0, 0);
+  std::vector<std::string> objs;
+  for(auto &p: eudaq::split(paths.Value(), ",", true))
+    if(!p.empty())
+      objs.push_back(p);
+  if(objs.empty()){
+    TFile *f = TFile::Open(file.Value().c_str(), "READ");
+    if(!f || f->IsZombie()){
+      std::cerr<<"SnapshotViewer: unable to open "<<file.Value()<<std::endl;
+      return 1;
+    }
+    new TBrowser("SnapshotViewer", f);
+  }
+  else{
+    SnapshotCanvas *sc = new SnapshotCanvas(file.Value(), objs, update.Value() * 1000);
+    sc->Reload();
+    if(update.Value())
+      sc->TurnOn();
+  }
+  theApp.Run();
+  return 0;
+}
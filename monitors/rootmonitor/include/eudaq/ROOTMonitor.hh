@@ -1,5 +1,6 @@
 #include "eudaq/Monitor.hh"
 #include "eudaq/ROOTMonitorWindow.hh"
+#include "eudaq/ROOTMonitorShards.hh"
 
 #ifndef __CINT__
 # include "TApplication.h"
@@ -33,21 +34,48 @@ namespace eudaq {
     virtual void AtEventReception(eudaq::EventSP ev) = 0;
     virtual void AtReset() {}
 
+    /// Merge the sharded monitors into the displayed ones, at each refresh of the window
+    void MergeShards();
+
   private:
     void LoadRAWFile(const std::string& path);
+    void ResetShards();
 
     bool m_interrupt = false;
     std::unique_ptr<TApplication> m_app;
     std::future<void> m_daemon;
     std::vector<std::future<void> > m_daemon_load;
-    unsigned long long m_num_evt_mon = 0ull;
+    std::atomic<unsigned long long> m_num_evt_mon{0ull};
+    std::mutex m_mtx_counters;
 
     // global monitoring plots
-    TH1D* m_glob_evt_reco_time, *m_glob_evt_num_subevt;
-    TGraph* m_glob_evt_vs_ts, *m_glob_rate_vs_ts;
-    unsigned long long m_glob_last_evt_ts = 0ull;
+    ShardedHist<TH1D>* m_glob_evt_reco_time, *m_glob_evt_num_subevt;
+    ShardedGraph* m_glob_evt_vs_ts, *m_glob_rate_vs_ts;
+    std::atomic<uint64_t> m_glob_last_evt_ts{0ull};
+
+    std::mutex m_mtx_shards;
+    std::map<std::string, std::unique_ptr<ShardedObject> > m_shards;
 
   protected:
+    /// Book a histogram filled through per-thread shards (see ShardedHist)
+    template<typename T, typename... Args>
+    ShardedHist<T>* BookSharded(const std::string& path, const std::string& name, Args&&... args) {
+      std::lock_guard<std::mutex> lk(m_mtx_shards);
+      auto it = m_shards.find(path);
+      if (it != m_shards.end())
+        return dynamic_cast<ShardedHist<T>*>(it->second.get());
+      auto hist = new ShardedHist<T>(m_monitor->Book<T>(path, name, std::forward<Args>(args)...), m_shard_n);
+      m_shards[path].reset(hist);
+      return hist;
+    }
+    /// Book a graph filled through per-thread shards (see ShardedGraph)
+    ShardedGraph* BookShardedGraph(const std::string& path, const std::string& name);
+
     std::unique_ptr<ROOTMonitorWindow> m_monitor;
+    /// Set by the monitors whose AtEventReception may run in several threads at once
+    /// (sharded monitors only, or own locking), to replay files in parallel
+    bool m_parallel_fill = false;
+    /// Number of shards of the sharded monitors, FILL_SHARDS in the configuration
+    size_t m_shard_n;
   };
 }
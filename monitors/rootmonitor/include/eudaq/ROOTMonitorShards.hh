@@ -0,0 +1,144 @@
+#ifndef EUDAQ_INCLUDED_ROOTMonitorShards
+#define EUDAQ_INCLUDED_ROOTMonitorShards
+
+#include "TGraph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace eudaq {
+  /// Index of the shard used by the calling thread among n shards
+  inline size_t ShardIndex(size_t n) {
+    static std::atomic<size_t> next_slot(0);
+    thread_local size_t slot = next_slot++;
+    return slot % n;
+  }
+
+  /**
+   * A monitored object filled through per-thread accumulators (shards).
+   * The filling threads only lock the shard of their own thread, which is
+   * otherwise only touched for a pointer swap by Merge(). Merge() is called
+   * at each refresh of the window from the GUI thread: it adds all shards to
+   * the displayed object at once, so that the drawn object is a consistent
+   * snapshot and a redraw never delays the filling.
+   */
+  class ShardedObject {
+  public:
+    virtual ~ShardedObject() = default;
+    /// Add the content accumulated since the last call to the displayed object
+    virtual void Merge() = 0;
+    /// Drop the content accumulated since the last call
+    virtual void Reset() = 0;
+    /// Change the number of shards, dropping their content; not while filling
+    virtual void SetShardCount(size_t n_shard) = 0;
+  };
+
+  /// A TH1-derived histogram (TH1x, TH2x, TProfile, ...) with per-thread shards
+  template<typename T> class ShardedHist : public ShardedObject {
+  public:
+    ShardedHist(T* display, size_t n_shard) : m_display(display) {
+      SetShardCount(n_shard);
+    }
+    /// Fill the shard of the calling thread, same arguments as T::Fill
+    template<typename... Args> void Fill(Args&&... args) {
+      auto& shard = *m_shards[ShardIndex(m_shards.size())];
+      std::lock_guard<std::mutex> lk(shard.mtx);
+      shard.hist->Fill(std::forward<Args>(args)...);
+    }
+    void Merge() override {
+      for (auto& shard : m_shards) {
+        {
+          std::lock_guard<std::mutex> lk(shard->mtx);
+          std::swap(shard->hist, shard->spare);
+        }
+        if (shard->spare->GetEntries() > 0) {
+          m_display->Add(shard->spare.get());
+          shard->spare->Reset();
+        }
+      }
+    }
+    void Reset() override {
+      for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lk(shard->mtx);
+        shard->hist->Reset();
+      }
+    }
+    void SetShardCount(size_t n_shard) override {
+      m_shards.resize(std::min(m_shards.size(), std::max<size_t>(n_shard, 1)));
+      Reset();
+      while (m_shards.size() < std::max<size_t>(n_shard, 1)) {
+        m_shards.emplace_back(new Shard);
+        m_shards.back()->hist.reset(Empty());
+        m_shards.back()->spare.reset(Empty());
+      }
+    }
+    /// The displayed object, only to be modified from the GUI thread
+    T* GetDisplay() const { return m_display; }
+
+  private:
+    T* Empty() const {
+      auto hist = static_cast<T*>(m_display->Clone());
+      hist->SetDirectory(nullptr);
+      hist->Reset();
+      return hist;
+    }
+    struct Shard {
+      std::mutex mtx;
+      std::unique_ptr<T> hist, spare;
+    };
+    T* m_display;
+    std::vector<std::unique_ptr<Shard> > m_shards;
+  };
+
+  /// A TGraph whose points are collected per thread and appended at the refresh
+  class ShardedGraph : public ShardedObject {
+  public:
+    ShardedGraph(TGraph* display, size_t n_shard) : m_display(display) {
+      SetShardCount(n_shard);
+    }
+    void AddPoint(double x, double y) {
+      auto& shard = *m_shards[ShardIndex(m_shards.size())];
+      std::lock_guard<std::mutex> lk(shard.mtx);
+      shard.points.emplace_back(x, y);
+    }
+    void Merge() override {
+      std::vector<std::pair<double, double> > points;
+      for (auto& shard : m_shards) {
+        {
+          std::lock_guard<std::mutex> lk(shard->mtx);
+          std::swap(shard->points, points);
+        }
+        for (auto& p : points)
+          m_display->SetPoint(m_display->GetN(), p.first, p.second);
+        points.clear();
+      }
+    }
+    void Reset() override {
+      for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lk(shard->mtx);
+        shard->points.clear();
+      }
+    }
+    void SetShardCount(size_t n_shard) override {
+      m_shards.resize(std::min(m_shards.size(), std::max<size_t>(n_shard, 1)));
+      Reset();
+      while (m_shards.size() < std::max<size_t>(n_shard, 1))
+        m_shards.emplace_back(new Shard);
+    }
+    TGraph* GetDisplay() const { return m_display; }
+
+  private:
+    struct Shard {
+      std::mutex mtx;
+      std::vector<std::pair<double, double> > points;
+    };
+    TGraph* m_display;
+    std::vector<std::unique_ptr<Shard> > m_shards;
+  };
+}
+
+#endif
@@ -37,6 +37,8 @@ namespace eudaq{
     void SetLastEventNum(int num = -1);
     /// Specify the number of events already processed
     void SetMonitoredEventsNum(int num = -1);
+    /// Specify the rate of a file replay (0 when not replaying)
+    void SetReplayRate(double rate) { m_replay_rate = rate; }
     /// Add a summary page including several monitors
     void AddSummary(const std::string& path, const TObject* obj);
 
@@ -103,6 +105,8 @@ namespace eudaq{
     void Quit();
     /// Reprocess monitors from a RAW file
     void FillFromRAWFile(const char* path);
+    /// Signal emitted at each refresh before drawing, to merge the sharded monitors
+    void Merge();
 
   private:
     /// List of status bar attributes
@@ -167,6 +171,7 @@ namespace eudaq{
     int m_run_number = -1;
     unsigned long long m_last_event = 0;
     unsigned long long m_last_event_mon = 0;
+    double m_replay_rate = 0.;
 
     ClassDef(ROOTMonitorWindow, 0);
   };
@@ -1,11 +1,15 @@
 #include "eudaq/ROOTMonitor.hh"
-#include "eudaq/FileDeserializer.hh"
 #include "eudaq/FileReader.hh"
 #include "eudaq/DataConverter.hh"
 
 #include "TH1.h"
 #include "TGraph.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
 #include <ratio>
 #include <chrono>
 #include <thread>
@@ -14,13 +18,15 @@ namespace eudaq {
   ROOTMonitor::ROOTMonitor(const std::string & name, const std::string & title, const std::string & runcontrol)
     :Monitor(name, runcontrol),
      m_app(new TApplication(name.c_str(), nullptr, nullptr)),
-     m_monitor(new ROOTMonitorWindow(m_app.get(), title)){
+     m_monitor(new ROOTMonitorWindow(m_app.get(), title)),
+     m_shard_n(std::max(1u, std::min(8u, std::thread::hardware_concurrency()))){
     if (!m_monitor)
       EUDAQ_THROW("Error allocating main window");
 
     m_monitor->SetStatus(eudaq::Status::STATE_UNINIT);
     m_monitor->Connect("FillFromRAWFile(const char*)", NAME, this, "LoadRAWFileAsync(const char*)");
     m_monitor->Connect("Quit()", NAME, this, "DoTerminate()");
+    m_monitor->Connect("Merge()", NAME, this, "MergeShards()");
 
     // launch the run loop
     m_app->SetReturnFromRun(true);
@@ -30,48 +36,69 @@ namespace eudaq {
 
   void ROOTMonitor::DoInitialise(){
     m_monitor->ResetCounters();
+    ResetShards();
     m_monitor->SetStatus(eudaq::Status::STATE_STOPPED);
     AtInitialisation();
-    m_glob_evt_reco_time = m_monitor->Book<TH1D>("Global/event_reco_time", "Event reconstruction time",
-                                                 "event_reco_time", ";Event reconstruction time (ms)", 100, 0., 2.5);
-    m_glob_evt_num_subevt = m_monitor->Book<TH1D>("Global/num_subevts", "Number of sub-events",
-                                                  "num_subevts", ";Number of sub-events", 10, 0., 10.);
-    m_monitor->SetDrawOptions(m_glob_evt_num_subevt, "hist text0");
-    m_glob_evt_vs_ts = m_monitor->Book<TGraph>("Global/evt_vs_ts", "Event timestamp");
-    m_glob_evt_vs_ts->SetTitle(";Time (s);Event ID");
-    m_glob_rate_vs_ts = m_monitor->Book<TGraph>("Global/rate_vs_ts", "Rate evolution");
-    m_glob_rate_vs_ts->SetTitle(";Time (s);Event rate (Hz)");
+    m_glob_evt_reco_time = BookSharded<TH1D>("Global/event_reco_time", "Event reconstruction time",
+                                             "event_reco_time", ";Event reconstruction time (ms)", 100, 0., 2.5);
+    m_glob_evt_num_subevt = BookSharded<TH1D>("Global/num_subevts", "Number of sub-events",
+                                              "num_subevts", ";Number of sub-events", 10, 0., 10.);
+    m_monitor->SetDrawOptions(m_glob_evt_num_subevt->GetDisplay(), "hist text0");
+    m_glob_evt_vs_ts = BookShardedGraph("Global/evt_vs_ts", "Event timestamp");
+    m_glob_evt_vs_ts->GetDisplay()->SetTitle(";Time (s);Event ID");
+    m_glob_rate_vs_ts = BookShardedGraph("Global/rate_vs_ts", "Rate evolution");
+    m_glob_rate_vs_ts->GetDisplay()->SetTitle(";Time (s);Event rate (Hz)");
   }
 
   void ROOTMonitor::DoConfigure(){
     m_monitor->SetStatus(eudaq::Status::STATE_CONF);
     m_monitor->ResetCounters();
+    ResetShards();
+    auto conf = GetConfiguration();
+    if (conf) {
+      // the plots are booked at the initialisation, with the previous count
+      size_t shard_n = std::max(1, conf->Get("FILL_SHARDS", (int)m_shard_n));
+      if (shard_n != m_shard_n) {
+        m_shard_n = shard_n;
+        std::lock_guard<std::mutex> lk(m_mtx_shards);
+        for (auto& shard : m_shards)
+          shard.second->SetShardCount(m_shard_n);
+      }
+    }
     AtConfiguration();
   }
 
   void ROOTMonitor::DoStartRun(){
     m_monitor->ResetCounters();
+    ResetShards();
     m_monitor->SetStatus(eudaq::Status::STATE_RUNNING);
     m_monitor->SetRunNumber(GetRunNumber());
+    m_glob_last_evt_ts = 0;
     AtRunStart();
   }
 
   void ROOTMonitor::DoReceive(eudaq::EventSP ev){
     auto start = std::chrono::system_clock::now();
     // update the counters
-    m_monitor->SetCounters(ev->GetEventN(), ++m_num_evt_mon);
+    {
+      std::lock_guard<std::mutex> lk(m_mtx_counters);
+      m_monitor->SetCounters(ev->GetEventN(), ++m_num_evt_mon);
+    }
     // user-specific filling part
     AtEventReception(ev);
     // global event information
     std::chrono::duration<double> elapsed_sec = std::chrono::system_clock::now()-start;
     m_glob_evt_reco_time->Fill(elapsed_sec.count()*1.e3);
     m_glob_evt_num_subevt->Fill(ev->GetNumSubEvent());
-    if (ev->GetTimestampBegin() != 0) {
-      m_glob_evt_vs_ts->SetPoint(m_glob_evt_vs_ts->GetN(), ev->GetTimestampBegin(), ev->GetEventID());
-      const double rate = (ev->GetTimestampBegin() != m_glob_last_evt_ts)
-        ? 1./(ev->GetTimestampBegin()-m_glob_last_evt_ts) : 0.;
-      m_glob_rate_vs_ts->SetPoint(m_glob_rate_vs_ts->GetN(), ev->GetTimestampBegin(), rate);
-      m_glob_last_evt_ts = ev->GetTimestampBegin();
+    const uint64_t ts = ev->GetTimestampBegin();
+    if (ts != 0) {
+      m_glob_evt_vs_ts->AddPoint(ts, ev->GetEventID());
+      // the filling threads see the events out of order: the rate is only
+      // taken from events later than all the previous ones
+      uint64_t last_ts = m_glob_last_evt_ts.load();
+      while (ts > last_ts && !m_glob_last_evt_ts.compare_exchange_weak(last_ts, ts));
+      if (last_ts != 0 && ts > last_ts)
+        m_glob_rate_vs_ts->AddPoint(ts, 1./(ts-last_ts));
     }
   }
 
@@ -83,6 +110,7 @@ namespace eudaq {
   void ROOTMonitor::DoReset(){
     m_monitor->SetStatus(eudaq::Status::STATE_UNINIT);
     m_monitor->ResetCounters();
+    ResetShards();
     AtReset();
   }
 
@@ -93,6 +121,28 @@ namespace eudaq {
     m_app->Terminate(1);
   }
 
+  ShardedGraph* ROOTMonitor::BookShardedGraph(const std::string& path, const std::string& name){
+    std::lock_guard<std::mutex> lk(m_mtx_shards);
+    auto it = m_shards.find(path);
+    if (it != m_shards.end())
+      return dynamic_cast<ShardedGraph*>(it->second.get());
+    auto graph = new ShardedGraph(m_monitor->Book<TGraph>(path, name), m_shard_n);
+    m_shards[path].reset(graph);
+    return graph;
+  }
+
+  void ROOTMonitor::MergeShards(){
+    std::lock_guard<std::mutex> lk(m_mtx_shards);
+    for (auto& shard : m_shards)
+      shard.second->Merge();
+  }
+
+  void ROOTMonitor::ResetShards(){
+    std::lock_guard<std::mutex> lk(m_mtx_shards);
+    for (auto& shard : m_shards)
+      shard.second->Reset();
+  }
+
   void ROOTMonitor::LoadRAWFileAsync(const char* path){
     EUDAQ_INFO(GetName()+" will load \""+std::string(path)+"\".");
     if (!m_daemon_load.empty()) {
@@ -103,30 +153,117 @@ namespace eudaq {
   }
 
   void ROOTMonitor::LoadRAWFile(const std::string& path){
-    uint32_t id;
-    unsigned long long num_evts = 0;
-    bool first_evt = true;
     DoInitialise();
     DoConfigure();
-    eudaq::EventUP ev;
-    eudaq::FileDeserializer reader(path);
-    do {
-      if (m_interrupt)
-        return;
-      reader.PreRead(id);
-      ev = eudaq::Factory<eudaq::Event>::Create<eudaq::Deserializer&>(id, reader);
-      eudaq::EventSP evt(std::move(ev));
+    // replay options, from the configuration of the monitor if any
+    size_t n_thread = m_parallel_fill ? m_shard_n : 1;
+    uint32_t every = 1, ev_begin = 0, ev_end = UINT32_MAX;
+    uint64_t ts_begin = 0, ts_end = UINT64_MAX;
+    auto conf = GetConfiguration();
+    if (conf) {
+      if (m_parallel_fill)
+        n_thread = std::max(1, conf->Get("REPLAY_THREADS", (int)n_thread));
+      every = std::max(1, conf->Get("REPLAY_EVERY", 1));
+      ev_begin = conf->Get("REPLAY_EVENT_BEGIN", ev_begin);
+      ev_end = conf->Get("REPLAY_EVENT_END", ev_end);
+      ts_begin = conf->Get("REPLAY_TS_BEGIN", ts_begin);
+      ts_end = conf->Get("REPLAY_TS_END", ts_end);
+    }
+    // the index of a compressed file lets the reader skip the chunks out of the event range
+    const std::string ext = path.substr(path.find_last_of('.')+1);
+    auto reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash(ext == "rawz" ? "rawz" : "native"), path);
+    auto reader_conf = std::make_shared<eudaq::Configuration>();
+    reader_conf->Set("RAWZ_THREADS", n_thread);
+    reader_conf->Set("RAWZ_EVENT_BEGIN", ev_begin);
+    reader_conf->Set("RAWZ_EVENT_END", ev_end);
+    reader->SetConfiguration(reader_conf);
+
+    // the events are read and deserialised here, and handed in chunks to the filling threads
+    const size_t chunk_size = 256;
+    std::mutex mtx;
+    std::condition_variable cv_fill, cv_read;
+    std::deque<std::vector<eudaq::EventSP> > chunks;
+    bool done = false;
+    std::vector<std::thread> fillers;
+    for (size_t i = 0; i < n_thread; ++i)
+      fillers.emplace_back([&]() {
+        while (true) {
+          std::vector<eudaq::EventSP> chunk;
+          {
+            std::unique_lock<std::mutex> lk(mtx);
+            cv_fill.wait(lk, [&]() { return done || !chunks.empty(); });
+            if (chunks.empty())
+              return;
+            chunk = std::move(chunks.front());
+            chunks.pop_front();
+          }
+          cv_read.notify_one();
+          for (auto& ev : chunk) {
+            try {
+              DoReceive(ev);
+            } catch (const std::exception& e) {
+              EUDAQ_ERROR(GetName()+" failed to process event "+std::to_string(ev->GetEventN())+": "+e.what());
+            }
+          }
+        }
+      });
+
+    unsigned long long num_evts = 0, num_read = 0;
+    bool first_evt = true;
+    auto start = std::chrono::steady_clock::now(), last_rate = start;
+    unsigned long long last_num_mon = m_num_evt_mon;
+    std::vector<eudaq::EventSP> chunk;
+    auto push = [&]() {
+      std::unique_lock<std::mutex> lk(mtx);
+      cv_read.wait(lk, [&]() { return chunks.size() < 2*n_thread; });
+      chunks.emplace_back(std::move(chunk));
+      lk.unlock();
+      cv_fill.notify_one();
+      chunk.clear();
+    };
+    while (!m_interrupt) {
+      auto evc = reader->GetNextEvent();
+      if (!evc)
+        break;
+      num_read++;
+      if (evc->GetEventN() < ev_begin || evc->GetEventN() >= ev_end
+          || evc->GetTimestampBegin() < ts_begin || evc->GetTimestampBegin() > ts_end)
+        continue;
+      if (num_evts++ % every != 0)
+        continue;
+      auto evt = std::const_pointer_cast<eudaq::Event>(evc);
       if (first_evt) {
         DoStartRun();
         m_monitor->SetRunNumber(evt->GetRunN());
         first_evt = false;
       }
-      DoReceive(evt);
-      if (num_evts > 0 && num_evts % 100000 == 0)
-        EUDAQ_INFO(GetName()+" processed "+std::to_string(num_evts)+" events");
-      num_evts++;
-    } while (reader.HasData());
-    EUDAQ_INFO(GetName()+" processed "+std::to_string(num_evts)+" events");
+      chunk.emplace_back(evt);
+      if (chunk.size() == chunk_size)
+        push();
+      auto now = std::chrono::steady_clock::now();
+      if (now - last_rate > std::chrono::seconds(1)) {
+        const unsigned long long num_mon = m_num_evt_mon;
+        m_monitor->SetReplayRate((num_mon-last_num_mon)/std::chrono::duration<double>(now-last_rate).count());
+        last_rate = now;
+        last_num_mon = num_mon;
+      }
+    }
+    if (!chunk.empty())
+      push();
+    {
+      std::lock_guard<std::mutex> lk(mtx);
+      done = true;
+    }
+    cv_fill.notify_all();
+    for (auto& th : fillers)
+      th.join();
+    if (m_interrupt)
+      return;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now()-start;
+    const unsigned long long num_mon = (num_evts+every-1)/every;
+    EUDAQ_INFO(GetName()+" processed "+std::to_string(num_mon)+" of "+std::to_string(num_read)+" events read with "
+               +std::to_string(n_thread)+" threads in "+std::to_string(elapsed.count())+" s");
+    m_monitor->SetReplayRate(num_mon/elapsed.count());
     m_monitor->Update();
     DoStopRun();
   }
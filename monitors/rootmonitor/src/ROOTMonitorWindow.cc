@@ -134,6 +134,10 @@ namespace eudaq {
     Emit("FillFromRAWFile(const char*)", path);
   }
 
+  void ROOTMonitorWindow::Merge(){
+    Emit("Merge()");
+  }
+
   //--- counters/status bookeeping
 
   void ROOTMonitorWindow::SetCounters(unsigned long long evt_recv, unsigned long long evt_mon){
@@ -147,6 +151,7 @@ namespace eudaq {
       m_status_bar->SetText("Curr. event: N/A", (int)StatusBarPos::tot_events);
       m_status_bar->SetText("Analysed events: N/A", (int)StatusBarPos::an_events);
     }
+    m_replay_rate = 0.;
     m_button_save->SetEnabled(false);
     m_button_clean->SetEnabled(false);
     if (m_clear_between_runs)
@@ -171,7 +176,10 @@ namespace eudaq {
   void ROOTMonitorWindow::SetMonitoredEventsNum(int num){
     if (num >= 0)
       m_last_event_mon = num;
-    if (m_status_bar && (num < 0 || m_status == Status::STATE_RUNNING))
+    if (m_status_bar && m_replay_rate > 0.)
+      m_status_bar->SetText(Form("Analysed events: %llu (%.0f Hz)", m_last_event_mon, m_replay_rate),
+                            (int)StatusBarPos::an_events);
+    else if (m_status_bar && (num < 0 || m_status == Status::STATE_RUNNING))
       m_status_bar->SetText(Form("Analysed events: %llu", m_last_event_mon), (int)StatusBarPos::an_events);
   }
 
@@ -187,6 +195,7 @@ namespace eudaq {
     static TString dir(".");
     // allows for both RAW and post-processed ROOT files (TBrowser-like)
     const char* filetypes[] = {"RAW files",  "*.raw",
+                               "Compressed RAW files", "*.rawz",
                                "ROOT files", "*.root",
                                0,            0};
     TGFileInfo fi;
@@ -210,7 +219,7 @@ namespace eudaq {
       FillFileObject("", TFile::Open(filename, "read"), ""); // handled by GC
       m_button_save->SetEnabled(false); // nothing has changed, export feature disabled
     }
-    else if (s_ext == "raw") {
+    else if (s_ext == "raw" || s_ext == "rawz") {
       FillFromRAWFile(filename);
       m_button_save->SetEnabled(true); // allows for export
     }
@@ -284,6 +293,7 @@ namespace eudaq {
   //--- graphical part
 
   void ROOTMonitorWindow::Update(){
+    Merge();
     SetLastEventNum(m_last_event);
     SetMonitoredEventsNum(m_last_event_mon);
 
@@ -0,0 +1,227 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/Logger.hh"
+#include "eudaq/BufferSerializer.hh"
+#include "eudaq/StdEventConverter.hh"
+#include "eudaq/StandardEvent.hh"
+#include "eudaq/RawEvent.hh"
+#include "ALPIDEDecoder.hh"
+
+#include <iostream>
+#include <chrono>
+#include <random>
+
+// Checks the ALPIDE converter against the byte by byte reference decoding
+// on synthetic events, on corrupted and on random data, and compares the
+// speed of both.
+namespace{
+  bool Reference(eudaq::EventSPC in, eudaq::StandardEventSP out){
+    auto rawev = std::dynamic_pointer_cast<const eudaq::RawEvent>(in);
+    std::vector<uint8_t> data = rawev->GetBlock(0);
+    size_t n = data.size();
+    data.resize(n + 16, 0); // the reference reads past the end of broken events
+    eudaq::StandardPlane plane(rawev->GetDeviceN(), "ITS3DAQ", "ALPIDE");
+    plane.SetSizeZS(1024, 512, 0, 1);
+    size_t i = 0;
+    if(!(data[i]==0xAA && data[i+1]==0xAA && data[i+2]==0xAA && data[i+3]==0xAA))
+      return false;
+    uint64_t tev = 0;
+    uint32_t iev = 0;
+    for(int j = 0; j < 4; ++j) iev |= ((uint32_t)data[i+4+j])<<(j*8);
+    for(int j = 0; j < 8; ++j) tev |= ((uint64_t)data[i+8+j])<<(j*8);
+    tev *= 12500;
+    out->SetTimeBegin(0);
+    out->SetTimeEnd(0);
+    out->SetTriggerN(iev);
+    i += 16;
+    uint8_t reg = 0;
+    if((data[i]&0xF0)==0xE0)
+      i += 4;
+    else if((data[i]&0xF0)==0xA0){
+      i += 2;
+      while(i < n-4){
+	uint8_t data0 = data[i];
+	if((data0&0xC0)==0x00){
+	  uint32_t d = reg<<14|(data0&0x3F)<<8|data[i+1];
+	  plane.PushPixel(((d>>9)&0x3FE)|((d^(d>>1))&0x1), (d>>1)&0x1FF, 1, tev);
+	  uint8_t data2 = data[i+2];
+	  d += 1;
+	  while(data2){
+	    if(data2&1)
+	      plane.PushPixel(((d>>9)&0x3FE)|((d^(d>>1))&0x1), (d>>1)&0x1FF, 1, tev);
+	    data2 >>= 1;
+	    d += 1;
+	  }
+	  i += 3;
+	}
+	else if((data0&0xC0)==0x40){
+	  uint32_t d = reg<<14|(data0&0x3F)<<8|data[i+1];
+	  plane.PushPixel(((d>>9)&0x3FE)|((d^(d>>1))&0x1), (d>>1)&0x1FF, 1, tev);
+	  i += 2;
+	}
+	else if((data0&0xE0)==0xC0){
+	  reg = data0&0x1F;
+	  i += 1;
+	}
+	else if((data0&0xF0)==0xB0){
+	  i += 1;
+	  i = (i+3)/4*4;
+	  break;
+	}
+	else if(data0==0xFF)
+	  i += 1;
+	else
+	  return false;
+      }
+    }
+    else
+      return false;
+    if(!(data[i]==0xBB && data[i+1]==0xBB && data[i+2]==0xBB && data[i+3]==0xBB))
+      return false;
+    out->AddPlane(plane);
+    return true;
+  }
+
+  // A well formed event: header, one chip frame with hits, trailer
+  std::vector<uint8_t> Frame(std::mt19937 &rng, uint32_t ev_n){
+    std::uniform_int_distribution<int> u8(0, 255), n_reg(0, 6), n_word(1, 8), kind(0, 9);
+    std::vector<uint8_t> d = {0xAA, 0xAA, 0xAA, 0xAA};
+    for(int j = 0; j < 4; ++j) d.push_back(ev_n>>(j*8));
+    for(int j = 0; j < 8; ++j) d.push_back(u8(rng));
+    int nr = n_reg(rng);
+    if(!nr){
+      d.insert(d.end(), {0xE0, uint8_t(u8(rng)), 0xFF, 0xFF});
+    }
+    else{
+      d.push_back(0xA0);
+      d.push_back(u8(rng));
+      int reg = 0;
+      for(int r = 0; r < nr; ++r){
+	reg += 1 + u8(rng)%4;
+	d.push_back(0xC0|(reg&0x1F));
+	for(int w = n_word(rng); w > 0; --w){
+	  int k = kind(rng);
+	  if(k < 4)
+	    d.insert(d.end(), {uint8_t(u8(rng)&0x3F), uint8_t(u8(rng)), uint8_t(u8(rng)&0x7F)});
+	  else if(k < 9)
+	    d.insert(d.end(), {uint8_t(0x40|(u8(rng)&0x3F)), uint8_t(u8(rng))});
+	  else
+	    d.push_back(0xFF);
+	}
+      }
+      d.push_back(0xB0);
+      while(d.size()%4)
+	d.push_back(0xFF);
+    }
+    d.insert(d.end(), {0xBB, 0xBB, 0xBB, 0xBB});
+    return d;
+  }
+
+  // Well formed, corrupted, truncated or random events, in that order of frequency
+  eudaq::EventSPC Synthetic(std::mt19937 &rng, uint32_t ev_n){
+    std::uniform_int_distribution<int> u8(0, 255), mode(0, 9);
+    std::vector<uint8_t> d = Frame(rng, ev_n);
+    int m = mode(rng);
+    if(m == 6 || m == 7){
+      std::uniform_int_distribution<size_t> pos(16, d.size()-1);
+      for(int k = 1 + u8(rng)%3; k > 0; --k)
+	d[pos(rng)] = u8(rng);
+    }
+    else if(m == 8)
+      d.resize(u8(rng)%d.size());
+    else if(m == 9){
+      d.resize(16 + u8(rng)%64);
+      for(size_t k = 16; k < d.size(); ++k)
+	d[k] = u8(rng);
+    }
+    auto ev = eudaq::Event::MakeShared("ALPIDE_plane_0");
+    ev->SetEventN(ev_n);
+    ev->AddBlock(0, d);
+    return ev;
+  }
+
+  std::vector<uint8_t> Bytes(const eudaq::StandardEvent &ev){
+    eudaq::BufferSerializer ser;
+    ev.Serialize(ser);
+    std::vector<uint8_t> v(ser.size());
+    for(size_t i = 0; i < v.size(); i++)
+      v[i] = ser[i];
+    return v;
+  }
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ ALPIDE decoder check", "2.0", "Compares the ALPIDE converter with a reference decoding");
+  eudaq::Option<uint32_t> synth_n(op, "n", "events", 10000, "uint32_t", "number of synthetic events");
+  eudaq::Option<uint32_t> repeat_n(op, "r", "repeat", 5, "uint32_t", "passes over the events for the timing");
+  eudaq::Option<uint32_t> seed(op, "s", "seed", 42, "uint32_t", "seed of the event generator");
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+  // broken events are dumped byte by byte
+  EUDAQ_LOG_LEVEL("ERROR");
+
+  auto cvt = eudaq::Factory<eudaq::StdEventConverter>::MakeUnique(eudaq::cstr2hash("ALPIDE_plane_0"));
+  if(!cvt){
+    std::cout<<"no ALPIDE converter registered"<<std::endl;
+    return 1;
+  }
+  std::mt19937 rng(seed.Value());
+  std::vector<eudaq::EventSPC> evs;
+  for(uint32_t i = 0; i < synth_n.Value(); i++)
+    evs.push_back(Synthetic(rng, i));
+
+  eudaq::ConfigurationSPC conf;
+  size_t n_bad = 0;
+  uint64_t n_hit = 0;
+  std::vector<eudaq::EventSPC> good; // broken events are dumped to the log, keep them out of the timing
+  for(auto &ev: evs){
+    auto a = eudaq::StandardEvent::MakeShared();
+    auto b = eudaq::StandardEvent::MakeShared();
+    bool ok_a = cvt->Converting(ev, a, conf);
+    bool ok_b = Reference(ev, b);
+    if(ok_a != ok_b || (ok_a && Bytes(*a) != Bytes(*b))){
+      if(!n_bad)
+	std::cout<<"mismatch in event "<<ev->GetEventN()<<std::endl;
+      n_bad++;
+    }
+    if(ok_a){
+      good.push_back(ev);
+      n_hit += a->GetPlane(0).HitPixels(0);
+    }
+  }
+  std::cout<<evs.size()<<" events, "<<good.size()<<" decoded, "<<n_hit<<" hits, "<<n_bad<<" mismatches"<<std::endl;
+
+  auto bench = [&](bool ref){
+    auto tp = std::chrono::steady_clock::now();
+    for(uint32_t r = 0; r < repeat_n.Value(); r++)
+      for(auto &ev: good){
+	auto out = eudaq::StandardEvent::MakeShared();
+	if(ref)
+	  Reference(ev, out);
+	else
+	  cvt->Converting(ev, out, conf);
+      }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+  };
+  double n = double(good.size()) * repeat_n.Value();
+  double t_ref = bench(true);
+  double t_cvt = bench(false);
+  std::cout<<"reference: "<<n/t_ref<<" events/s, "<<n_hit*repeat_n.Value()/t_ref/1e6<<" Mhits/s"<<std::endl;
+  std::cout<<"converter: "<<n/t_cvt<<" events/s, "<<n_hit*repeat_n.Value()/t_cvt/1e6<<" Mhits/s"<<std::endl;
+
+  // the decoder alone
+  ALPIDEDecoder decoder;
+  auto tp = std::chrono::steady_clock::now();
+  for(uint32_t r = 0; r < repeat_n.Value(); r++)
+    for(auto &ev: good){
+      auto &d = ev->GetBlockRef(0);
+      size_t i = 16;
+      decoder.Decode(d.data(), d.size(), i);
+    }
+  double t_dec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+  std::cout<<"decoder: "<<n_hit*repeat_n.Value()/t_dec/1e6<<" Mhits/s"<<std::endl;
+  return n_bad ? 1 : 0;
+}
@@ -0,0 +1,49 @@
+#ifndef ITS3_INCLUDED_ALPIDEDecoder
+#define ITS3_INCLUDED_ALPIDEDecoder
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Decoder of the ALPIDE chip data stream (chip header/empty frame, region
+ * headers, data short/long words, chip trailer), shared by the converters of
+ * chips using the ALPIDE readout.
+ *
+ * The word types and the hitmaps of the data long words are looked up in
+ * tables, the pixel addresses are collected first and converted to (x, y)
+ * in one branch free pass that the compiler vectorises. The hits are
+ * available as plain arrays after Decode().
+ */
+class ALPIDEDecoder {
+public:
+  enum Status {
+    OK,
+    BAD_WORD,     ///< unknown word inside the chip frame
+    EVENT_HEADER, ///< 0xAA inside the chip frame, the event was cut
+    NO_FRAME      ///< neither a chip header nor an empty frame at the start
+  };
+
+  /**
+   * Decodes the chip frame starting at data[pos], without the bytes from
+   * n-4 on where the event trailer is expected. On return pos is the
+   * 32-bit aligned position after the chip trailer, or the position of the
+   * offending byte if the status is not OK.
+   */
+  Status Decode(const uint8_t *data, size_t n, size_t &pos);
+
+  size_t NumHits() const {return m_x.size();}
+  const std::vector<uint16_t>& GetX() const {return m_x;}
+  const std::vector<uint16_t>& GetY() const {return m_y;}
+
+  /// Column of the 14 bit region/encoder/address word of a hit
+  static uint16_t Column(uint32_t d) {return (d>>9&0x3FE)|((d^d>>1)&0x1);}
+  static uint16_t Row(uint32_t d) {return d>>1&0x1FF;}
+
+private:
+  std::vector<uint32_t> m_addr;
+  std::vector<uint16_t> m_x;
+  std::vector<uint16_t> m_y;
+};
+
+#endif // ITS3_INCLUDED_ALPIDEDecoder
@@ -0,0 +1,109 @@
+#include "ALPIDEDecoder.hh"
+
+namespace{
+  enum class Word : uint8_t {
+    DATA_LONG,
+    DATA_SHORT,
+    REGION_HEADER,
+    CHIP_TRAILER,
+    IDLE,
+    EVENT_HEADER,
+    BAD
+  };
+
+  struct Tables {
+    Word word[256];
+    // number and offsets of the set bits of a hitmap, LSB first
+    uint8_t nbit[256];
+    uint8_t bit[256][8];
+    Tables(){
+      for(int b=0;b<256;++b){
+        if((b&0xC0)==0x00)      word[b]=Word::DATA_LONG;
+        else if((b&0xC0)==0x40) word[b]=Word::DATA_SHORT;
+        else if((b&0xE0)==0xC0) word[b]=Word::REGION_HEADER;
+        else if((b&0xF0)==0xB0) word[b]=Word::CHIP_TRAILER;
+        else if(b==0xFF)        word[b]=Word::IDLE;
+        else if(b==0xAA)        word[b]=Word::EVENT_HEADER;
+        else                    word[b]=Word::BAD;
+        nbit[b]=0;
+        for(int k=0;k<8;++k){
+          bit[b][k]=0;
+          if(b>>k&1)
+            bit[b][nbit[b]++]=k;
+        }
+      }
+    }
+  };
+
+  const Tables tables;
+}
+
+ALPIDEDecoder::Status ALPIDEDecoder::Decode(const uint8_t *data, size_t n, size_t &i){
+  m_x.clear();
+  m_y.clear();
+  if(i>=n)
+    return NO_FRAME;
+  if((data[i]&0xF0)==0xE0){ // chip empty frame
+    i+=4;
+    return OK;
+  }
+  if((data[i]&0xF0)!=0xA0)
+    return NO_FRAME;
+  i+=2;
+
+  // a data long word gives up to 9 hits out of 3 bytes, its hitmap is
+  // expanded by always writing 8 addresses and advancing by the bit count
+  size_t need=(n>i?n-i:0)*3+9;
+  if(m_addr.size()<need)
+    m_addr.resize(need);
+  uint32_t *a=m_addr.data();
+  size_t nh=0;
+  uint32_t reg=0;
+  bool trailer=false;
+  while(!trailer && i+4<n){
+    uint8_t b=data[i];
+    switch(tables.word[b]){
+    case Word::DATA_LONG:{
+      uint32_t d=reg<<14|(b&0x3F)<<8|data[i+1];
+      uint8_t m=data[i+2];
+      const uint8_t *o=tables.bit[m];
+      a[nh]=d;
+      for(int k=0;k<8;++k)
+        a[nh+1+k]=d+1+o[k];
+      nh+=1+tables.nbit[m];
+      i+=3;
+      break;
+    }
+    case Word::DATA_SHORT:
+      a[nh++]=reg<<14|(b&0x3F)<<8|data[i+1];
+      i+=2;
+      break;
+    case Word::REGION_HEADER:
+      reg=b&0x1F;
+      i+=1;
+      break;
+    case Word::CHIP_TRAILER:
+      i+=1;
+      i=(i+3)/4*4;
+      trailer=true;
+      break;
+    case Word::IDLE:
+      i+=1;
+      break;
+    case Word::EVENT_HEADER:
+      return EVENT_HEADER;
+    default:
+      return BAD_WORD;
+    }
+  }
+
+  m_x.resize(nh);
+  m_y.resize(nh);
+  uint16_t *x=m_x.data();
+  uint16_t *y=m_y.data();
+  for(size_t k=0;k<nh;++k){
+    x[k]=Column(a[k]);
+    y[k]=Row(a[k]);
+  }
+  return OK;
+}
@@ -1,5 +1,6 @@
 #include "eudaq/StdEventConverter.hh"
 #include "eudaq/RawEvent.hh"
+#include "ALPIDEDecoder.hh"
 #include <iostream>
 
 
@@ -66,13 +67,11 @@ bool ALPIDERawEvent2StdEventConverter::Converting(eudaq::EventSPC in,eudaq::StdE
   Config &conf=LoadConf(conf_);
   if(conf.device_n==-2) return false; // Corry event loader is looking for another plane
   auto rawev=std::dynamic_pointer_cast<const eudaq::RawEvent>(in);
-  std::vector<uint8_t> data=rawev->GetBlock(0); // FIXME: copy?
   if(conf.device_n>=0 && conf.device_n!=rawev->GetDeviceN()) return false;
-  eudaq::StandardPlane plane(rawev->GetDeviceN(),"ITS3DAQ","ALPIDE");
-  plane.SetSizeZS(1024,512,0,1); // 0 hits so far + 1 frame
+  const std::vector<uint8_t> &data=rawev->GetBlockRef(0);
   size_t i=0;
   size_t n=data.size();
-  if (!(data[i]==0xAA && data[i+1]==0xAA && data[i+2]==0xAA && data[i+3]==0xAA)) {
+  if (n<16 || !(data[i]==0xAA && data[i+1]==0xAA && data[i+2]==0xAA && data[i+3]==0xAA)) {
     EUDAQ_WARN("BAD DATA. Skipping raw event."); // TODO
     return false;
   }
@@ -88,67 +87,38 @@ bool ALPIDERawEvent2StdEventConverter::Converting(eudaq::EventSPC in,eudaq::StdE
   out->SetTriggerN(iev);
 
   i+=16;
-  uint8_t reg;
-  if((data[i]&0xF0)==0xE0) {// chip empty frame
-    i+=4;
-  } else if((data[i]&0xF0)==0xA0) {// chip header
-    i+=2;
-    while(i<n-4) {
-      uint8_t data0=data[i];
-      if((data0&0xC0)==0x00) {// data long
-      	uint32_t d=reg<<14|(data0&0x3F)<<8|data[i+1];
-       	uint16_t x=d>>9&0x3FE|(d^d>>1)&0x1;
-       	uint16_t y=d>>1&0x1FF;
-       	plane.PushPixel(x,y,1,tev); // column, row, charge, time
-       	uint8_t data2=data[i+2];
-       	d+=1;
-       	while(data2) {
-       	  if(data2&1) {
-            x=d>>9&0x3FE|(d^d>>1)&0x1;
-            y=d>>1&0x1FF;
-            plane.PushPixel(x,y,1,tev); // column, row, charge, time
-          }
-          data2>>=1;
-          d+=1;
-        }
-        i+=3;
-        } else if((data0&0xC0)==0x40) {// data short
-          uint32_t d=reg<<14|(data0&0x3F)<<8|data[i+1];
-          uint16_t x=d>>9&0x3FE|(d^d>>1)&0x1;
-          uint16_t y=d>>1&0x1FF;
-          plane.PushPixel(x,y,1,tev); // column, row, charge, time
-          i+=2;
-        } else if((data0&0xE0)==0xC0) {// region header
-          reg=data0&0x1F;
-          i+=1;
-        } else if((data0&0xF0)==0xB0) {// chip trailer
-          i+=1;
-          i=(i+3)/4*4;
-          break;
-        } else if(data0==0xFF) {// IDLE (why?)
-          i+=1;
-        } else if (data0==0xAA) {
-          EUDAQ_WARN("BAD WORD. An event header now? Skipping raw event.");
-          Dump(data,i);
-          return false;
-        } else {
-          EUDAQ_WARN("BAD WORD. Skipping raw event.");
-          Dump(data,i);
-          return false;
-        }
-      }
-    }
-  else {
+  // one decoder per thread, its buffers are reused from event to event
+  static thread_local ALPIDEDecoder decoder;
+  switch(decoder.Decode(data.data(),n,i)) {
+  case ALPIDEDecoder::OK:
+    break;
+  case ALPIDEDecoder::EVENT_HEADER:
+    EUDAQ_WARN("BAD WORD. An event header now? Skipping raw event.");
+    Dump(data,i);
+    return false;
+  case ALPIDEDecoder::BAD_WORD:
+    EUDAQ_WARN("BAD WORD. Skipping raw event.");
+    Dump(data,i);
+    return false;
+  case ALPIDEDecoder::NO_FRAME:
     EUDAQ_WARN("BAD WORD. No event start? Skipping raw event.");
     Dump(data,i);
     return false;
   }
-  if (!(data[i]==0xBB && data[i+1]==0xBB && data[i+2]==0xBB && data[i+3]==0xBB)) {
+  if (i+4>n || !(data[i]==0xBB && data[i+1]==0xBB && data[i+2]==0xBB && data[i+3]==0xBB)) {
     EUDAQ_WARN("BAD WORD. Bad/no event trailer? Skipping raw event.");
     Dump(data,i);
     return false;
   }
-  out->AddPlane(plane);
+  // filled in place, the hits are not copied again
+  eudaq::StandardPlane &plane=out->AddPlane(eudaq::StandardPlane(rawev->GetDeviceN(),"ITS3DAQ","ALPIDE"));
+  size_t nhit=decoder.NumHits();
+  plane.SetSizeZS(1024,512,0,1); // 0 hits so far + 1 frame
+  plane.ReservePixels(nhit);
+  const uint16_t *x=decoder.GetX().data();
+  const uint16_t *y=decoder.GetY().data();
+  for(size_t k=0;k<nhit;++k)
+    plane.PushPixel(x[k],y[k],1,tev); // column, row, charge, time
   return true;
 }
 
@@ -0,0 +1,160 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/BufferSerializer.hh"
+#include "eudaq/StdEventConverter.hh"
+#include "eudaq/StandardEvent.hh"
+#include "eudaq/RawEvent.hh"
+#include "CMSPhase2Event2StdEventConverter.hh"
+
+#include <iostream>
+#include <chrono>
+#include <random>
+
+// Checks the CMSPhase2 converter against a straightforward reference
+// decoding, on recorded data (-i) or on synthetic events (-n), and
+// compares the speed of both.
+namespace{
+  bool Reference(eudaq::EventSPC pEvent, eudaq::StandardEventSP pStdEvent, const std::string &trigger_source){
+    if(!pEvent || pEvent->GetNumSubEvent() < 1)
+      return false;
+    uint32_t cNFrames = pEvent->GetNumSubEvent();
+    std::vector<eudaq::StandardPlane> cPlanes;
+    for(uint32_t cBlockId = 0; cBlockId < pEvent->GetSubEvent(0)->GetBlockNumList().size(); cBlockId++){
+      cPlanes.emplace_back(cBlockId+30, "CMSPhase2StdEvent", "CMSPhase2");
+      cPlanes.back().SetSizeZS(1016, 2, 0, cNFrames);
+    }
+    for(uint32_t cFrameId = 0; cFrameId < cNFrames; cFrameId++){
+      auto cSub = pEvent->GetSubEvent(cFrameId);
+      if(trigger_source == "EVENT")
+	pStdEvent->SetTriggerN(pEvent->GetEventNumber());
+      else
+	pStdEvent->SetTriggerN(std::stol(cSub->GetTag("TLU_TRIGGER_ID", "0")));
+      for(uint32_t cBlockId = 0; cBlockId < cSub->GetBlockNumList().size(); cBlockId++){
+	std::vector<uint8_t> data = cSub->GetBlock(cBlockId);
+	uint32_t nhits = data.size()/6 - 1;
+	auto val = [&data](size_t hit, size_t value){
+	  size_t i = 6 + hit*6 + value*2;
+	  return static_cast<uint16_t>((data[i+1] << 8) | data[i]);
+	};
+	for(size_t i = 0; i < nhits; i++)
+	  cPlanes.at(cBlockId).PushPixel(val(i, 0), val(i, 1), val(i, 2), false, cFrameId);
+      }
+      for(auto item: cSub->GetTags())
+	pStdEvent->SetTag(item.first, item.second);
+    }
+    for(auto &cPlane: cPlanes)
+      pStdEvent->AddPlane(cPlane);
+    return true;
+  }
+
+  eudaq::EventSPC Synthetic(std::mt19937 &rng, uint32_t ev_n){
+    std::uniform_int_distribution<int> n_frame(1, 4), n_hit(0, 40), col(0, 1015), row(0, 1), tot(0, 15);
+    auto ev = eudaq::Event::MakeShared("CMSPhase2RawEvent");
+    ev->SetEventN(ev_n);
+    int nf = n_frame(rng);
+    for(int f = 0; f < nf; f++){
+      auto sub = eudaq::Event::MakeShared("CMSPhase2RawEvent");
+      sub->SetTag("TLU_TRIGGER_ID", ev_n * 4 + f);
+      sub->SetTag("FRAME", f);
+      for(uint32_t b = 0; b < 8; b++){
+	int nh = n_hit(rng);
+	std::vector<uint16_t> data = {1016, 2, static_cast<uint16_t>(nh)};
+	for(int h = 0; h < nh; h++){
+	  data.push_back(col(rng));
+	  data.push_back(row(rng));
+	  data.push_back(tot(rng));
+	}
+	sub->AddBlock(b, data);
+      }
+      ev->AddSubEvent(sub);
+    }
+    return ev;
+  }
+
+  std::vector<uint8_t> Bytes(const eudaq::StandardEvent &ev){
+    eudaq::BufferSerializer ser;
+    ev.Serialize(ser);
+    std::vector<uint8_t> v(ser.size());
+    for(size_t i = 0; i < v.size(); i++)
+      v[i] = ser[i];
+    return v;
+  }
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ CMSPhase2 converter check", "2.0", "Compares the CMSPhase2 converter with a reference decoding");
+  eudaq::Option<std::string> file_input(op, "i", "input", "", "string", "recorded native file");
+  eudaq::Option<uint32_t> synth_n(op, "n", "events", 1000, "uint32_t", "number of synthetic events if no input file");
+  eudaq::Option<uint32_t> repeat_n(op, "r", "repeat", 5, "uint32_t", "passes over the events for the timing");
+  eudaq::Option<std::string> trigger_src(op, "s", "trigger-source", "TLU", "string", "trigger_number_source, TLU or EVENT");
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+
+  const uint32_t id = eudaq::CMSPhase2RawEvent2StdEventConverter::m_id_factory;
+  std::vector<eudaq::EventSPC> evs;
+  if(!file_input.Value().empty()){
+    std::string type = file_input.Value().substr(file_input.Value().find_last_of(".")+1);
+    auto reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash(type == "raw" ? "native" : type),
+								 file_input.Value());
+    while(auto ev = reader->GetNextEvent()){
+      if(ev->GetExtendWord() == id)
+	evs.push_back(ev);
+      for(auto &sub: ev->GetSubEvents())
+	if(sub->GetExtendWord() == id && sub->GetNumSubEvent())
+	  evs.push_back(sub);
+    }
+  }
+  else{
+    std::mt19937 rng(42);
+    for(uint32_t i = 0; i < synth_n.Value(); i++)
+      evs.push_back(Synthetic(rng, i));
+  }
+  if(evs.empty()){
+    std::cout<<"no CMSPhase2RawEvent found"<<std::endl;
+    return 1;
+  }
+
+  auto conf = std::make_shared<eudaq::Configuration>();
+  conf->Set("trigger_number_source", trigger_src.Value());
+  eudaq::ConfigurationSPC cconf(conf);
+  eudaq::CMSPhase2RawEvent2StdEventConverter cvt;
+  size_t n_bad = 0;
+  uint64_t n_hit = 0;
+  for(auto &ev: evs){
+    auto a = eudaq::StandardEvent::MakeShared();
+    auto b = eudaq::StandardEvent::MakeShared();
+    bool ok_a = cvt.Converting(ev, a, cconf);
+    bool ok_b = Reference(ev, b, trigger_src.Value());
+    if(ok_a != ok_b || Bytes(*a) != Bytes(*b)){
+      if(!n_bad)
+	std::cout<<"mismatch in event "<<ev->GetEventN()<<std::endl;
+      n_bad++;
+    }
+    for(size_t i = 0; i < a->NumPlanes(); i++)
+      n_hit += a->GetPlane(i).HitPixels(0);
+  }
+  std::cout<<evs.size()<<" events, "<<n_hit<<" hits, "<<n_bad<<" mismatches"<<std::endl;
+
+  auto bench = [&](bool ref){
+    auto tp = std::chrono::steady_clock::now();
+    for(uint32_t r = 0; r < repeat_n.Value(); r++)
+      for(auto &ev: evs){
+	auto out = eudaq::StandardEvent::MakeShared();
+	if(ref)
+	  Reference(ev, out, trigger_src.Value());
+	else
+	  cvt.Converting(ev, out, cconf);
+      }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+  };
+  double n = double(evs.size()) * repeat_n.Value();
+  double t_ref = bench(true);
+  double t_cvt = bench(false);
+  std::cout<<"reference: "<<n/t_ref<<" events/s, "<<n_hit*repeat_n.Value()/t_ref/1e6<<" Mhits/s"<<std::endl;
+  std::cout<<"converter: "<<n/t_cvt<<" events/s, "<<n_hit*repeat_n.Value()/t_cvt/1e6<<" Mhits/s"<<std::endl;
+  return n_bad ? 1 : 0;
+}
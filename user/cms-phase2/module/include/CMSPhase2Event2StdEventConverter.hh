@@ -9,10 +9,11 @@ namespace eudaq {
   class CMSPhase2RawEvent2StdEventConverter: public eudaq::StdEventConverter{
   public:
     bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
-    void AddFrameToPlane(eudaq::StandardPlane *pPlane, const std::vector<uint8_t> &data, uint32_t pFrame, uint32_t pNFrames) const;
-    uint16_t getHitVal(const std::vector<uint8_t> &data, size_t index, size_t value_id) const; 
     static const uint32_t m_id_factory = eudaq::cstr2hash("CMSPhase2RawEvent");
   private:
+    /// Number of 6-byte hit records after the 6-byte block header
+    static size_t NumHits(const std::vector<uint8_t> &data);
+    static void AddFrameToPlane(eudaq::StandardPlane &pPlane, const std::vector<uint8_t> &data);
   };
 
 } // namespace eudaq
@@ -9,66 +9,63 @@ namespace {
 
 bool CMSPhase2RawEvent2StdEventConverter::Converting(eudaq::EventSPC pEvent, eudaq::StandardEventSP pStdEvent, eudaq::ConfigurationSPC conf) const
 {
-  std::string trigger_number_source_ = conf->Get("trigger_number_source", "TLU");
-  
   // No event
   if(!pEvent || pEvent->GetNumSubEvent() < 1) {
     return false;
   }
-  //Create one StandardPlane for each block of data
-  auto cSubEventRaw = std::dynamic_pointer_cast<const eudaq::RawEvent>(pEvent->GetSubEvent(0));
-  
-  std::vector<eudaq::StandardPlane*> cPlanes;  
-  uint32_t  cNFrames = pEvent->GetSubEvents().size();
-  for(uint32_t cBlockId = 0; cBlockId<cSubEventRaw->GetBlockNumList().size(); cBlockId++){
-    eudaq::StandardPlane *cPlane = new eudaq::StandardPlane(cBlockId+30, "CMSPhase2StdEvent", "CMSPhase2" ); 
-    cPlane->SetSizeZS(1016, 2, 0, cNFrames); // 3 values per hit, 2 uint8t words per uint16t word, 1 for header
-    cPlanes.push_back(cPlane);
-  }
-  for(uint32_t cFrameId=0; cFrameId<cNFrames ; cFrameId++){
-    cSubEventRaw = std::dynamic_pointer_cast<const eudaq::RawEvent>(pEvent->GetSubEvent(cFrameId));
+  bool cTriggerFromEvent = conf && conf->Get("trigger_number_source", "TLU") == "EVENT";
 
-    // Ste trigger ID tag is only set on the subevents containing the different trigger multiplicities
-    if (trigger_number_source_.compare("EVENT") == 0)
-      pStdEvent->SetTriggerN(pEvent->GetEventNumber());
-    //if (trigger_number_source_).compare("TLU") == 0)
-    else
-      pStdEvent->SetTriggerN(std::stol(cSubEventRaw->GetTag("TLU_TRIGGER_ID", "0")));
+  // the sub events are the frames, each with one block per chip
+  uint32_t cNFrames = pEvent->GetNumSubEvent();
+  std::vector<const eudaq::Event*> cFrames(cNFrames);
+  for(uint32_t cFrameId = 0; cFrameId < cNFrames; cFrameId++)
+    cFrames[cFrameId] = pEvent->GetSubEvent(cFrameId).get();
 
-    for(uint32_t cBlockId=0; cBlockId < cSubEventRaw->GetBlockNumList().size(); cBlockId++){
-      AddFrameToPlane(cPlanes.at(cBlockId), cSubEventRaw->GetBlock(cBlockId), cFrameId, cNFrames ); 
-    }
+  //Create one StandardPlane for each block of data, directly in the event so that no hit is copied
+  size_t cNBlocks = cFrames[0]->NumBlocks();
+  size_t cPlane0 = pStdEvent->NumPlanes();
+  for(uint32_t cBlockId = 0; cBlockId < cNBlocks; cBlockId++){
+    eudaq::StandardPlane cPlane(cBlockId+30, "CMSPhase2StdEvent", "CMSPhase2");
+    cPlane.SetSizeZS(1016, 2, 0, cNFrames); // 3 values per hit, 2 uint8t words per uint16t word, 1 for header
+    size_t cNHits = 0;
+    for(auto cFrame: cFrames)
+      cNHits += NumHits(cFrame->GetBlockRef(cBlockId));
+    cPlane.ReservePixels(cNHits);
+    pStdEvent->AddPlane(cPlane);
+  }
 
-    const std::map<std::string, std::string> cRawTags = cSubEventRaw->GetTags();
-    for(auto item : cRawTags) {
+  for(auto cFrame: cFrames){
+    if(cFrame->NumBlocks() > cNBlocks)
+      EUDAQ_THROW("CMSPhase2RawEvent2StdEventConverter: frame with " + std::to_string(cFrame->NumBlocks()) +
+		  " blocks, the first one has " + std::to_string(cNBlocks));
+    for(uint32_t cBlockId = 0; cBlockId < cFrame->NumBlocks(); cBlockId++)
+      AddFrameToPlane(pStdEvent->GetPlane(cPlane0 + cBlockId), cFrame->GetBlockRef(cBlockId));
+    // later frames overwrite the tags of the earlier ones
+    for(auto &item: cFrame->GetTagsRef())
       pStdEvent->SetTag(item.first, item.second);
-    }
   }
-  for(auto cPlane : cPlanes ){
-    pStdEvent->AddPlane(*cPlane);
-  } 
 
+  // Ste trigger ID tag is only set on the subevents containing the different trigger multiplicities
+  if(cTriggerFromEvent)
+    pStdEvent->SetTriggerN(pEvent->GetEventNumber());
+  else
+    pStdEvent->SetTriggerN(std::stol(cFrames.back()->GetTag("TLU_TRIGGER_ID", "0")));
   return true;
 }
 
-void CMSPhase2RawEvent2StdEventConverter::AddFrameToPlane(eudaq::StandardPlane *pPlane, const std::vector<uint8_t> &data, uint32_t pFrame, uint32_t pNFrames) const{
-
-  // get width and height
-  uint32_t width = (((uint32_t)data[1]) << 8) | (uint32_t)data[0];
-  uint32_t height = (((uint32_t)data[3]) << 8) | (uint32_t)data[2];
-
-  // set size
-  uint32_t nhits = data.size()/6 - 1;
-
-  // process data
-  for(size_t i = 0; i < nhits; i++){    
-    // column, row, tot, ?, lvl1
-    pPlane->PushPixel(getHitVal(data, i, 0), getHitVal(data, i, 1), getHitVal(data, i, 2), false, pFrame);  
-  }
+size_t CMSPhase2RawEvent2StdEventConverter::NumHits(const std::vector<uint8_t> &data){
+  return data.size() < 6 ? 0 : data.size()/6 - 1;
 }
 
-uint16_t CMSPhase2RawEvent2StdEventConverter::getHitVal(const std::vector<uint8_t>& data, size_t hit_id, size_t value_id) const
-{
-  uint32_t word_index = 6 + hit_id*6 + value_id*2;
-  return (((uint16_t)data[word_index + 1]) << 8) | (uint16_t)data[word_index];
+void CMSPhase2RawEvent2StdEventConverter::AddFrameToPlane(eudaq::StandardPlane &pPlane, const std::vector<uint8_t> &data){
+  // header: width, height and one more little endian uint16_t, then per hit column, row, tot.
+  // The plane has no per-frame coordinates, the hits of all frames go to frame 0.
+  size_t nhits = NumHits(data);
+  const uint8_t *p = data.data() + 6;
+  for(size_t i = 0; i < nhits; i++, p += 6){
+    uint32_t col = p[0] | (uint32_t(p[1]) << 8);
+    uint32_t row = p[2] | (uint32_t(p[3]) << 8);
+    uint32_t tot = p[4] | (uint32_t(p[5]) << 8);
+    pPlane.PushPixelHelper(col, row, tot, 0, false, 0);
+  }
 }
@@ -0,0 +1,189 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/Utils.hh"
+#include "eudaq/Exception.hh"
+#include "NiController.hh"
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+// Loopback stand-in for the NI crate: it speaks the config/data socket
+// protocol of the LabVIEW server and streams synthetic Mimosa26 frames,
+// so that NiProducer and NiController can be exercised without hardware.
+
+namespace{
+  std::atomic<bool> g_running(false);
+
+  SOCKET ListenOn(uint16_t port){
+    SOCKET s = socket(AF_INET, SOCK_STREAM, 0);
+    if(s == -1)
+      EUDAQ_THROW("NiLoopback: can not create socket");
+    int yes = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if(bind(s, (sockaddr*)&addr, sizeof(addr)) == -1 || listen(s, 1) == -1){
+      close(s);
+      EUDAQ_THROW("NiLoopback: can not listen on port " + std::to_string(port));
+    }
+    return s;
+  }
+
+  bool RecvAll(SOCKET s, char *buf, size_t len){
+    while(len){
+      ssize_t n = recv(s, buf, len, MSG_WAITALL);
+      if(n <= 0)
+	return false;
+      buf += n;
+      len -= n;
+    }
+    return true;
+  }
+
+  bool SendAll(SOCKET s, const uint8_t *buf, size_t len){
+    while(len){
+      ssize_t n = send(s, buf, len, MSG_NOSIGNAL);
+      if(n <= 0)
+	return false;
+      buf += n;
+      len -= n;
+    }
+    return true;
+  }
+
+  // One length-prefixed frame as sent by the NI crate: 8 bytes of header
+  // (header word, pivot pixel, trigger number), then per board the frame
+  // counter, twice the data length, the data words and the trailer.
+  void FillFrame(std::vector<uint8_t> &frame, uint32_t nboards, uint32_t nwords){
+    size_t payload = 8 + nboards * (nwords + 4) * 4;
+    frame.assign(2 + payload, 0);
+    frame[0] = static_cast<uint8_t>(payload >> 8);
+    frame[1] = static_cast<uint8_t>(payload);
+    uint8_t *d = &frame[2];
+    for(uint32_t b = 0; b < nboards; b++){
+      uint8_t *bd = d + 8 + b * (nwords + 4) * 4;
+      eudaq::setlittleendian<uint16_t>(bd + 4, static_cast<uint16_t>(nwords));
+      eudaq::setlittleendian<uint16_t>(bd + 6, static_cast<uint16_t>(nwords));
+    }
+  }
+
+  void StreamData(SOCKET s, uint32_t nboards, uint32_t nwords, double rate){
+    std::vector<uint8_t> frame_0;
+    std::vector<uint8_t> frame_1;
+    FillFrame(frame_0, nboards, nwords);
+    FillFrame(frame_1, nboards, nwords);
+    uint32_t tg = 0;
+    auto tp_next = std::chrono::steady_clock::now();
+    std::chrono::nanoseconds period(rate > 0 ? static_cast<int64_t>(1e9 / rate) : 0);
+    while(g_running){
+      eudaq::setlittleendian<uint16_t>(&frame_0[2 + 6], static_cast<uint16_t>(tg & 0x7fff));
+      eudaq::setlittleendian<uint16_t>(&frame_1[2 + 6], static_cast<uint16_t>(tg & 0x7fff));
+      if(!SendAll(s, frame_0.data(), frame_0.size()) ||
+	 !SendAll(s, frame_1.data(), frame_1.size()))
+	break;
+      tg++;
+      if(period.count()){
+	tp_next += period;
+	std::this_thread::sleep_until(tp_next);
+      }
+    }
+  }
+
+  // Serve one NiProducer session: config socket first, then data socket.
+  void ServeSession(SOCKET ls_conf, SOCKET ls_data, uint32_t nboards, uint32_t nwords, double rate){
+    SOCKET s_conf = accept(ls_conf, nullptr, nullptr);
+    SOCKET s_data = accept(ls_data, nullptr, nullptr);
+    std::thread th_data;
+    char cmd[5];
+    while(RecvAll(s_conf, cmd, 5)){
+      std::string c(cmd, 4);
+      if(c == "conf"){
+	char conf[10];
+	if(!RecvAll(s_conf, conf, 10))
+	  break;
+	uint8_t reply[6] = {0, 4, 0, 0, 0, 0};
+	SendAll(s_conf, reply, 6);
+      }
+      else if(c == "star" && !g_running){
+	g_running = true;
+	th_data = std::thread(StreamData, s_data, nboards, nwords, rate);
+      }
+      else if(c == "stop"){
+	g_running = false;
+	if(th_data.joinable())
+	  th_data.join();
+      }
+    }
+    g_running = false;
+    if(th_data.joinable())
+      th_data.join();
+    close(s_data);
+    close(s_conf);
+  }
+
+  void Benchmark(uint16_t port_conf, uint16_t port_data, uint32_t nev, bool frames){
+    NiController ni;
+    ni.ConfigClientSocket_Open("localhost", port_conf);
+    ni.DatatransportClientSocket_Open("localhost", port_data);
+    ni.ConfigClientSocket_Send("star");
+    std::vector<uint8_t> mimosa_data_0;
+    std::vector<uint8_t> mimosa_data_1;
+    uint64_t nbytes = 0;
+    auto tp_beg = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < nev; i++){
+      if(frames){
+	ni.DataTransportClientSocket_ReadFrames(mimosa_data_0, mimosa_data_1);
+      }
+      else{
+	uint32_t datalength1 = ni.DataTransportClientSocket_ReadLength();
+	mimosa_data_0 = ni.DataTransportClientSocket_ReadData(datalength1);
+	uint32_t datalength2 = ni.DataTransportClientSocket_ReadLength();
+	mimosa_data_1 = ni.DataTransportClientSocket_ReadData(datalength2);
+      }
+      nbytes += mimosa_data_0.size() + mimosa_data_1.size();
+    }
+    auto tp_end = std::chrono::steady_clock::now();
+    ni.ConfigClientSocket_Send("stop");
+    ni.DatatransportClientSocket_Close();
+    ni.ConfigClientSocket_Close();
+    double sec = std::chrono::duration<double>(tp_end - tp_beg).count();
+    std::cout << (frames ? "ReadFrames:          " : "ReadLength/ReadData: ")
+	      << nev / sec << " events/s, " << nbytes / sec / 1e6 << " MB/s" << std::endl;
+  }
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line NI crate loopback", "2.1",
+			 "Stand-in for the NI crate serving synthetic Mimosa26 data");
+  eudaq::Option<uint16_t> port_conf(op, "c", "confport", 49248, "uint16_t", "config socket port");
+  eudaq::Option<uint16_t> port_data(op, "d", "dataport", 49250, "uint16_t", "data transport socket port");
+  eudaq::Option<uint32_t> nboards(op, "n", "boards", 6, "uint32_t", "number of Mimosa boards per frame");
+  eudaq::Option<uint32_t> nwords(op, "w", "words", 20, "uint32_t", "data words per board and frame");
+  eudaq::Option<double> rate(op, "r", "rate", 0, "Hz", "trigger rate, 0 for as fast as possible");
+  eudaq::Option<uint32_t> nbench(op, "b", "benchmark", 0, "events",
+				 "read this number of events through NiController and exit");
+  op.Parse(argv);
+
+  SOCKET ls_conf = ListenOn(port_conf.Value());
+  SOCKET ls_data = ListenOn(port_data.Value());
+  if(!nbench.Value()){
+    std::cout << "NI loopback listening on ports " << port_conf.Value()
+	      << "/" << port_data.Value() << std::endl;
+    while(1)
+      ServeSession(ls_conf, ls_data, nboards.Value(), nwords.Value(), rate.Value());
+  }
+
+  for(bool frames : {false, true}){
+    std::thread th_srv(ServeSession, ls_conf, ls_data, nboards.Value(), nwords.Value(), rate.Value());
+    Benchmark(port_conf.Value(), port_data.Value(), nbench.Value(), frames);
+    th_srv.join();
+  }
+  close(ls_data);
+  close(ls_conf);
+  return 0;
+}
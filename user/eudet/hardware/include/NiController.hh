@@ -20,6 +20,7 @@
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/select.h>
+#include <sys/uio.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
 typedef int SOCKET;
@@ -32,6 +33,10 @@ class NiController {
   bool DataTransportClientSocket_Select();
   unsigned int DataTransportClientSocket_ReadLength();
   std::vector<unsigned char> DataTransportClientSocket_ReadData(int datalength);
+  // Read the two length-prefixed Mimosa frames of one trigger directly into
+  // the given vectors, which can be moved into the event afterwards.
+  void DataTransportClientSocket_ReadFrames(std::vector<unsigned char> &frame_0,
+                                            std::vector<unsigned char> &frame_1);
   void ConfigClientSocket_Open(const std::string& addr, uint16_t port);
   void ConfigClientSocket_Close();
   bool ConfigClientSocket_Select();
@@ -41,6 +46,9 @@ class NiController {
   std::vector<unsigned char> ConfigClientSocket_ReadData(int datalength);
 
 private:
+  void RecvAll(SOCKET sock, char *buf, size_t len);
+  unsigned int RecvLength(SOCKET sock);
+
   sockaddr_in m_config;
   sockaddr_in m_datatransport;
   SOCKET m_sock_config;
@@ -212,61 +212,84 @@ void NiController::DatatransportClientSocket_Open(const std::string& addr, uint1
     printf("----TCP/NI crate DATA TRANSPORT: The CONNECT executed OK...\n");
 }
 
+void NiController::RecvAll(SOCKET sock, char *buf, size_t len){
+  while(len > 0){
+    int numbytes = recv(sock, buf, static_cast<int>(len), MSG_WAITALL);
+    if(numbytes == -1){
+      if(errno == EINTR)
+        continue;
+      perror("recv()");
+      EUDAQ_THROW("DataTransportSocket: Read data error ");
+    }
+    if(numbytes == 0){
+      EUDAQ_THROW("DataTransportSocket: connection closed by the NI crate");
+    }
+    buf += numbytes;
+    len -= numbytes;
+  }
+}
+
+unsigned int NiController::RecvLength(SOCKET sock){
+  unsigned char len_buf[2];
+  RecvAll(sock, reinterpret_cast<char*>(len_buf), 2);
+  return (static_cast<unsigned int>(len_buf[0]) << 8) + len_buf[1];
+}
+
 unsigned int
 NiController::DataTransportClientSocket_ReadLength() {
-  unsigned int datalengthTmp;
-  unsigned int datalength;
-  int numbytes;
-  if ((numbytes = recv(m_sock_datatransport, m_buffer_length, 2, 0)) == -1) {
-    perror("recv()");
-    EUDAQ_THROW("DataTransportSocket: Read length error ");
-  } else {
-    datalengthTmp = 0;
-    datalengthTmp = 0xFF & m_buffer_length[0];
-    datalengthTmp <<= 8;
-    datalengthTmp += 0xFF & m_buffer_length[1];
-    datalength = datalengthTmp;
-
-  }
-  return datalength;
+  return RecvLength(m_sock_datatransport);
 }
 
 std::vector<unsigned char>
 NiController::DataTransportClientSocket_ReadData(int datalength) {
   std::vector<unsigned char> mimosa_data(datalength);
-  unsigned int stored_bytes;
-  unsigned int read_bytes_left;
-  unsigned int i;
-  bool dbg = false;
+  RecvAll(m_sock_datatransport, reinterpret_cast<char*>(mimosa_data.data()),
+	  mimosa_data.size());
+  return mimosa_data;
+}
 
-  stored_bytes = 0;
-  read_bytes_left = datalength;
-  int numbytes;
-  while (read_bytes_left > 0) {
-    if ((numbytes = recv(m_sock_datatransport, m_buffer_data, read_bytes_left, 0)) == -1) {
-      perror("recv()");
+void NiController::DataTransportClientSocket_ReadFrames(std::vector<unsigned char> &frame_0,
+							std::vector<unsigned char> &frame_1){
+  frame_0.resize(RecvLength(m_sock_datatransport));
+#ifndef WIN32
+  // the payload of the first frame and the length of the second one are
+  // fetched with a single readv
+  unsigned char len_buf[2];
+  iovec iov[2];
+  iov[0].iov_base = frame_0.data();
+  iov[0].iov_len = frame_0.size();
+  iov[1].iov_base = len_buf;
+  iov[1].iov_len = 2;
+  iovec *piov = iov;
+  int niov = 2;
+  while(niov > 0){
+    ssize_t numbytes = readv(m_sock_datatransport, piov, niov);
+    if(numbytes == -1){
+      if(errno == EINTR)
+        continue;
+      perror("readv()");
       EUDAQ_THROW("DataTransportSocket: Read data error ");
-    } else {
-      if (dbg)
-        printf("|==DataTransportClientSocket_ReadData==|    numbytes=%u \n",
-               static_cast<uint32_t>(numbytes));
-      read_bytes_left = read_bytes_left - numbytes;
-      for (int k = 0; k < numbytes; k++) {
-        mimosa_data[stored_bytes] = m_buffer_data[k];
-        stored_bytes++;
-      }
-      i = 0;
-      if (dbg) {
-        while ((int)i < numbytes) {
-          printf(" 0x%x%x", 0xFF & m_buffer_data[i], 0xFF & m_buffer_data[i + 1]);
-          i = i + 2;
-        }
-      }
+    }
+    if(numbytes == 0){
+      EUDAQ_THROW("DataTransportSocket: connection closed by the NI crate");
+    }
+    size_t n = static_cast<size_t>(numbytes);
+    while(niov > 0 && n >= piov->iov_len){
+      n -= piov->iov_len;
+      piov++;
+      niov--;
+    }
+    if(niov > 0){
+      piov->iov_base = static_cast<char*>(piov->iov_base) + n;
+      piov->iov_len -= n;
     }
   }
-  if (dbg)
-    printf("\n");
-  return mimosa_data;
+  frame_1.resize((static_cast<unsigned int>(len_buf[0]) << 8) + len_buf[1]);
+#else
+  RecvAll(m_sock_datatransport, reinterpret_cast<char*>(frame_0.data()), frame_0.size());
+  frame_1.resize(RecvLength(m_sock_datatransport));
+#endif
+  RecvAll(m_sock_datatransport, reinterpret_cast<char*>(frame_1.data()), frame_1.size());
 }
 
 void NiController::DatatransportClientSocket_Close() {
@@ -46,12 +46,9 @@ void NiProducer::RunLoop(){
       continue;
     }
     auto evup = eudaq::Event::MakeUnique("NiRawDataEvent");
-    uint32_t datalength1 = ni_control->DataTransportClientSocket_ReadLength();
-    std::vector<uint8_t> mimosa_data_0(datalength1);
-    mimosa_data_0 = ni_control->DataTransportClientSocket_ReadData(datalength1);
-    uint32_t datalength2 = ni_control->DataTransportClientSocket_ReadLength();
-    std::vector<uint8_t> mimosa_data_1(datalength2);
-    mimosa_data_1 = ni_control->DataTransportClientSocket_ReadData(datalength2);
+    std::vector<uint8_t> mimosa_data_0;
+    std::vector<uint8_t> mimosa_data_1;
+    ni_control->DataTransportClientSocket_ReadFrames(mimosa_data_0, mimosa_data_1);
     if(mimosa_data_0.size()>8){
       uint16_t tg_l15 = 0x7fff & (mimosa_data_0[6] + (mimosa_data_0[7]<<8));
       if(tg_l15 < last_tg_l15 && last_tg_l15>0x6000 && tg_l15<0x2000){
@@ -65,8 +62,8 @@ void NiProducer::RunLoop(){
       last_tg_l15 = tg_l15;
     }
     
-    evup->AddBlock(0, mimosa_data_0);
-    evup->AddBlock(1, mimosa_data_1);
+    evup->AddBlock(0, std::move(mimosa_data_0));
+    evup->AddBlock(1, std::move(mimosa_data_1));
     evup->AddBlock(2, m_conf_parameters);
     SendEvent(std::move(evup));
   }
@@ -74,14 +71,11 @@ void NiProducer::RunLoop(){
   std::chrono::milliseconds ms_dump(1000);
   auto tp_beg = std::chrono::steady_clock::now();
   auto tp_end = tp_beg + ms_dump;
+  std::vector<uint8_t> mimosa_data_0;
+  std::vector<uint8_t> mimosa_data_1;
   while(1){
     if(ni_control->DataTransportClientSocket_Select()){
-      uint32_t datalength1 = ni_control->DataTransportClientSocket_ReadLength();
-      std::vector<uint8_t> mimosa_data_0(datalength1);
-      mimosa_data_0 = ni_control->DataTransportClientSocket_ReadData(datalength1);
-      uint32_t datalength2 = ni_control->DataTransportClientSocket_ReadLength();
-      std::vector<uint8_t> mimosa_data_1(datalength2);
-      mimosa_data_1 = ni_control->DataTransportClientSocket_ReadData(datalength2);
+      ni_control->DataTransportClientSocket_ReadFrames(mimosa_data_0, mimosa_data_1);
     }
     auto tp_now = std::chrono::steady_clock::now();
     if(tp_now>tp_end){
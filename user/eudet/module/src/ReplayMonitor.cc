@@ -0,0 +1,98 @@
+#include "eudaq/Monitor.hh"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// Counterpart of the ReplayProducer: measures the rate of events arriving at
+// the end of the chain and their latency since the ReplayProducer sent them.
+class ReplayMonitor : public eudaq::Monitor {
+public:
+  ReplayMonitor(const std::string & name, const std::string & runcontrol);
+  void DoStartRun() override;
+  void DoStopRun() override;
+  void DoStatus() override;
+  void DoReceive(eudaq::EventSP ev) override;
+
+  static const uint32_t m_id_factory = eudaq::cstr2hash("ReplayMonitor");
+private:
+  void AddLatency(const eudaq::Event &ev, int64_t now_ns);
+  std::string Summary();
+
+  std::mutex m_mtx_stat;
+  uint64_t m_n_ev;
+  uint64_t m_n_lat;
+  double m_lat_sum_ms;
+  double m_lat_max_ms;
+  std::chrono::steady_clock::time_point m_tp_first;
+  std::chrono::steady_clock::time_point m_tp_last;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::Monitor>::
+    Register<ReplayMonitor, const std::string&, const std::string&>(ReplayMonitor::m_id_factory);
+}
+
+ReplayMonitor::ReplayMonitor(const std::string & name, const std::string & runcontrol)
+  :eudaq::Monitor(name, runcontrol), m_n_ev(0), m_n_lat(0), m_lat_sum_ms(0), m_lat_max_ms(0){
+}
+
+void ReplayMonitor::DoStartRun(){
+  std::unique_lock<std::mutex> lk(m_mtx_stat);
+  m_n_ev = 0;
+  m_n_lat = 0;
+  m_lat_sum_ms = 0;
+  m_lat_max_ms = 0;
+}
+
+void ReplayMonitor::DoStopRun(){
+  EUDAQ_INFO("ReplayMonitor: " + Summary());
+}
+
+void ReplayMonitor::AddLatency(const eudaq::Event &ev, int64_t now_ns){
+  std::string ts = ev.GetTag("REPLAY_SEND_NS");
+  if(!ts.empty()){
+    double ms = (now_ns - std::stoll(ts)) / 1e6;
+    m_lat_sum_ms += ms;
+    if(ms > m_lat_max_ms)
+      m_lat_max_ms = ms;
+    m_n_lat++;
+  }
+  for(auto &sub: ev.GetSubEvents())
+    AddLatency(*sub, now_ns);
+}
+
+void ReplayMonitor::DoReceive(eudaq::EventSP ev){
+  int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>
+    (std::chrono::system_clock::now().time_since_epoch()).count();
+  std::unique_lock<std::mutex> lk(m_mtx_stat);
+  m_tp_last = std::chrono::steady_clock::now();
+  if(!m_n_ev)
+    m_tp_first = m_tp_last;
+  m_n_ev++;
+  AddLatency(*ev, now_ns);
+}
+
+std::string ReplayMonitor::Summary(){
+  std::unique_lock<std::mutex> lk(m_mtx_stat);
+  double sec = std::chrono::duration<double>(m_tp_last - m_tp_first).count();
+  std::string s = std::to_string(m_n_ev) + " events";
+  if(sec > 0)
+    s += ", " + std::to_string(m_n_ev / sec) + " Hz";
+  if(m_n_lat)
+    s += ", latency mean " + std::to_string(m_lat_sum_ms / m_n_lat) +
+      " ms, max " + std::to_string(m_lat_max_ms) + " ms";
+  return s;
+}
+
+void ReplayMonitor::DoStatus(){
+  std::unique_lock<std::mutex> lk(m_mtx_stat);
+  double sec = std::chrono::duration<double>(m_tp_last - m_tp_first).count();
+  SetStatusTag("Events", std::to_string(m_n_ev));
+  if(sec > 0)
+    SetStatusTag("Rate [Hz]", std::to_string(m_n_ev / sec));
+  if(m_n_lat){
+    SetStatusTag("Latency mean [ms]", std::to_string(m_lat_sum_ms / m_n_lat));
+    SetStatusTag("Latency max [ms]", std::to_string(m_lat_max_ms));
+  }
+}
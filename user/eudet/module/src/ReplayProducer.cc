@@ -0,0 +1,200 @@
+#include "eudaq/Producer.hh"
+#include "eudaq/FileReader.hh"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <deque>
+
+// Streams the events of an existing raw file into the data chain, so that
+// DataCollectors, Monitors and converters can be load tested without
+// hardware. Several instances split the recorded devices among each other
+// by device number: an instance sends the (sub-)events whose device number
+// modulo REPLAY_NUM_INSTANCES equals its REPLAY_INSTANCE.
+class ReplayProducer : public eudaq::Producer {
+public:
+  ReplayProducer(const std::string name, const std::string &runcontrol);
+  void DoInitialise() override;
+  void DoConfigure() override;
+  void DoStartRun() override;
+  void DoStopRun() override;
+  void DoReset() override;
+  void DoTerminate() override;
+  void DoStatus() override;
+  void RunLoop() override;
+
+  static const uint32_t m_id_factory = eudaq::cstr2hash("ReplayProducer");
+private:
+  eudaq::FileReaderSP OpenFile();
+  bool NextEvent(eudaq::FileReaderSP &reader, eudaq::EventSP &ev);
+  void Select(eudaq::EventSPC ev, std::deque<eudaq::EventSP> &out) const;
+
+  std::string m_path;
+  std::string m_type;
+  double m_rate;
+  bool m_loop;
+  bool m_preload;
+  uint32_t m_n_instance;
+  uint32_t m_instance;
+  std::vector<eudaq::EventSP> m_evs;
+  std::deque<eudaq::EventSP> m_qu_ev;
+  size_t m_ev_idx;
+
+  std::atomic<bool> m_exit_of_run;
+  std::atomic<uint64_t> m_n_sent;
+  std::atomic<uint64_t> m_ns_run;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::Producer>::
+    Register<ReplayProducer, const std::string&, const std::string&>(ReplayProducer::m_id_factory);
+}
+
+ReplayProducer::ReplayProducer(const std::string name, const std::string &runcontrol)
+  :eudaq::Producer(name, runcontrol), m_rate(0), m_loop(false), m_preload(true),
+   m_n_instance(1), m_instance(0), m_ev_idx(0),
+   m_exit_of_run(false), m_n_sent(0), m_ns_run(0){
+}
+
+void ReplayProducer::DoInitialise(){
+}
+
+void ReplayProducer::DoConfigure(){
+  auto conf = GetConfiguration();
+  m_path = conf->Get("REPLAY_FILE", "");
+  if(m_path.empty())
+    EUDAQ_THROW("ReplayProducer: REPLAY_FILE is not set");
+  std::string type = m_path.substr(m_path.find_last_of(".")+1);
+  if(type == "raw")
+    type = "native";
+  m_type = conf->Get("REPLAY_FILE_TYPE", type);
+  m_rate = conf->Get("REPLAY_RATE_HZ", 0.0);
+  m_loop = conf->Get("REPLAY_LOOP", 0);
+  m_preload = conf->Get("REPLAY_PRELOAD", 1);
+  m_n_instance = conf->Get("REPLAY_NUM_INSTANCES", 1);
+  m_instance = conf->Get("REPLAY_INSTANCE", 0);
+  if(!m_n_instance || m_instance >= m_n_instance)
+    EUDAQ_THROW("ReplayProducer: REPLAY_INSTANCE has to be smaller than REPLAY_NUM_INSTANCES");
+
+  m_evs.clear();
+  if(m_preload){
+    // keep file reading and deserialisation out of the timed loop
+    auto reader = OpenFile();
+    eudaq::EventSP ev;
+    while(NextEvent(reader, ev))
+      m_evs.push_back(ev);
+    if(m_evs.empty())
+      EUDAQ_THROW("ReplayProducer: no event for instance "+std::to_string(m_instance)+" in "+m_path);
+    EUDAQ_INFO("ReplayProducer: "+std::to_string(m_evs.size())+" events loaded from "+m_path);
+  }
+}
+
+eudaq::FileReaderSP ReplayProducer::OpenFile(){
+  auto reader = eudaq::FileReader::Make(m_type, m_path);
+  if(!reader)
+    EUDAQ_THROW("ReplayProducer: unable to open "+m_path+" as "+m_type);
+  m_qu_ev.clear();
+  return reader;
+}
+
+void ReplayProducer::Select(eudaq::EventSPC ev, std::deque<eudaq::EventSP> &out) const{
+  uint32_t nsub = ev->GetNumSubEvent();
+  if(nsub){
+    for(uint32_t i = 0; i < nsub; i++)
+      Select(ev->GetSubEvent(i), out);
+    return;
+  }
+  if(ev->GetDeviceN() % m_n_instance != m_instance)
+    return;
+  // the reader is owned by this producer, nobody else holds the event
+  out.push_back(std::const_pointer_cast<eudaq::Event>(ev));
+}
+
+bool ReplayProducer::NextEvent(eudaq::FileReaderSP &reader, eudaq::EventSP &ev){
+  while(m_qu_ev.empty()){
+    auto evf = reader->GetNextEvent();
+    if(!evf)
+      return false;
+    Select(evf, m_qu_ev);
+  }
+  ev = m_qu_ev.front();
+  m_qu_ev.pop_front();
+  return true;
+}
+
+void ReplayProducer::DoStartRun(){
+  m_exit_of_run = false;
+  m_n_sent = 0;
+  m_ns_run = 0;
+  m_ev_idx = 0;
+}
+
+void ReplayProducer::DoStopRun(){
+  m_exit_of_run = true;
+}
+
+void ReplayProducer::DoReset(){
+  m_exit_of_run = true;
+  m_evs.clear();
+  m_qu_ev.clear();
+}
+
+void ReplayProducer::DoTerminate(){
+  m_exit_of_run = true;
+}
+
+void ReplayProducer::DoStatus(){
+  uint64_t n = m_n_sent;
+  double sec = m_ns_run / 1e9;
+  SetStatusTag("Events", std::to_string(n));
+  if(sec > 0)
+    SetStatusTag("Rate [Hz]", std::to_string(n / sec));
+}
+
+void ReplayProducer::RunLoop(){
+  eudaq::FileReaderSP reader;
+  if(!m_preload)
+    reader = OpenFile();
+  std::chrono::nanoseconds period(m_rate > 0 ? static_cast<int64_t>(1e9 / m_rate) : 0);
+  auto tp_start = std::chrono::steady_clock::now();
+  auto tp_next = tp_start;
+  bool isbegin = true;
+  while(!m_exit_of_run){
+    eudaq::EventSP ev;
+    if(m_preload){
+      if(m_ev_idx == m_evs.size()){
+	if(!m_loop)
+	  break;
+	m_ev_idx = 0;
+      }
+      ev = m_evs[m_ev_idx++];
+    }
+    else if(!NextEvent(reader, ev)){
+      if(!m_loop)
+	break;
+      reader = OpenFile();
+      continue;
+    }
+
+    ev->ClearFlagBit(eudaq::Event::Flags::FLAG_BORE);
+    ev->ClearFlagBit(eudaq::Event::Flags::FLAG_EORE);
+    if(isbegin){
+      ev->SetBORE();
+      isbegin = false;
+    }
+    // wall clock, so that the latency can be measured in another process
+    ev->SetTag("REPLAY_SEND_NS", std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>
+						 (std::chrono::system_clock::now().time_since_epoch()).count()));
+    SendEvent(ev);
+    m_n_sent++;
+    m_ns_run = std::chrono::duration_cast<std::chrono::nanoseconds>
+      (std::chrono::steady_clock::now() - tp_start).count();
+    if(period.count()){
+      tp_next += period;
+      std::this_thread::sleep_until(tp_next);
+    }
+  }
+  double sec = m_ns_run / 1e9;
+  EUDAQ_INFO("ReplayProducer: "+std::to_string(m_n_sent)+" events sent in "+std::to_string(sec)+" s"+
+	     (sec > 0 ? ", "+std::to_string(m_n_sent/sec)+" Hz" : std::string()));
+}
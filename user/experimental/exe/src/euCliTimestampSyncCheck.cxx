@@ -0,0 +1,120 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/Exception.hh"
+#include "TimestampSyncBuilder.hh"
+
+#include <iostream>
+
+// Feeds two streams, one of them lagging, through TimestampSyncBuilder and
+// checks the release of windows by the watermark, the windows forced by
+// the queue limit and each policy for late events.
+namespace{
+  using Builder = eudaq::TimestampSyncBuilder;
+
+  uint32_t n_fail = 0;
+
+  void Check(bool ok, const std::string &what){
+    if(!ok){
+      std::cout<<"FAILED: "<<what<<std::endl;
+      n_fail++;
+    }
+  }
+
+  eudaq::EventSPC Make(const std::string &name, uint64_t ts){
+    auto ev = eudaq::Event::MakeShared(name);
+    ev->SetTimestamp(ts, ts + 10);
+    return ev;
+  }
+
+  // A runs ahead, B follows: a window is only released once B has passed it
+  void Watermark(){
+    Builder b("TsyncCheck");
+    b.SetWindow(10);
+    b.AddStream("A");
+    b.AddStream("B");
+    size_t n = 0;
+    for(uint64_t ts = 0; ts < 30; ts += 10)
+      n += b.Push("A", Make("A", ts)).size();
+    Check(n == 0, "watermark: nothing released before B has data");
+    n = b.Push("B", Make("B", 0)).size();
+    Check(n == 0, "watermark: [0,10) held while B is at 0");
+    auto out = b.Push("B", Make("B", 10));
+    Check(out.size() == 1, "watermark: [0,10) released once B reaches 10");
+    if(out.size() == 1){
+      Check(out[0]->GetNumSubEvent() == 2, "watermark: [0,10) holds one event of each stream");
+      Check(!out[0]->HasTag("PARTIAL"), "watermark: complete window not tagged PARTIAL");
+    }
+    Check(b.GetStats()["B"].lag == 10, "watermark: lag of B is 10");
+    out = b.Push("B", Make("B", 20));
+    Check(out.size() == 1 && out[0]->GetTimestampBegin() == 10, "watermark: [10,20) released once B reaches 20");
+    out = b.Flush();
+    Check(out.size() == 1 && out[0]->GetNumSubEvent() == 2, "watermark: flush releases [20,30)");
+    Check(b.GetStats()["A"].queued == 0 && b.GetStats()["B"].queued == 0, "watermark: nothing left after flush");
+  }
+
+  // B stays silent, A exceeds the queue limit and forces its windows, then
+  // an event of B for a closed window arrives
+  void ForcedAndLate(const std::string &policy){
+    Builder b("TsyncCheck");
+    b.SetWindow(10);
+    b.SetMaxQueue(3);
+    b.SetLatePolicy(Builder::ParseLatePolicy(policy));
+    b.AddStream("A");
+    b.AddStream("B");
+    std::vector<eudaq::EventSP> out;
+    for(uint64_t ts = 0; ts < 50; ts += 10)
+      for(auto &ev: b.Push("A", Make("A", ts)))
+	out.push_back(ev);
+    Check(out.size() == 2, policy + ": two windows forced by the queue limit");
+    for(auto &ev: out){
+      Check(ev->GetNumSubEvent() == 1, policy + ": forced window holds the event of A only");
+      Check(ev->HasTag("PARTIAL") == (policy == "flag"), policy + ": PARTIAL tag of a forced window");
+    }
+    auto stats = b.GetStats();
+    Check(stats["A"].queued == 3, policy + ": queue of A back at the limit");
+    Check(stats["B"].missing == 2, policy + ": B missing from both forced windows");
+
+    out = b.Push("B", Make("B", 5));
+    Check(b.GetStats()["B"].late == 1, policy + ": event of B counted late");
+    if(policy == "drop")
+      Check(out.empty(), "drop: late event discarded");
+    else{
+      Check(out.size() == 1 && out[0]->GetNumSubEvent() == 1 && out[0]->GetTimestampBegin() == 5,
+	    policy + ": late event emitted on its own");
+      if(out.size() == 1)
+	Check(out[0]->HasTag("LATE") == (policy == "flag"), policy + ": LATE tag of a late event");
+    }
+    Check(b.GetStats()["B"].queued == 0, policy + ": late event not queued");
+  }
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ timestamp sync check", "2.0", "Checks the window building of TimestampSyncBuilder");
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+  try{
+    Watermark();
+    for(auto &policy: {"drop", "partial", "flag"})
+      ForcedAndLate(policy);
+    bool thrown = false;
+    try{
+      Builder::ParseLatePolicy("keep");
+    }catch(const eudaq::Exception &){
+      thrown = true;
+    }
+    Check(thrown, "unknown late policy refused");
+  }
+  catch(const std::exception &e){
+    std::cout<<e.what()<<std::endl;
+    n_fail++;
+  }
+  if(n_fail){
+    std::cout<<n_fail<<" checks failed"<<std::endl;
+    return 1;
+  }
+  std::cout<<"all checks passed"<<std::endl;
+  return 0;
+}
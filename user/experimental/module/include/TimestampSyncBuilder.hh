@@ -0,0 +1,91 @@
+#ifndef TIMESTAMPSYNCBUILDER_HH
+#define TIMESTAMPSYNCBUILDER_HH
+
+#include "eudaq/Event.hh"
+#include "eudaq/Metrics.hh"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <queue>
+#include <memory>
+
+namespace eudaq {
+  /**
+   * Builds packets out of the events of several streams by time window.
+   * A window starts at the earliest pending begin timestamp and lasts
+   * SetWindow() (or, if 0, as long as the earliest event). It is closed
+   * once the watermark, i.e. the smallest latest begin timestamp over all
+   * streams, has passed its end, or as soon as one stream has more than
+   * SetMaxQueue() events pending, which bounds the memory when a stream
+   * lags. Events arriving for an already closed window are late and are
+   * handled according to SetLatePolicy().
+   */
+  class TimestampSyncBuilder {
+  public:
+    enum LatePolicy {
+      LATE_DROP,    // discard the late events
+      LATE_PARTIAL, // emit each late event as its own packet
+      LATE_FLAG     // as LATE_PARTIAL, with the tag LATE on these and PARTIAL on forced windows
+    };
+    struct StreamStats {
+      uint64_t lag;     // behind the most advanced stream, in timestamp units
+      uint64_t queued;  // events waiting for their window
+      uint64_t late;    // events arrived after their window was closed
+      uint64_t missing; // forced windows closed without an event of this stream
+    };
+
+    explicit TimestampSyncBuilder(const std::string &description);
+    void SetWindow(uint64_t window) {m_window = window;}
+    void SetMaxQueue(uint64_t n) {m_max_queue = n;}
+    void SetLatePolicy(LatePolicy policy) {m_late_policy = policy;}
+    static LatePolicy ParseLatePolicy(const std::string &policy);
+
+    /// Returns false if the stream already exists
+    bool AddStream(const std::string &name);
+    /// The pending events of the stream are still built
+    std::vector<EventSP> RemoveStream(const std::string &name);
+    /// Adds an event, returns the packets completed by it in time order
+    std::vector<EventSP> Push(const std::string &name, EventSPC ev);
+    /// Closes all the pending windows, e.g. at the end of run
+    std::vector<EventSP> Flush();
+    /// Drops the pending events and the statistics, keeps the streams
+    void Clear();
+    std::map<std::string, StreamStats> GetStats() const;
+
+  private:
+    struct Stream {
+      uint64_t progress = 0;
+      bool seen = false;
+      uint64_t queued = 0;
+      uint64_t late = 0;
+      uint64_t missing = 0;
+    };
+    struct Pending {
+      uint64_t beg;
+      uint64_t end;
+      uint64_t seq;
+      std::shared_ptr<Stream> stream;
+      EventSPC ev;
+      bool operator>(const Pending &o) const {
+	return beg != o.beg ? beg > o.beg : seq > o.seq;
+      }
+    };
+    void Build(bool flush, std::vector<EventSP> &out);
+    EventSP Late(EventSPC ev);
+
+    std::string m_description;
+    uint64_t m_window;
+    uint64_t m_max_queue;
+    LatePolicy m_late_policy;
+    std::map<std::string, std::shared_ptr<Stream>> m_streams;
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> m_pending;
+    uint64_t m_seq;
+    uint64_t m_closed;
+    bool m_has_closed;
+    MetricCounter &m_c_late;
+    MetricCounter &m_c_forced;
+  };
+}
+
+#endif
@@ -0,0 +1,138 @@
+#include "TimestampSyncBuilder.hh"
+#include "eudaq/Exception.hh"
+
+#include <algorithm>
+#include <set>
+
+namespace eudaq {
+  TimestampSyncBuilder::TimestampSyncBuilder(const std::string &description)
+    :m_description(description), m_window(0), m_max_queue(10000),
+     m_late_policy(LATE_FLAG), m_seq(0), m_closed(0), m_has_closed(false),
+     m_c_late(Metrics::Instance().Counter("tsync_late_events")),
+     m_c_forced(Metrics::Instance().Counter("tsync_forced_windows")){
+  }
+
+  TimestampSyncBuilder::LatePolicy TimestampSyncBuilder::ParseLatePolicy(const std::string &policy){
+    if(policy == "drop")
+      return LATE_DROP;
+    if(policy == "partial")
+      return LATE_PARTIAL;
+    if(policy == "flag")
+      return LATE_FLAG;
+    EUDAQ_THROW("TimestampSyncBuilder: unknown late data policy '" + policy + "' (drop, partial or flag)");
+  }
+
+  bool TimestampSyncBuilder::AddStream(const std::string &name){
+    if(m_streams.count(name))
+      return false;
+    m_streams[name] = std::make_shared<Stream>();
+    return true;
+  }
+
+  std::vector<EventSP> TimestampSyncBuilder::RemoveStream(const std::string &name){
+    std::vector<EventSP> out;
+    m_streams.erase(name);
+    Build(false, out);
+    return out;
+  }
+
+  std::vector<EventSP> TimestampSyncBuilder::Push(const std::string &name, EventSPC ev){
+    std::vector<EventSP> out;
+    auto &stream = m_streams[name];
+    if(!stream)
+      stream = std::make_shared<Stream>();
+    uint64_t beg = ev->GetTimestampBegin();
+    uint64_t end = std::max(ev->GetTimestampEnd(), beg + 1);
+    if(m_has_closed && beg < m_closed){
+      stream->late++;
+      m_c_late.Add();
+      if(m_late_policy != LATE_DROP)
+	out.push_back(Late(ev));
+      return out;
+    }
+    stream->progress = std::max(stream->progress, beg);
+    stream->seen = true;
+    stream->queued++;
+    m_pending.push(Pending{beg, end, m_seq++, stream, ev});
+    Build(false, out);
+    return out;
+  }
+
+  std::vector<EventSP> TimestampSyncBuilder::Flush(){
+    std::vector<EventSP> out;
+    Build(true, out);
+    return out;
+  }
+
+  void TimestampSyncBuilder::Clear(){
+    m_pending = decltype(m_pending)();
+    for(auto &s: m_streams)
+      *s.second = Stream();
+    m_seq = 0;
+    m_closed = 0;
+    m_has_closed = false;
+  }
+
+  std::map<std::string, TimestampSyncBuilder::StreamStats> TimestampSyncBuilder::GetStats() const{
+    uint64_t front = 0;
+    for(auto &s: m_streams)
+      front = std::max(front, s.second->progress);
+    std::map<std::string, StreamStats> stats;
+    for(auto &s: m_streams)
+      stats[s.first] = StreamStats{front - s.second->progress, s.second->queued,
+				   s.second->late, s.second->missing};
+    return stats;
+  }
+
+  void TimestampSyncBuilder::Build(bool flush, std::vector<EventSP> &out){
+    while(!m_pending.empty()){
+      uint64_t w_beg = m_pending.top().beg;
+      uint64_t w_end = m_window ? w_beg + m_window : m_pending.top().end;
+      bool ready = true;
+      bool forced = flush;
+      for(auto &s: m_streams){
+	if(!s.second->seen || s.second->progress < w_end)
+	  ready = false;
+	if(s.second->queued > m_max_queue)
+	  forced = true;
+      }
+      if(!ready && !forced)
+	break;
+
+      auto ev_wrap = Event::MakeShared(m_description);
+      ev_wrap->SetFlagPacket();
+      uint64_t ts_end = w_end;
+      std::set<Stream*> present;
+      while(!m_pending.empty() && m_pending.top().beg < w_end){
+	auto &p = m_pending.top();
+	ts_end = std::max(ts_end, p.end);
+	p.stream->queued--;
+	present.insert(p.stream.get());
+	ev_wrap->AddSubEvent(p.ev);
+	m_pending.pop();
+      }
+      ev_wrap->SetTimestamp(w_beg, ts_end);
+      if(!ready && !flush){
+	m_c_forced.Add();
+	for(auto &s: m_streams)
+	  if(!present.count(s.second.get()))
+	    s.second->missing++;
+	if(m_late_policy == LATE_FLAG && present.size() < m_streams.size())
+	  ev_wrap->SetTag("PARTIAL", "1");
+      }
+      m_closed = w_end;
+      m_has_closed = true;
+      out.push_back(ev_wrap);
+    }
+  }
+
+  EventSP TimestampSyncBuilder::Late(EventSPC ev){
+    auto ev_wrap = Event::MakeShared(m_description);
+    ev_wrap->SetFlagPacket();
+    ev_wrap->SetTimestamp(ev->GetTimestampBegin(), ev->GetTimestampEnd());
+    ev_wrap->AddSubEvent(ev);
+    if(m_late_policy == LATE_FLAG)
+      ev_wrap->SetTag("LATE", "1");
+    return ev_wrap;
+  }
+}
@@ -0,0 +1,82 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/StdEventConverter.hh"
+#include "eudaq/StandardEvent.hh"
+#include "eudaq/Configuration.hh"
+#include "Timepix3Event2StdEventConverter.hh"
+
+#include <iostream>
+#include <fstream>
+
+// Runs the Timepix3 converter with complete, short and narrow calibration
+// tables: only the complete ones may be accepted.
+namespace{
+  // rows of pixel x, pixel y and n_const constants
+  void WriteTable(const std::string &path, size_t n_row, size_t n_const){
+    std::ofstream f(path, std::ios::trunc);
+    f<<"# col row constants\n";
+    for(size_t i = 0; i < n_row; i++){
+      f<<i % 256<<" "<<i / 256;
+      for(size_t j = 0; j < n_const; j++)
+	f<<" "<<1 + j;
+      f<<"\n";
+    }
+  }
+
+  // true if the calibration was refused with DataInvalid
+  bool Refused(const std::string &tot, const std::string &toa){
+    eudaq::Timepix3RawEvent2StdEventConverter cvt;
+    auto ev = eudaq::Event::MakeShared("Timepix3RawEvent");
+    ev->AddBlock(0, std::vector<uint8_t>(8, 0));
+    auto conf = std::make_shared<eudaq::Configuration>();
+    conf->Set("calibration_path_tot", tot);
+    conf->Set("calibration_path_toa", toa);
+    try{
+      cvt.Converting(ev, eudaq::StandardEvent::MakeShared(), conf);
+    }catch(const eudaq::DataInvalid &e){
+      std::cout<<tot<<", "<<toa<<": "<<e.what()<<std::endl;
+      return true;
+    }
+    return false;
+  }
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Timepix3 calibration check", "2.0", "Checks the loading of the Timepix3 calibration tables");
+  eudaq::Option<std::string> dir(op, "d", "directory", ".", "string", "directory of the generated tables");
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+  EUDAQ_LOG_LEVEL("ERROR");
+
+  std::string tot = dir.Value() + "/tpx3_calib_tot.txt";
+  std::string toa = dir.Value() + "/tpx3_calib_toa.txt";
+  std::string tot_short = dir.Value() + "/tpx3_calib_tot_short.txt";
+  std::string toa_narrow = dir.Value() + "/tpx3_calib_toa_narrow.txt";
+  WriteTable(tot, 256 * 256, 4);
+  WriteTable(toa, 256 * 256, 3);
+  WriteTable(tot_short, 1000, 4);
+  WriteTable(toa_narrow, 256 * 256, 2);
+
+  uint32_t n_fail = 0;
+  if(Refused(tot, toa)){
+    std::cout<<"FAILED: complete tables refused"<<std::endl;
+    n_fail++;
+  }
+  if(!Refused(tot_short, toa)){
+    std::cout<<"FAILED: short ToT table accepted"<<std::endl;
+    n_fail++;
+  }
+  if(!Refused(tot, toa_narrow)){
+    std::cout<<"FAILED: ToA table with too few constants accepted"<<std::endl;
+    n_fail++;
+  }
+  if(n_fail){
+    std::cout<<n_fail<<" checks failed"<<std::endl;
+    return 1;
+  }
+  std::cout<<"all checks passed"<<std::endl;
+  return 0;
+}
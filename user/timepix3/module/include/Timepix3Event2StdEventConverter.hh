@@ -2,33 +2,32 @@
 #include "eudaq/RawEvent.hh"
 #include "eudaq/Logger.hh"
 
+#include <array>
+#include <memory>
+
 /**
 * Timepix3 event converter, converting from raw detector data to EUDAQ StandardEvent format
 * SPIDR provides two event types, pixel data and trigger information events.
+* The state carried from event to event (synchronisation time, TDC overflows) is kept
+* per configuration and per device, so that several devices and files can be converted
+* concurrently. Calibration tables are loaded once per file pair and shared.
 */
 namespace eudaq {
   class Timepix3RawEvent2StdEventConverter: public eudaq::StdEventConverter{
   public:
     bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
     static const uint32_t m_id_factory = eudaq::cstr2hash("Timepix3RawEvent");
+    /// Per pixel ToT constants a, b, c, t and ToA constants c, t, d, indexed by 256 * row + col
+    using Calibration = std::vector<std::array<float, 7>>;
+    static std::shared_ptr<const Calibration> GetCalibration(const std::string &path_tot, const std::string &path_toa);
   private:
-    static uint64_t m_syncTime;
-    static uint64_t m_syncTime_prev;
-    static uint64_t m_delta_t0;
-    static bool m_clearedHeader;
-    static bool m_first_time;
-    static std::vector<std::vector<float>> vtot;
-    static std::vector<std::vector<float>> vtoa;
-
-    void loadCalibration(std::string path, char delim, std::vector<std::vector<float>>& dat) const;
+    static void loadCalibration(std::string path, char delim, std::vector<std::vector<float>>& dat);
   };
 
   class Timepix3TrigEvent2StdEventConverter: public eudaq::StdEventConverter{
   public:
     bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
     static const uint32_t m_id_factory = eudaq::cstr2hash("Timepix3TrigEvent");
-    static long long int m_syncTimeTDC;
-    static int m_TDCoverflowCounter;
   };
 
 } // namespace eudaq
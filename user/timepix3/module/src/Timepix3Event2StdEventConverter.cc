@@ -1,5 +1,8 @@
 #include "Timepix3Event2StdEventConverter.hh"
 #include <cmath> // for sqrt()
+#include <map>
+#include <mutex>
+#include <tuple>
 
 using namespace eudaq;
 
@@ -8,10 +11,62 @@ namespace {
   Register<Timepix3RawEvent2StdEventConverter>(Timepix3RawEvent2StdEventConverter::m_id_factory);
   auto dummy1 = eudaq::Factory<eudaq::StdEventConverter>::
   Register<Timepix3TrigEvent2StdEventConverter>(Timepix3TrigEvent2StdEventConverter::m_id_factory);
+
+  /**
+   * Cross-event state of the converters, one per configuration, i.e. per
+   * conversion, and per device. The entry of a configuration that has been
+   * released is replaced by a fresh one.
+   */
+  template <typename T> class StateMap {
+  public:
+    std::shared_ptr<T> Get(const EventSPC &ev, const ConfigurationSPC &conf, bool &created) {
+      Key key(conf.get(), ev->GetStreamN(), ev->GetDeviceN());
+      std::lock_guard<std::mutex> lk(m_mx);
+      auto it = m_states.find(key);
+      created = it == m_states.end() || (conf == nullptr) != (it->second.conf.lock() == nullptr);
+      if(!created)
+        return it->second.state;
+      for(auto i = m_states.begin(); i != m_states.end();) {
+        if(std::get<0>(i->first) && i->second.conf.expired())
+          i = m_states.erase(i);
+        else
+          ++i;
+      }
+      Entry &e = m_states[key];
+      e.conf = conf;
+      e.state = std::make_shared<T>();
+      return e.state;
+    }
+
+  private:
+    using Key = std::tuple<const Configuration*, uint32_t, uint32_t>;
+    struct Entry {
+      std::weak_ptr<const Configuration> conf;
+      std::shared_ptr<T> state;
+    };
+    std::mutex m_mx;
+    std::map<Key, Entry> m_states;
+  };
+
+  struct TrigState {
+    std::mutex mx;
+    long long int syncTimeTDC = 0;
+    int TDCoverflowCounter = 0;
+  };
+
+  struct RawState {
+    std::mutex mx;
+    uint64_t syncTime = 0;
+    uint64_t syncTime_prev = 0;
+    uint64_t delta_t0 = 1e6;
+    bool clearedHeader = false;
+    std::shared_ptr<const Timepix3RawEvent2StdEventConverter::Calibration> calib;
+  };
+
+  StateMap<TrigState> trig_states;
+  StateMap<RawState> raw_states;
 }
 
-long long int Timepix3TrigEvent2StdEventConverter::m_syncTimeTDC(0);
-int Timepix3TrigEvent2StdEventConverter::m_TDCoverflowCounter(0);
 bool Timepix3TrigEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
 
   // Bad event
@@ -29,6 +84,10 @@ bool Timepix3TrigEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::
   }
   memcpy(&trigdata, &data[0],data.size());
 
+  bool created;
+  auto state = trig_states.Get(ev, conf, created);
+  std::lock_guard<std::mutex> lk(state->mx);
+
   // Get the header (first 4 bits): 0x4 is the "heartbeat" signal, 0xA and 0xB are pixel data
   const uint8_t header = static_cast<uint8_t>((trigdata & 0xF000000000000000) >> 60) & 0xF;
   const uint8_t header2 = ((trigdata & 0x0F00000000000000) >> 56) & 0xF;
@@ -60,11 +119,11 @@ bool Timepix3TrigEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::
   }
 
   // if jump back in time is larger than 1 sec, overflow detected...
-  if((m_syncTimeTDC - timestamp_raw) > 0x1312d000) {
-    m_TDCoverflowCounter++;
+  if((state->syncTimeTDC - timestamp_raw) > 0x1312d000) {
+    state->TDCoverflowCounter++;
   }
-  m_syncTimeTDC = timestamp_raw;
-  timestamp = timestamp_raw + (static_cast<long long int>(m_TDCoverflowCounter) << 35);
+  state->syncTimeTDC = timestamp_raw;
+  timestamp = timestamp_raw + (static_cast<long long int>(state->TDCoverflowCounter) << 35);
 
   // Calculate timestamp in picoseconds assuming 320 MHz clock:
   uint64_t triggerTime = timestamp * 3125 +(stamp * 3125) / 12;
@@ -79,22 +138,22 @@ bool Timepix3TrigEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::
   return true;
 }
 
-uint64_t Timepix3RawEvent2StdEventConverter::m_syncTime(0);
-uint64_t Timepix3RawEvent2StdEventConverter::m_syncTime_prev(0);
-uint64_t Timepix3RawEvent2StdEventConverter::m_delta_t0(1e6);
-bool Timepix3RawEvent2StdEventConverter::m_clearedHeader(false);
-bool Timepix3RawEvent2StdEventConverter::m_first_time(true);
-std::vector<std::vector<float>> Timepix3RawEvent2StdEventConverter::vtot;
-std::vector<std::vector<float>> Timepix3RawEvent2StdEventConverter::vtoa;
-
 bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
 
-  // Read from configuration:
-  if(m_first_time) {
-      m_delta_t0 = (conf ? conf->Get("delta_t0", 1e6) : 1e6); // default: 1sec
+  // No event
+  if(!ev || ev->NumBlocks() < 1) {
+    return false;
+  }
+
+  bool created;
+  auto state = raw_states.Get(ev, conf, created);
+  std::lock_guard<std::mutex> lk(state->mx);
+
+  // Read from configuration for the first event of this device:
+  if(created) {
+      state->delta_t0 = (conf ? conf->Get("delta_t0", 1e6) : 1e6); // default: 1sec
 
-      EUDAQ_INFO("Will detect 2nd T0 indirectly if timestamp jumps back by more than " + to_string(m_delta_t0) + "us.");
-      m_first_time = false;
+      EUDAQ_INFO("Will detect 2nd T0 indirectly if timestamp jumps back by more than " + to_string(state->delta_t0) + "us.");
 
       if(conf && conf->Has("calibration_path_tot") && conf->Has("calibration_path_toa")) {
           std::string calibrationPathToT = conf->Get("calibration_path_tot","");
@@ -109,37 +168,15 @@ bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::S
 
           EUDAQ_INFO("Applying ToT calibration from " + calibrationPathToT);
           EUDAQ_INFO("Applying ToA calibration from " + calibrationPathToA);
-
-          std::string tmp;
-          loadCalibration(calibrationPathToT, ' ', vtot);
-          loadCalibration(calibrationPathToA, ' ', vtoa);
-
-            for(size_t row = 0; row < 256; row++) {
-                for(size_t col = 0; col < 256; col++) {
-                    float a = vtot.at(256 * row + col).at(2);
-                    float b = vtot.at(256 * row + col).at(3);
-                    float c = vtot.at(256 * row + col).at(4);
-                    float t = vtot.at(256 * row + col).at(5);
-                    float toa_c = vtoa.at(256 * row + col).at(2);
-                    float toa_t = vtoa.at(256 * row + col).at(3);
-                    float toa_d = vtoa.at(256 * row + col).at(4);
-
-                    double cold = static_cast<double>(col);
-                    double rowd = static_cast<double>(row);
-                }
-            }
+          state->calib = GetCalibration(calibrationPathToT, calibrationPathToA);
         } else {
             EUDAQ_INFO("No calibration file path for ToT or ToA; data will be uncalibrated.");
         }
     }
+  const Calibration *calib = state->calib.get();
 
   bool data_found = false;
 
-  // No event
-  if(!ev || ev->NumBlocks() < 1) {
-    return false;
-  }
-
   // Retrieve data from Block 0:
   std::vector<uint64_t> vpixdata;
   auto data = ev->GetBlock(0);
@@ -173,28 +210,28 @@ bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::S
       // 0x4 is the least significant part of the timestamp
       if(header2 == 0x4) {
         // The data is shifted 16 bits to the right, then 12 to the left in order to match the timestamp format (net 4 right)
-        m_syncTime = (m_syncTime & 0xFFFFF00000000000) + ((pixdata & 0x0000FFFFFFFF0000) >> 4);
+        state->syncTime = (state->syncTime & 0xFFFFF00000000000) + ((pixdata & 0x0000FFFFFFFF0000) >> 4);
       }
       // 0x5 is the most significant part of the timestamp
       if(header2 == 0x5) {
         // The data is shifted 16 bits to the right, then 44 to the left in order to match the timestamp format (net 28 left)
-        m_syncTime = (m_syncTime & 0x00000FFFFFFFFFFF) + ((pixdata & 0x00000000FFFF0000) << 28);
+        state->syncTime = (state->syncTime & 0x00000FFFFFFFFFFF) + ((pixdata & 0x00000000FFFF0000) << 28);
 
-        if(!m_clearedHeader && (m_syncTime / 4096 / 40) < 6000000) { // < 6sec
+        if(!state->clearedHeader && (state->syncTime / 4096 / 40) < 6000000) { // < 6sec
           EUDAQ_INFO("Timepix3: Detected T0 signal. Header cleared.");
-          m_clearedHeader = true;
+          state->clearedHeader = true;
 
         // From SPS data we know that even though pixel timestamps are not perfectly chronological, they are not more
         // than "mixed up by -20us". At DESY, this is hardly (ever?) the case due to the lower occupancies.
         // Hence, if the current timestamp is more than 20us earlier than the previous timestamp, we can assume that
         // a 2nd T0 has occured. With some safety margin, set delta_t0 = 1e6 (1s, default).
         // This implies we cannot detect a 2nd T0 within the first "delta_t0" microseconds after the initial T0.
-        } else if ((m_syncTime + m_delta_t0 * 4096 * 40) < m_syncTime_prev) { // delta_t0 on left side to avoid neg. difference between uint64_t
-          throw DataInvalid("Timepix3: Detected second T0 signal. Time jumps back by " + to_string((m_syncTime_prev - m_syncTime) / 4096 / 40) + "us.");
+        } else if ((state->syncTime + state->delta_t0 * 4096 * 40) < state->syncTime_prev) { // delta_t0 on left side to avoid neg. difference between uint64_t
+          throw DataInvalid("Timepix3: Detected second T0 signal. Time jumps back by " + to_string((state->syncTime_prev - state->syncTime) / 4096 / 40) + "us.");
         }
-        EUDAQ_DEBUG("ST = " + to_string(m_syncTime) + " STPrev = " + to_string(m_syncTime_prev) + " " + to_string(m_syncTime < m_syncTime_prev));
+        EUDAQ_DEBUG("ST = " + to_string(state->syncTime) + " STPrev = " + to_string(state->syncTime_prev) + " " + to_string(state->syncTime < state->syncTime_prev));
 
-        m_syncTime_prev = m_syncTime;
+        state->syncTime_prev = state->syncTime;
       }
     }
 
@@ -202,7 +239,7 @@ bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::S
     // this "header" data has been cleared, when the heart beat signal starts from a low number (~few seconds max).
     // To detect a possible second T0, we have no better gauge than the same criterion:
     // Comparing the timestamp to the previous timestamp (see above).
-    if(!m_clearedHeader) {
+    if(!state->clearedHeader) {
         continue;
     }
 
@@ -225,14 +262,14 @@ bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::S
       const uint64_t toa((data & 0x0FFFC000) >> 14);
 
       // Calculate the timestamp.
-      uint64_t time = (((spidrTime << 18) + (toa << 4) + (15 - ftoa)) << 8) + (m_syncTime & 0xFFFFFC0000000000);
+      uint64_t time = (((spidrTime << 18) + (toa << 4) + (15 - ftoa)) << 8) + (state->syncTime & 0xFFFFFC0000000000);
 
       // Adjusting phases for double column shift
       time += ((static_cast<uint64_t>(col) / 2 - 1) % 16) * 256;
 
       // The time from the pixels has a maximum value of ~26 seconds. We compare the pixel time to the "heartbeat"
       // signal (which has an overflow of ~4 years) and check if the pixel time has wrapped back around to 0
-      while(static_cast<long long>(m_syncTime) - static_cast<long long>(time) > 0x0000020000000000) {
+      while(static_cast<long long>(state->syncTime) - static_cast<long long>(time) > 0x0000020000000000) {
         time += 0x0000040000000000;
       }
 
@@ -242,20 +279,21 @@ bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::S
       // best guess for charge is ToT if no calibration is available
       double charge = static_cast<float>(tot);
 
-      // Apply calibration if both vtot and vtoa are not empty
+      // Apply calibration if both ToT and ToA files were given
       // (copied over from Corryvreckan EventLoaderTimepix3)
-      if(!vtot.empty() && !vtoa.empty()) {
+      if(calib) {
         EUDAQ_DEBUG("Applying calibration to DUT");
         size_t scol = static_cast<size_t>(col);
         size_t srow = static_cast<size_t>(row);
-        float a = vtot.at(256 * srow + scol).at(2);
-        float b = vtot.at(256 * srow + scol).at(3);
-        float c = vtot.at(256 * srow + scol).at(4);
-        float t = vtot.at(256 * srow + scol).at(5);
+        const std::array<float, 7> &k = calib->at(256 * srow + scol);
+        float a = k[0];
+        float b = k[1];
+        float c = k[2];
+        float t = k[3];
 
-        float toa_c = vtoa.at(256 * srow + scol).at(2);
-        float toa_t = vtoa.at(256 * srow + scol).at(3);
-        float toa_d = vtoa.at(256 * srow + scol).at(4);
+        float toa_c = k[4];
+        float toa_t = k[5];
+        float toa_d = k[6];
 
         // Calculating calibrated tot and toa
         float fvolts = (sqrt(a * a * t * t + 2 * a * b * t + 4 * a * c - 2 * a * t * static_cast<float>(tot) +
@@ -301,7 +339,34 @@ bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::S
   return data_found;
 }
 
-void Timepix3RawEvent2StdEventConverter::loadCalibration(std::string path, char delim, std::vector<std::vector<float>>& dat) const {
+std::shared_ptr<const Timepix3RawEvent2StdEventConverter::Calibration>
+Timepix3RawEvent2StdEventConverter::GetCalibration(const std::string &path_tot, const std::string &path_toa) {
+  static std::mutex mx;
+  static std::map<std::pair<std::string, std::string>, std::shared_ptr<const Calibration>> cache;
+  std::lock_guard<std::mutex> lk(mx);
+  auto &calib = cache[std::make_pair(path_tot, path_toa)];
+  if(calib)
+    return calib;
+
+  std::vector<std::vector<float>> vtot, vtoa;
+  loadCalibration(path_tot, ' ', vtot);
+  loadCalibration(path_toa, ' ', vtoa);
+  auto c = std::make_shared<Calibration>(256 * 256);
+  if(vtot.size() < c->size() || vtoa.size() < c->size()) {
+    throw DataInvalid("Timepix3: Calibration tables hold " + to_string(vtot.size()) + " ToT and " + to_string(vtoa.size()) +
+                      " ToA rows, " + to_string(c->size()) + " needed");
+  }
+  for(size_t i = 0; i < c->size(); i++) {
+    if(vtot[i].size() < 6 || vtoa[i].size() < 5) {
+      throw DataInvalid("Timepix3: Too few calibration constants for pixel " + to_string(i % 256) + ", " + to_string(i / 256));
+    }
+    (*c)[i] = {vtot[i][2], vtot[i][3], vtot[i][4], vtot[i][5], vtoa[i][2], vtoa[i][3], vtoa[i][4]};
+  }
+  calib = c;
+  return calib;
+}
+
+void Timepix3RawEvent2StdEventConverter::loadCalibration(std::string path, char delim, std::vector<std::vector<float>>& dat) {
     // copied from Corryvreckan EventLoaderTimepix3
     std::ifstream f;
     f.open(path);
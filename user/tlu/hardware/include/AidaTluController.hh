@@ -146,6 +146,9 @@ namespace tlu {
     fmctludata* PopFrontEvent();
     bool IsBufferEmpty(){return m_data.empty();};
     void ReceiveEvents(uint8_t verbose);
+    // Append the raw EventFifoData words (6 per trigger) to fifo, without
+    // decoding them into fmctludata objects; returns the number of triggers
+    uint32_t ReceiveEventsBlock(std::vector<uint32_t> &fifo, uint8_t verbose);
     void ResetEventsBuffer();
     void DefineConst(int nDUTs, int nTrigInputs);
     void DumpEventsBuffer();
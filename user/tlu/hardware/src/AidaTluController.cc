@@ -670,6 +670,30 @@ namespace tlu {
     }
   }
 
+  uint32_t AidaTluController::ReceiveEventsBlock(std::vector<uint32_t> &fifo, uint8_t verbose){
+    uint32_t nevent = GetEventFifoFillLevel()/6;
+    uint32_t fifoStatus= GetEventFifoCSR(verbose);
+    if ((fifoStatus & 0x18)){
+      std::cout << "WARNING! fmctlu hardware FIFO is full (CSR)" << std::endl;
+    }
+    if (nevent*6 == 0x3FEA) std::cout << "WARNING! fmctlu hardware FIFO is full" << std::endl;
+    if(!nevent)
+      return 0;
+    ValVector< uint32_t > fifoContent = m_hw->getNode("eventBuffer.EventFifoData").readBlock(nevent*6);
+    m_hw->dispatch();
+    if(!fifoContent.valid())
+      return 0;
+    if (verbose > 0){
+      std::cout<< "TLU events required: "<<nevent<<" events received: " << fifoContent.size()/6<<std::endl;
+    }
+    if(fifoContent.size()%6 !=0){
+      std::cout<<"receive error"<<std::endl;
+    }
+    size_t nwords = fifoContent.size() - fifoContent.size()%6;
+    fifo.insert(fifo.end(), fifoContent.begin(), fifoContent.begin() + nwords);
+    return nwords/6;
+  }
+
   void AidaTluController::ResetEventsBuffer(){
     for(auto &&i: m_data){
       delete i;
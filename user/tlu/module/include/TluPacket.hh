@@ -0,0 +1,52 @@
+#ifndef TLUPACKET_HH
+#define TLUPACKET_HH
+
+#include "eudaq/Utils.hh"
+
+#include <cstdint>
+#include <cstddef>
+
+namespace tlu {
+
+  // One trigger inside the data block of a TluPacketDataEvent. Records are
+  // stored back to back with a fixed little endian layout:
+  //   [0,4)   trigger number
+  //   [4,10)  coarse timestamp, 48 bits in 25 ns units
+  //   [10,16) fine timestamps of the six trigger inputs
+  //   [16]    bit mask of the fired trigger inputs
+  //   [17]    event type
+  struct TluPacketRecord {
+    uint32_t trigger_n;
+    uint64_t timestamp;
+    uint8_t finets[6];
+    uint8_t inputs;
+    uint8_t type;
+  };
+
+  static const size_t TLU_PACKET_RECORD_SIZE = 18;
+
+  inline void PackTluRecord(uint8_t *p, const TluPacketRecord &r){
+    eudaq::setlittleendian<uint32_t>(p, r.trigger_n);
+    eudaq::setlittleendian<uint32_t>(p + 4, static_cast<uint32_t>(r.timestamp));
+    eudaq::setlittleendian<uint16_t>(p + 8, static_cast<uint16_t>(r.timestamp >> 32));
+    for(size_t i = 0; i < 6; i++)
+      p[10 + i] = r.finets[i];
+    p[16] = r.inputs;
+    p[17] = r.type;
+  }
+
+  inline TluPacketRecord UnpackTluRecord(const uint8_t *p){
+    TluPacketRecord r;
+    r.trigger_n = eudaq::getlittleendian<uint32_t>(p);
+    r.timestamp = eudaq::getlittleendian<uint32_t>(p + 4) +
+      (static_cast<uint64_t>(eudaq::getlittleendian<uint16_t>(p + 8)) << 32);
+    for(size_t i = 0; i < 6; i++)
+      r.finets[i] = p[10 + i];
+    r.inputs = p[16];
+    r.type = p[17];
+    return r;
+  }
+
+}
+
+#endif
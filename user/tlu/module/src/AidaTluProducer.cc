@@ -3,12 +3,14 @@
 #include "AidaTluController.hh"
 #include "AidaTluHardware.hh"
 #include "AidaTluPowerModule.hh"
+#include "TluPacket.hh"
 
 #include <iostream>
 #include <ostream>
 #include <vector>
 #include <chrono>
 #include <thread>
+#include <algorithm>
 
 
 class AidaTluProducer: public eudaq::Producer {
@@ -25,6 +27,9 @@ class AidaTluProducer: public eudaq::Producer {
 
   static const uint32_t m_id_factory = eudaq::cstr2hash("AidaTluProducer");
 private:
+  void RunLoopBlock();
+  void IdleSleep(uint32_t &idle_us);
+
   bool m_exit_of_run;
   bool compact_data_ = false; // select if you will write the data in a more compact binary format
   std::mutex m_mtx_tlu; //prevent to reset tlu during the RunLoop thread
@@ -36,6 +41,10 @@ class AidaTluProducer: public eudaq::Producer {
 
   uint8_t m_verbose;
   uint32_t m_delayStart;
+  bool m_block_readout = false; // read the FIFO as one block instead of trigger by trigger
+  uint32_t m_packet_size = 0; // triggers per TluPacketDataEvent, 0 sends one event per trigger
+  uint32_t m_idle_sleep_max_us = 1000;
+  std::vector<uint32_t> m_fifo_buf;
 };
 
 namespace{
@@ -68,10 +77,23 @@ void AidaTluProducer::RunLoop(){
   // Enable triggers
   m_tlu->SetTriggerVeto(0, m_verbose);
 
+  if(m_block_readout){
+    RunLoopBlock();
+    m_tlu->SetTriggerVeto(1, m_verbose);
+    m_tlu->SetRunActive(0, 1);
+    return;
+  }
+
+  uint32_t idle_us = 0;
   while(!m_exit_of_run) {
     m_lasttime=m_tlu->GetCurrentTimestamp()*25;
     if(isbegin) m_starttime = m_lasttime;
     m_tlu->ReceiveEvents(m_verbose);
+    if(m_tlu->IsBufferEmpty()){
+      IdleSleep(idle_us);
+      continue;
+    }
+    idle_us = 0;
     while (!m_tlu->IsBufferEmpty()){
       tlu::fmctludata *data = m_tlu->PopFrontEvent();
       uint32_t trigger_n = data->eventnumber;
@@ -140,6 +162,102 @@ void AidaTluProducer::RunLoop(){
   m_tlu->SetRunActive(0, 1);
 }
 
+void AidaTluProducer::IdleSleep(uint32_t &idle_us){
+  // back off exponentially while the FIFO stays empty, so that an idle TLU
+  // does not keep a core and the IPbus link busy
+  if(!m_idle_sleep_max_us)
+    return;
+  idle_us = idle_us ? std::min(idle_us * 2, m_idle_sleep_max_us) : std::min(10u, m_idle_sleep_max_us);
+  std::this_thread::sleep_for(std::chrono::microseconds(idle_us));
+}
+
+void AidaTluProducer::RunLoopBlock(){
+  bool isbegin = true;
+  uint32_t idle_us = 0;
+  while(!m_exit_of_run) {
+    m_lasttime=m_tlu->GetCurrentTimestamp()*25;
+    if(isbegin) m_starttime = m_lasttime;
+    m_fifo_buf.clear();
+    uint32_t ntrg = m_tlu->ReceiveEventsBlock(m_fifo_buf, m_verbose);
+    if(!ntrg){
+      IdleSleep(idle_us);
+      continue;
+    }
+    idle_us = 0;
+    // without packing, one compact TluRawDataEvent per trigger as in RunLoop
+    uint32_t packet_size = m_packet_size ? m_packet_size : 1;
+    for(uint32_t first = 0; first < ntrg; first += packet_size){
+      uint32_t n = std::min(packet_size, ntrg - first);
+      std::vector<uint8_t> block(n * (m_packet_size ? tlu::TLU_PACKET_RECORD_SIZE : 7));
+      uint64_t ts_first = 0;
+      uint64_t ts_last = 0;
+      uint32_t trigger_first = 0;
+      uint8_t inputs_first = 0;
+      for(uint32_t i = 0; i < n; i++){
+        const uint32_t *w = &m_fifo_buf[(first + i) * 6];
+        tlu::fmctludata data(w[0], w[1], w[2], w[3], w[4], w[5]);
+        tlu::TluPacketRecord r;
+        r.trigger_n = data.eventnumber;
+        r.timestamp = data.timestamp;
+        r.finets[0] = data.sc0;
+        r.finets[1] = data.sc1;
+        r.finets[2] = data.sc2;
+        r.finets[3] = data.sc3;
+        r.finets[4] = data.sc4;
+        r.finets[5] = data.sc5;
+        r.inputs = ((data.input5 &0x1)<<5) + ((data.input4 &0x1)<<4) + ((data.input3 &0x1)<<3) +
+          ((data.input2 &0x1)<<2) + ((data.input1 &0x1)<<1) + (data.input0 &0x1);
+        r.type = data.eventtype;
+        if(m_packet_size)
+          tlu::PackTluRecord(&block[i * tlu::TLU_PACKET_RECORD_SIZE], r);
+        else{
+          std::copy(r.finets, r.finets + 6, block.begin());
+          block[6] = r.inputs;
+        }
+        if(i == 0){
+          ts_first = data.timestamp;
+          trigger_first = data.eventnumber;
+          inputs_first = r.inputs;
+        }
+        ts_last = data.timestamp;
+      }
+
+      auto ev = eudaq::Event::MakeUnique(m_packet_size ? "TluPacketDataEvent" : "TluRawDataEvent");
+      ev->SetTimestamp(ts_first*25, ts_last*25+25, false);
+      ev->SetTriggerN(trigger_first);
+      if(!m_packet_size){
+        std::string triggers;
+        for(int b = 5; b >= 0; b--)
+          triggers += ((inputs_first >> b) & 0x1) ? '1' : '0';
+        ev->SetTag("TRIGGER", triggers);
+      }
+      ev->AddBlock(0, std::move(block));
+      if(first + n == ntrg){
+        uint32_t sl0,sl1,sl2,sl3, sl4, sl5, pt;
+        m_tlu->GetScaler(sl0,sl1,sl2,sl3,sl4,sl5);
+        pt=m_tlu->GetPreVetoTriggers();
+        ev->SetTag("PARTICLES", std::to_string(pt));
+        ev->SetTag("SCALER0", std::to_string(sl0));
+        ev->SetTag("SCALER1", std::to_string(sl1));
+        ev->SetTag("SCALER2", std::to_string(sl2));
+        ev->SetTag("SCALER3", std::to_string(sl3));
+        ev->SetTag("SCALER4", std::to_string(sl4));
+        ev->SetTag("SCALER5", std::to_string(sl5));
+        if(m_exit_of_run){
+          ev->SetEORE();
+        }
+      }
+      if(isbegin){
+        isbegin = false;
+        ev->SetBORE();
+        ev->SetTag("FirmwareID", std::to_string(m_tlu->GetFirmwareVersion()));
+        ev->SetTag("BoardID", std::to_string(m_tlu->GetBoardID()));
+      }
+      SendEvent(std::move(ev));
+    }
+  }
+}
+
 void AidaTluProducer::DoInitialise(){
   /* Establish a connection with the TLU using IPBus.
      Define the main hardware parameters.
@@ -224,6 +342,11 @@ void AidaTluProducer::DoConfigure() {
   EUDAQ_INFO("TLU VERBOSITY SET TO: " + std::to_string(m_verbose));
   m_delayStart = conf->Get("delayStart", 0);
   EUDAQ_INFO("TLU DELAY START SET TO: " + std::to_string(m_delayStart) + " ms");
+  m_packet_size = conf->Get("PacketSize", 0);
+  m_block_readout = conf->Get("BlockReadout", 0) || m_packet_size;
+  m_idle_sleep_max_us = conf->Get("IdleSleepMax_us", 1000);
+  // one readout drains at most the full hardware FIFO (0x3FEA words)
+  m_fifo_buf.reserve(0x4000);
 
   m_tlu->SetTriggerVeto(1, m_verbose);
   if( conf->Get("skipconf", false) ){
@@ -1,18 +1,72 @@
 #include "eudaq/StdEventConverter.hh"
 #include "eudaq/RawEvent.hh"
+#include "TluPacket.hh"
 
 class TluRawEvent2StdEventConverter: public eudaq::StdEventConverter{
 public:
   bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
+  // Split a TluPacketDataEvent into one compact TluRawDataEvent per trigger
+  static std::vector<eudaq::EventSP> UnpackPacket(eudaq::EventSPC d1);
   static const uint32_t m_id_factory = eudaq::cstr2hash("TluRawDataEvent");
+  static const uint32_t m_id_packet = eudaq::cstr2hash("TluPacketDataEvent");
+private:
+  bool ConvertingPacket(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const;
 };
 
 namespace{
   auto dummy0 = eudaq::Factory<eudaq::StdEventConverter>::
     Register<TluRawEvent2StdEventConverter>(TluRawEvent2StdEventConverter::m_id_factory);
+  auto dummy1 = eudaq::Factory<eudaq::StdEventConverter>::
+    Register<TluRawEvent2StdEventConverter>(TluRawEvent2StdEventConverter::m_id_packet);
+}
+
+std::vector<eudaq::EventSP> TluRawEvent2StdEventConverter::UnpackPacket(eudaq::EventSPC d1){
+  std::vector<eudaq::EventSP> evs;
+  if(d1->NumBlocks() < 1)
+    return evs;
+  auto block = d1->GetBlock(0);
+  size_t n = block.size() / tlu::TLU_PACKET_RECORD_SIZE;
+  evs.reserve(n);
+  for(size_t i = 0; i < n; i++){
+    auto r = tlu::UnpackTluRecord(&block[i * tlu::TLU_PACKET_RECORD_SIZE]);
+    auto ev = eudaq::Event::MakeShared("TluRawDataEvent");
+    ev->SetRunN(d1->GetRunN());
+    ev->SetEventN(d1->GetEventN());
+    ev->SetDeviceN(d1->GetDeviceN());
+    ev->SetStreamN(d1->GetStreamN());
+    ev->SetTriggerN(r.trigger_n);
+    uint64_t ts_ns = r.timestamp * 25;
+    ev->SetTimestamp(ts_ns, ts_ns + 25, false);
+    std::vector<uint8_t> datablock(r.finets, r.finets + 6);
+    datablock.push_back(r.inputs);
+    ev->AddBlock(0, std::move(datablock));
+    evs.push_back(ev);
+  }
+  return evs;
+}
+
+// The StandardEvent of a packet describes its first trigger, all triggers of
+// the packet are attached to it as StandardEvent sub-events.
+bool TluRawEvent2StdEventConverter::ConvertingPacket(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
+  auto evs = UnpackPacket(d1);
+  if(evs.empty()){
+    EUDAQ_WARN("Ignoring empty TLU packet " + std::to_string(d1->GetEventN()));
+    return false;
+  }
+  if(!Converting(evs.front(), d2, conf))
+    return false;
+  for(auto &ev: evs){
+    auto sub = eudaq::StandardEvent::MakeShared();
+    if(Converting(ev, sub, conf))
+      d2->AddSubEvent(sub);
+  }
+  d2->SetTag("TRIGGERS", std::to_string(evs.size()));
+  return true;
 }
 
 bool TluRawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
+  if(d1->GetExtendWord() == m_id_packet)
+    return ConvertingPacket(d1, d2, conf);
   if(!d2->IsFlagPacket()){
     d2->SetFlag(d1->GetFlag());
     d2->SetRunN(d1->GetRunN());